@@ -0,0 +1,72 @@
+/**
+ * @file bench_tier1.cpp
+ * @brief Per-call cost of the Tier 1 wrappers against eval(symbolic)
+ *
+ * The baseline evaluates a prebuilt unevaluated node, so it leaves out the
+ * node allocation the Tier 1 path also saves: the reported gain is a
+ * lower bound.
+ *
+ * Usage: bench_tier1 [iterations]
+ */
+
+#include "giac_impl.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+namespace {
+    volatile int sink = 0;
+
+    double ns_per_call(int64_t iterations, const std::function<Gen()>& f) {
+        for (int i = 0; i < 100; ++i) sink += f().type();  // warm-up
+        auto t0 = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < iterations; ++i) sink += f().type();
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+    }
+
+    struct Case {
+        const char* label;
+        const char* name;
+        std::vector<Gen> args;
+        std::function<Gen()> direct;
+    };
+}
+
+int main(int argc, char** argv) {
+    int64_t iterations = argc > 1 ? std::atoll(argv[1]) : 20000;
+    if (iterations <= 0) iterations = 20000;
+
+    Gen x = make_identifier("x");
+    Gen half(0.5);
+    Gen twelve(int64_t(12));
+    Gen eighteen(int64_t(18));
+    Gen two(int64_t(2));
+    Gen ten(int64_t(10));
+    Gen cube = giac_eval("x^3");
+    Gen poly = giac_eval("(x+1)^2-1");
+
+    std::vector<Case> cases;
+    cases.push_back({"sin(0.5)", "sin", {half}, [&] { return giac_sin(half); }});
+    cases.push_back({"exp(0.5)", "exp", {half}, [&] { return giac_exp(half); }});
+    cases.push_back({"abs(12)", "abs", {twelve}, [&] { return giac_abs(twelve); }});
+    cases.push_back({"gcd(12,18)", "gcd", {twelve, eighteen}, [&] { return giac_gcd(twelve, eighteen); }});
+    cases.push_back({"pow(2,10)", "pow", {two, ten}, [&] { return giac_pow(two, ten); }});
+    cases.push_back({"sin(x)", "sin", {x}, [&] { return giac_sin(x); }});
+    cases.push_back({"diff(x^3,x)", "diff", {cube, x}, [&] { return giac_diff(cube, x); }});
+    cases.push_back({"normal((x+1)^2-1)", "normal", {poly}, [&] { return giac_normal(poly); }});
+
+    std::printf("%-20s %16s %14s %8s\n", "call", "symbolic ns", "tier1 ns", "speedup");
+    for (const Case& c : cases) {
+        Gen node = make_symbolic_unevaluated(c.name, c.args);
+        double base = ns_per_call(iterations, [&] { return node.eval(); });
+        double direct = ns_per_call(iterations, c.direct);
+        std::printf("%-20s %16.1f %14.1f %7.2fx\n", c.label, base, direct, base / direct);
+    }
+    return 0;
+}
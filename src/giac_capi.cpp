@@ -0,0 +1,247 @@
+/**
+ * @file giac_capi.cpp
+ * @brief extern "C" entry points of libgiac_capi
+ *
+ * Thin layer over the giac_impl.h interface. Each entry point is
+ * exception-free: failures are reported through the no-throw try_*
+ * variants or caught here, and turned into GIAC_CAPI_* status codes.
+ */
+
+#include "giac_capi.h"
+#include "giac_impl.h"
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+struct giac_capi_gen_s {
+    Gen value;
+};
+
+struct giac_capi_context_s {
+    GiacContext ctx;
+};
+
+namespace {
+    // Last failure on this thread; the message is only formatted when
+    // giac_capi_last_error asks for it
+    thread_local std::unique_ptr<TryResult> last_result;
+    thread_local std::exception_ptr last_exception;
+    thread_local const char* last_fixed = nullptr;
+
+    void clear_last_error() {
+        last_result.reset();
+        last_exception = nullptr;
+        last_fixed = nullptr;
+    }
+
+    int32_t invalid(const char* why) {
+        clear_last_error();
+        last_fixed = why;
+        return GIAC_CAPI_INVALID_ARGUMENT;
+    }
+
+    giac_capi_gen wrap(Gen value) {
+        return new giac_capi_gen_s{std::move(value)};
+    }
+
+    int32_t from_try(TryResult r, giac_capi_gen* out) {
+        if (r.ok()) {
+            *out = wrap(r.value());
+            return GIAC_CAPI_OK;
+        }
+        int32_t status = r.status();
+        clear_last_error();
+        last_result = std::make_unique<TryResult>(std::move(r));
+        return status;
+    }
+
+    // Run f, turning any exception into GIAC_CAPI_EVAL_ERROR
+    template <class F>
+    int32_t guarded(F&& f) {
+        try {
+            return f();
+        } catch (...) {
+            clear_last_error();
+            last_exception = std::current_exception();
+            return GIAC_CAPI_EVAL_ERROR;
+        }
+    }
+
+    int32_t copy_out(const std::string& s, char* buf, size_t cap, size_t* needed) {
+        if (needed) *needed = s.size();
+        if (cap == 0) return s.empty() ? GIAC_CAPI_OK : GIAC_CAPI_BUFFER_TOO_SMALL;
+        size_t n = s.size() < cap ? s.size() : cap - 1;
+        std::memcpy(buf, s.data(), n);
+        buf[n] = '\0';
+        return n == s.size() ? GIAC_CAPI_OK : GIAC_CAPI_BUFFER_TOO_SMALL;
+    }
+
+    template <class Op>
+    int32_t binary(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out, Op op) {
+        if (!a || !b || !out) return invalid("null handle");
+        return guarded([&]() {
+            *out = wrap(op(a->value, b->value));
+            return GIAC_CAPI_OK;
+        });
+    }
+}
+
+extern "C" {
+
+const char* giac_capi_version(void) {
+    static const std::string version = get_wrapper_version();
+    return version.c_str();
+}
+
+int32_t giac_capi_last_error(char* buf, size_t cap, size_t* needed) {
+    // Not reported through invalid(), which would replace the message
+    if (cap > 0 && !buf) return GIAC_CAPI_INVALID_ARGUMENT;
+    std::string message;
+    if (last_result) {
+        message = last_result->message();
+    } else if (last_exception) {
+        try {
+            std::rethrow_exception(last_exception);
+        } catch (const std::exception& e) {
+            message = e.what();
+        } catch (...) {
+            message = "unknown error";
+        }
+    } else if (last_fixed) {
+        message = last_fixed;
+    }
+    return copy_out(message, buf, cap, needed);
+}
+
+giac_capi_context giac_capi_context_new(void) {
+    try {
+        return new giac_capi_context_s();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void giac_capi_context_free(giac_capi_context ctx) {
+    delete ctx;
+}
+
+int32_t giac_capi_eval(const char* expr, size_t len, giac_capi_gen* out) {
+    if (!expr || !out) return invalid("null argument");
+    return guarded([&]() { return from_try(try_eval(std::string(expr, len)), out); });
+}
+
+int32_t giac_capi_eval_in(giac_capi_context ctx, const char* expr, size_t len,
+                          giac_capi_gen* out) {
+    if (!ctx || !expr || !out) return invalid("null argument");
+    return guarded([&]() { return from_try(try_eval(std::string(expr, len), ctx->ctx), out); });
+}
+
+int32_t giac_capi_apply(const char* name, size_t name_len, const giac_capi_gen* args,
+                        size_t nargs, giac_capi_gen* out) {
+    if (!name || !out || (nargs > 0 && !args)) return invalid("null argument");
+    for (size_t i = 0; i < nargs; ++i) {
+        if (!args[i]) return invalid("null handle");
+    }
+    return guarded([&]() {
+        std::string fname(name, name_len);
+        switch (nargs) {
+            case 0: return from_try(try_apply_func0(fname), out);
+            case 1: return from_try(try_apply_func1(fname, args[0]->value), out);
+            case 2: return from_try(try_apply_func2(fname, args[0]->value, args[1]->value), out);
+            default: {
+                std::vector<Gen> v;
+                v.reserve(nargs);
+                for (size_t i = 0; i < nargs; ++i) v.push_back(args[i]->value);
+                return from_try(try_apply_funcN(fname, v), out);
+            }
+        }
+    });
+}
+
+giac_capi_gen giac_capi_gen_from_int64(int64_t value) {
+    try {
+        return wrap(Gen(value));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+giac_capi_gen giac_capi_gen_from_double(double value) {
+    try {
+        return wrap(Gen(value));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+int32_t giac_capi_gen_identifier(const char* name, size_t len, giac_capi_gen* out) {
+    if (!name || !out) return invalid("null argument");
+    return guarded([&]() {
+        *out = wrap(make_identifier(std::string(name, len)));
+        return GIAC_CAPI_OK;
+    });
+}
+
+giac_capi_gen giac_capi_gen_copy(giac_capi_gen g) {
+    if (!g) return nullptr;
+    try {
+        return wrap(g->value);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void giac_capi_gen_free(giac_capi_gen g) {
+    delete g;
+}
+
+int32_t giac_capi_gen_type(giac_capi_gen g) {
+    return g ? static_cast<int32_t>(g->value.type()) : -1;
+}
+
+int32_t giac_capi_gen_to_int64(giac_capi_gen g, int64_t* out) {
+    if (!g || !out) return invalid("null argument");
+    if (g->value.type() != GIAC_CAPI_TYPE_INT) return invalid("gen is not an integer");
+    *out = g->value.to_int64();
+    return GIAC_CAPI_OK;
+}
+
+int32_t giac_capi_gen_to_double(giac_capi_gen g, double* out) {
+    if (!g || !out) return invalid("null argument");
+    int type = g->value.type();
+    if (type == GIAC_CAPI_TYPE_DOUBLE) {
+        *out = g->value.to_double();
+    } else if (type == GIAC_CAPI_TYPE_INT) {
+        *out = static_cast<double>(g->value.to_int64());
+    } else {
+        return invalid("gen is not a machine number");
+    }
+    return GIAC_CAPI_OK;
+}
+
+int32_t giac_capi_gen_to_string(giac_capi_gen g, char* buf, size_t cap, size_t* needed) {
+    if (!g || (cap > 0 && !buf)) return invalid("null argument");
+    return guarded([&]() { return copy_out(g->value.to_string(), buf, cap, needed); });
+}
+
+int32_t giac_capi_add(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out) {
+    return binary(a, b, out, [](const Gen& x, const Gen& y) { return x + y; });
+}
+
+int32_t giac_capi_sub(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out) {
+    return binary(a, b, out, [](const Gen& x, const Gen& y) { return x - y; });
+}
+
+int32_t giac_capi_mul(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out) {
+    return binary(a, b, out, [](const Gen& x, const Gen& y) { return x * y; });
+}
+
+int32_t giac_capi_div(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out) {
+    return binary(a, b, out, [](const Gen& x, const Gen& y) { return x / y; });
+}
+
+} // extern "C"
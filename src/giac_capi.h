@@ -0,0 +1,128 @@
+/**
+ * @file giac_capi.h
+ * @brief Plain C ABI over the giac wrapper (libgiac_capi)
+ *
+ * A second entry point next to the jlcxx module for callers that do not
+ * go through CxxWrap: Julia `ccall`, C, Rust, Python ctypes. Values are
+ * opaque handles, strings are passed as (pointer, length) pairs and text
+ * comes back through caller-provided buffers. No C++ exception crosses
+ * this boundary; every fallible call returns a status code.
+ *
+ * Ownership: every handle returned through an out parameter or by a
+ * *_new / *_from_* function is owned by the caller and must be released
+ * with the matching *_free function.
+ *
+ * Threading: handles are not thread-safe; use each handle from one thread
+ * at a time. The last-error slot is per thread.
+ */
+
+#ifndef GIAC_CAPI_H
+#define GIAC_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(GIAC_CAPI_BUILD)
+#    define GIAC_CAPI_EXPORT __declspec(dllexport)
+#  else
+#    define GIAC_CAPI_EXPORT __declspec(dllimport)
+#  endif
+#else
+#  define GIAC_CAPI_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Opaque handles */
+typedef struct giac_capi_gen_s* giac_capi_gen;
+typedef struct giac_capi_context_s* giac_capi_context;
+
+/* Status codes (values match GiacStatus in giac_impl.h) */
+#define GIAC_CAPI_OK               0
+#define GIAC_CAPI_PARSE_ERROR      1
+#define GIAC_CAPI_EVAL_ERROR       2
+#define GIAC_CAPI_EMPTY            3
+#define GIAC_CAPI_BUFFER_TOO_SMALL 4  /* *needed holds the required size */
+#define GIAC_CAPI_INVALID_ARGUMENT 5  /* null handle / wrong type */
+
+/* Type tags returned by giac_capi_gen_type (values match giac's _INT_, _DOUBLE_) */
+#define GIAC_CAPI_TYPE_INT    0
+#define GIAC_CAPI_TYPE_DOUBLE 1
+
+/* ------------------------------------------------------------------------
+ * Library
+ * ------------------------------------------------------------------------ */
+
+/** Wrapper version string (static storage, do not free) */
+GIAC_CAPI_EXPORT const char* giac_capi_version(void);
+
+/**
+ * Message for the last failing call on this thread. Copies at most cap
+ * bytes including the terminating NUL; *needed (optional) receives the
+ * message length without NUL. Returns GIAC_CAPI_BUFFER_TOO_SMALL when the
+ * message was cut, and GIAC_CAPI_INVALID_ARGUMENT (keeping the stored
+ * message) when buf is NULL but cap is not 0.
+ */
+GIAC_CAPI_EXPORT int32_t giac_capi_last_error(char* buf, size_t cap, size_t* needed);
+
+/* ------------------------------------------------------------------------
+ * Contexts
+ * ------------------------------------------------------------------------ */
+
+GIAC_CAPI_EXPORT giac_capi_context giac_capi_context_new(void);
+GIAC_CAPI_EXPORT void giac_capi_context_free(giac_capi_context ctx);
+
+/* ------------------------------------------------------------------------
+ * Evaluation
+ * ------------------------------------------------------------------------ */
+
+/** Parse and evaluate expr[0..len) in the thread's default context */
+GIAC_CAPI_EXPORT int32_t giac_capi_eval(const char* expr, size_t len, giac_capi_gen* out);
+
+/** Parse and evaluate expr[0..len) in ctx */
+GIAC_CAPI_EXPORT int32_t giac_capi_eval_in(giac_capi_context ctx, const char* expr, size_t len,
+                                           giac_capi_gen* out);
+
+/** Call the giac function name[0..name_len) on args[0..nargs) */
+GIAC_CAPI_EXPORT int32_t giac_capi_apply(const char* name, size_t name_len,
+                                         const giac_capi_gen* args, size_t nargs,
+                                         giac_capi_gen* out);
+
+/* ------------------------------------------------------------------------
+ * Gen handles
+ * ------------------------------------------------------------------------ */
+
+GIAC_CAPI_EXPORT giac_capi_gen giac_capi_gen_from_int64(int64_t value);
+GIAC_CAPI_EXPORT giac_capi_gen giac_capi_gen_from_double(double value);
+GIAC_CAPI_EXPORT int32_t giac_capi_gen_identifier(const char* name, size_t len, giac_capi_gen* out);
+GIAC_CAPI_EXPORT giac_capi_gen giac_capi_gen_copy(giac_capi_gen g);
+GIAC_CAPI_EXPORT void giac_capi_gen_free(giac_capi_gen g);
+
+/** giac type tag (GIAC_CAPI_TYPE_INT, GIAC_CAPI_TYPE_DOUBLE, ...), or -1 for a null handle */
+GIAC_CAPI_EXPORT int32_t giac_capi_gen_type(giac_capi_gen g);
+
+GIAC_CAPI_EXPORT int32_t giac_capi_gen_to_int64(giac_capi_gen g, int64_t* out);
+GIAC_CAPI_EXPORT int32_t giac_capi_gen_to_double(giac_capi_gen g, double* out);
+
+/**
+ * giac text of g into buf (NUL-terminated when cap > 0). *needed
+ * (optional) receives the full length without NUL; on
+ * GIAC_CAPI_BUFFER_TOO_SMALL retry with a buffer of *needed + 1 bytes.
+ */
+GIAC_CAPI_EXPORT int32_t giac_capi_gen_to_string(giac_capi_gen g, char* buf, size_t cap,
+                                                 size_t* needed);
+
+/* Arithmetic; *out receives a new handle */
+GIAC_CAPI_EXPORT int32_t giac_capi_add(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out);
+GIAC_CAPI_EXPORT int32_t giac_capi_sub(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out);
+GIAC_CAPI_EXPORT int32_t giac_capi_mul(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out);
+GIAC_CAPI_EXPORT int32_t giac_capi_div(giac_capi_gen a, giac_capi_gen b, giac_capi_gen* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GIAC_CAPI_H */
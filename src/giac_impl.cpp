@@ -13,11 +13,34 @@
 #include <giac.h>
 #include <input_lexer.h>
 #include <algorithm>
+#include <map>
+#include <queue>
 #include <set>
+#include <tuple>
 #include <limits>
 
 #include "giac_impl.h"
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace giac_julia {
 
@@ -81,6 +104,171 @@ namespace {
     }
 }
 
+// ============================================================================
+// Worker pool for the opt-in parallel entry points
+// ============================================================================
+// Helper threads are created on first use and, like the thread-local contexts
+// above, never torn down: each helper keeps its own giac::context for the
+// lifetime of the process instead of leaking a fresh one per call.
+//
+// num_threads convention shared by every parallel entry point:
+//   1 (or negative) -> run on the calling thread only
+//   0               -> one thread per hardware thread
+//   n > 1           -> at most n threads, the calling thread included
+
+namespace {
+    class WorkerPool {
+    public:
+        static WorkerPool& instance() {
+            // Intentional leak, see get_thread_local_context()
+            static WorkerPool* pool = new WorkerPool();
+            return *pool;
+        }
+
+        static size_t resolve_threads(int32_t num_threads) {
+            if (num_threads == 0) {
+                unsigned hw = std::thread::hardware_concurrency();
+                return hw > 0 ? hw : 1;
+            }
+            return num_threads > 1 ? static_cast<size_t>(num_threads) : 1;
+        }
+
+        // Run task(i) for every i in [0, n_tasks). The calling thread takes
+        // part in the work, so nested calls from inside a task cannot
+        // deadlock. The first exception thrown by a task is rethrown here
+        // once every task has finished.
+        void run(size_t n_tasks, int32_t num_threads,
+                 const std::function<void(size_t)>& task) {
+            if (n_tasks == 0) return;
+            size_t helpers = std::min(resolve_threads(num_threads), n_tasks) - 1;
+            if (helpers == 0) {
+                for (size_t i = 0; i < n_tasks; ++i) task(i);
+                return;
+            }
+
+            auto batch = std::make_shared<Batch>(n_tasks, task);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                while (spawned_ < helpers) {
+                    std::thread([this]() { worker_loop(); }).detach();
+                    ++spawned_;
+                }
+                for (size_t k = 0; k < helpers; ++k) queue_.push_back(batch);
+            }
+            cv_.notify_all();
+
+            batch->work();
+            batch->wait();
+            if (batch->error) std::rethrow_exception(batch->error);
+        }
+
+    private:
+        struct Batch {
+            Batch(size_t n, const std::function<void(size_t)>& f)
+                : n_tasks(n), task(f) {}
+
+            const size_t n_tasks;
+            // Only dereferenced while tasks remain, i.e. while run() waits
+            const std::function<void(size_t)>& task;
+            std::atomic<size_t> next{0};
+            size_t done = 0;
+            std::exception_ptr error;
+            std::mutex m;
+            std::condition_variable cv;
+
+            void work() {
+                size_t finished = 0;
+                for (size_t i = next.fetch_add(1); i < n_tasks; i = next.fetch_add(1)) {
+                    try {
+                        task(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(m);
+                        if (!error) error = std::current_exception();
+                    }
+                    ++finished;
+                }
+                if (finished > 0) {
+                    std::lock_guard<std::mutex> lock(m);
+                    done += finished;
+                    if (done == n_tasks) cv.notify_all();
+                }
+            }
+
+            void wait() {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [this]() { return done == n_tasks; });
+            }
+        };
+
+        void worker_loop() {
+            (void)get_thread_local_context();
+            for (;;) {
+                std::shared_ptr<Batch> batch;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return !queue_.empty(); });
+                    batch = std::move(queue_.front());
+                    queue_.pop_front();
+                }
+                batch->work();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::shared_ptr<Batch>> queue_;
+        size_t spawned_ = 0;
+    };
+
+    // Rebuild the composite nodes of g so that a worker thread owns the copy
+    // outright. giac's reference counts are not atomic, so two threads must
+    // never copy or release the same shared node; inputs are detached on the
+    // calling thread before being handed to the pool. `idents` keeps repeated
+    // identifiers shared within one copy.
+    giac::gen thread_private_copy(const giac::gen& g,
+                                  std::unordered_map<const char*, giac::gen>& idents) {
+        switch (g.type) {
+            case giac::_INT_:
+            case giac::_DOUBLE_:
+                return g;  // immediate, no shared node
+            case giac::_ZINT:
+                return giac::gen(*g._ZINTptr);
+            case giac::_CPLX:
+                return giac::gen(thread_private_copy(*g._CPLXptr, idents),
+                                 thread_private_copy(*(g._CPLXptr + 1), idents));
+            case giac::_FRAC:
+                return giac::fraction(thread_private_copy(g._FRACptr->num, idents),
+                                      thread_private_copy(g._FRACptr->den, idents));
+            case giac::_IDNT: {
+                const char* name = g._IDNTptr->id_name;
+                auto it = idents.find(name);
+                if (it == idents.end()) {
+                    it = idents.emplace(name, giac::gen(giac::identificateur(name))).first;
+                }
+                return it->second;
+            }
+            case giac::_SYMB:
+                return giac::symbolic(g._SYMBptr->sommet,
+                                      thread_private_copy(g._SYMBptr->feuille, idents));
+            case giac::_VECT: {
+                giac::vecteur v;
+                v.reserve(g._VECTptr->size());
+                for (const auto& e : *g._VECTptr) {
+                    v.push_back(thread_private_copy(e, idents));
+                }
+                return giac::gen(v, g.subtype);
+            }
+            case giac::_STRNG:
+                return giac::string2gen(*g._STRNGptr, false);
+            default: {
+                // Rare leaf types: a print/parse round trip allocates fresh nodes
+                giac::context& ctx = get_thread_local_context();
+                return giac::gen(g.print(&ctx), &ctx);
+            }
+        }
+    }
+}
+
 // ============================================================================
 // Version Functions
 // ============================================================================
@@ -339,13 +527,58 @@ std::string list_all_functions() {
 // Tier 1 Direct Wrappers (High Performance - No Name Lookup)
 // ============================================================================
 
+namespace {
+    // Numbers and strings evaluate to themselves, so eval can be skipped
+    bool self_evaluating(const giac::gen& g) {
+        switch (g.type) {
+            case giac::_INT_:
+            case giac::_DOUBLE_:
+            case giac::_ZINT:
+            case giac::_REAL:
+            case giac::_FLOAT_:
+            case giac::_STRNG:
+                return true;
+            case giac::_CPLX:
+                return self_evaluating(g._CPLXptr[0]) && self_evaluating(g._CPLXptr[1]);
+            case giac::_FRAC:
+                return self_evaluating(g._FRACptr->num) && self_evaluating(g._FRACptr->den);
+            default:
+                return false;
+        }
+    }
+
+    giac::gen eval_arg(const giac::gen& g, giac::context& ctx) {
+        return self_evaluating(g) ? g : giac::eval(g, &ctx);
+    }
+
+    // Call f on args[0..n) the way eval(symbolic(f, args)) would, without
+    // building the symbolic node: evaluate the arguments, then dispatch
+    // straight into f. Quoted functions evaluate their own arguments, so
+    // they keep the symbolic + eval route.
+    giac::gen tier1_call(const giac::unary_function_ptr* f, const giac::gen* args, int n,
+                         giac::context& ctx) {
+        bool quoted = f->quoted();
+        if (n == 1) {
+            return quoted ? giac::eval(giac::symbolic(f, args[0]), &ctx)
+                          : (*f)(eval_arg(args[0], ctx), &ctx);
+        }
+        giac::vecteur v;
+        v.reserve(n);
+        for (int i = 0; i < n; ++i) {
+            v.push_back(quoted ? args[i] : eval_arg(args[i], ctx));
+        }
+        giac::gen seq(v, giac::_SEQ__VECT);
+        return quoted ? giac::eval(giac::symbolic(f, seq), &ctx) : (*f)(seq, &ctx);
+    }
+}
+
 // Helper macro for single-argument Tier 1 wrappers
 #define TIER1_SINGLE_ARG(name, at_symbol) \
     Gen giac_##name(const Gen& arg) { \
         initialize_giac_library(); \
         giac::context& ctx = get_thread_local_context(); \
-        giac::gen expr = giac::symbolic(giac::at_symbol, arg.impl_->g); \
-        return Gen(std::make_unique<GenImpl>(giac::eval(expr, &ctx))); \
+        return Gen(std::make_unique<GenImpl>( \
+            tier1_call(giac::at_symbol, &arg.impl_->g, 1, ctx))); \
     }
 
 // Helper macro for two-argument Tier 1 wrappers
@@ -353,12 +586,8 @@ std::string list_all_functions() {
     Gen giac_##name(const Gen& arg1, const Gen& arg2) { \
         initialize_giac_library(); \
         giac::context& ctx = get_thread_local_context(); \
-        giac::vecteur args; \
-        args.push_back(arg1.impl_->g); \
-        args.push_back(arg2.impl_->g); \
-        giac::gen seq = giac::gen(args, giac::_SEQ__VECT); \
-        giac::gen expr = giac::symbolic(giac::at_symbol, seq); \
-        return Gen(std::make_unique<GenImpl>(giac::eval(expr, &ctx))); \
+        const giac::gen args[2] = {arg1.impl_->g, arg2.impl_->g}; \
+        return Gen(std::make_unique<GenImpl>(tier1_call(giac::at_symbol, args, 2, ctx))); \
     }
 
 // Helper macro for three-argument Tier 1 wrappers
@@ -366,13 +595,8 @@ std::string list_all_functions() {
     Gen giac_##name(const Gen& arg1, const Gen& arg2, const Gen& arg3) { \
         initialize_giac_library(); \
         giac::context& ctx = get_thread_local_context(); \
-        giac::vecteur args; \
-        args.push_back(arg1.impl_->g); \
-        args.push_back(arg2.impl_->g); \
-        args.push_back(arg3.impl_->g); \
-        giac::gen seq = giac::gen(args, giac::_SEQ__VECT); \
-        giac::gen expr = giac::symbolic(giac::at_symbol, seq); \
-        return Gen(std::make_unique<GenImpl>(giac::eval(expr, &ctx))); \
+        const giac::gen args[3] = {arg1.impl_->g, arg2.impl_->g, arg3.impl_->g}; \
+        return Gen(std::make_unique<GenImpl>(tier1_call(giac::at_symbol, args, 3, ctx))); \
     }
 
 // Trigonometry
@@ -423,6 +647,69 @@ TIER1_TWO_ARG(pow, at_pow)
 #undef TIER1_TWO_ARG
 #undef TIER1_THREE_ARG
 
+// ============================================================================
+// Interned Names
+// ============================================================================
+// Operator and identifier names are mapped to dense 32-bit ids so tree
+// conversion on the Julia side compares integers instead of allocating and
+// hashing a string per node. Lookups hash the borrowed C string directly;
+// only the first sighting of a name allocates.
+
+namespace {
+    class NameTable {
+    public:
+        static NameTable& instance() {
+            // Intentional leak, see get_thread_local_context()
+            static NameTable* table = new NameTable();
+            return *table;
+        }
+
+        uint32_t intern(std::string_view name) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = ids_.find(name);
+            if (it != ids_.end()) return it->second;
+            if (names_.size() >= std::numeric_limits<uint32_t>::max()) {
+                throw std::runtime_error("interned name table is full");
+            }
+            uint32_t id = static_cast<uint32_t>(names_.size());
+            names_.emplace_back(name);
+            ids_.emplace(names_.back(), id);
+            return id;
+        }
+
+        std::string name(uint32_t id) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (id >= names_.size()) {
+                throw std::runtime_error("unknown interned id");
+            }
+            return names_[id];
+        }
+
+        std::vector<std::string> snapshot() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return std::vector<std::string>(names_.begin(), names_.end());
+        }
+
+    private:
+        std::mutex mutex_;
+        // deque never relocates its elements, so the views in ids_ stay valid
+        std::deque<std::string> names_;
+        std::unordered_map<std::string_view, uint32_t> ids_;
+    };
+}
+
+uint32_t intern_name(const std::string& name) {
+    return NameTable::instance().intern(name);
+}
+
+std::string id_to_name(uint32_t id) {
+    return NameTable::instance().name(id);
+}
+
+std::vector<std::string> id_to_name_table() {
+    return NameTable::instance().snapshot();
+}
+
 // ============================================================================
 // GiacContext Implementation
 // ============================================================================
@@ -718,6 +1005,14 @@ std::string Gen::symb_sommet_name() const {
     return impl_->g._SYMBptr->sommet.ptr()->print(&ctx);
 }
 
+uint32_t Gen::symb_sommet_id() const {
+    if (impl_->g.type != giac::_SYMB) {
+        throw std::runtime_error("gen is not symbolic");
+    }
+    giac::context& ctx = get_thread_local_context();
+    return NameTable::instance().intern(impl_->g._SYMBptr->sommet.ptr()->print(&ctx));
+}
+
 Gen Gen::symb_feuille() const {
     // REQ-C61, C62: Returns argument for _SYMB_, throws otherwise
     if (impl_->g.type != giac::_SYMB) {
@@ -731,6 +1026,13 @@ std::string Gen::idnt_name() const {
     return impl_->g.print(&ctx);  // For identifiers, print gives the name
 }
 
+uint32_t Gen::idnt_id() const {
+    if (impl_->g.type != giac::_IDNT) {
+        throw std::runtime_error("gen is not an identifier");
+    }
+    return NameTable::instance().intern(impl_->g._IDNTptr->id_name);
+}
+
 std::string Gen::strng_value() const {
     return *impl_->g._STRNGptr;
 }
@@ -916,33 +1218,48 @@ Gen make_zint_from_bytes(const std::vector<uint8_t>& bytes, int32_t sign) {
     return Gen(std::make_unique<GenImpl>(result));
 }
 
-Gen make_symbolic_unevaluated(const std::string& op_name, const std::vector<Gen>& args) {
-    initialize_giac_library();
-    giac::context& ctx = get_thread_local_context();
+namespace {
+    // Resolve an operator or function name to giac's function pointer.
+    // Infix operators are not in the function lookup table, so they are
+    // matched by the symbol giac prints for them.
+    giac::unary_function_ptr lookup_operator(const std::string& op_name, giac::context& ctx) {
+        static const std::unordered_map<std::string_view, const giac::unary_function_ptr*> infix = {
+            {"+", giac::at_plus},
+            {"-", giac::at_neg},  // For unary minus; binary minus is handled as + with negated arg
+            {"*", giac::at_prod},
+            {"/", giac::at_division},
+            {"^", giac::at_pow},
+            {"=", giac::at_equal},
+            {"==", giac::at_same},
+            {"!=", giac::at_different},
+            {"<", giac::at_inferieur_strict},
+            {"<=", giac::at_inferieur_egal},
+            {">", giac::at_superieur_strict},
+            {">=", giac::at_superieur_egal},
+            {"and", giac::at_and},
+            {"or", giac::at_ou},
+        };
+        auto it = infix.find(op_name);
+        if (it != infix.end()) {
+            return *it->second;
+        }
 
-    // Get the function pointer
-    const giac::unary_function_ptr* func_ptr = nullptr;
-
-    // Handle special operators that are not in the function lookup table
-    if (op_name == "+") {
-        func_ptr = giac::at_plus;
-    } else if (op_name == "-") {
-        func_ptr = giac::at_neg;  // For unary minus; binary minus is handled as + with negated arg
-    } else if (op_name == "*") {
-        func_ptr = giac::at_prod;
-    } else if (op_name == "/") {
-        func_ptr = giac::at_division;
-    } else if (op_name == "^") {
-        func_ptr = giac::at_pow;
-    } else {
         // Lookup function by name
         giac::gen func_gen(op_name, &ctx);
-
         if (func_gen.type != giac::_FUNC) {
             throw std::runtime_error("Unknown function or operator: " + op_name);
         }
-        func_ptr = func_gen._FUNCptr;
+        return *func_gen._FUNCptr;
     }
+}
+
+Gen make_symbolic_unevaluated(const std::string& op_name, const std::vector<Gen>& args) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+
+    // Get the function pointer
+    const giac::unary_function_ptr func = lookup_operator(op_name, ctx);
+    const giac::unary_function_ptr* func_ptr = &func;
 
     // Handle single argument vs multiple arguments
     if (args.size() == 1) {
@@ -1030,4 +1347,7073 @@ Gen gen_from_heap_ptr(void* ptr) {
     return Gen(std::make_unique<GenImpl>(*g));
 }
 
+// ============================================================================
+// Vector Reductions
+// ============================================================================
+
+namespace {
+    // Below this many terms per thread the pool overhead outweighs the gain
+    constexpr size_t kReduceTermsPerThread = 1024;
+
+    // Balanced pairwise reduction of `level` in place: each pass combines
+    // neighbours, so every term takes part in O(log n) operations and the
+    // partial results stay small.
+    template <class Op>
+    giac::gen pairwise_reduce(std::vector<giac::gen>& level, Op op) {
+        while (level.size() > 1) {
+            size_t n = level.size();
+            for (size_t i = 0; i < n / 2; ++i) {
+                level[i] = op(level[2 * i], level[2 * i + 1]);
+            }
+            if (n % 2 != 0) {
+                level[n / 2] = level[n - 1];
+            }
+            level.resize((n + 1) / 2);
+        }
+        return level.front();
+    }
+
+    template <class Op>
+    giac::gen reduce_terms(std::vector<giac::gen> terms, int32_t num_threads, Op op) {
+        size_t threads = std::min(WorkerPool::resolve_threads(num_threads),
+                                  terms.size() / kReduceTermsPerThread);
+        if (threads <= 1) {
+            return pairwise_reduce(terms, op);
+        }
+
+        // Each worker reduces a contiguous slice of privately owned copies
+        size_t chunk = (terms.size() + threads - 1) / threads;
+        size_t n_slices = (terms.size() + chunk - 1) / chunk;
+        std::vector<std::vector<giac::gen>> slices(n_slices);
+        for (size_t t = 0; t < n_slices; ++t) {
+            std::unordered_map<const char*, giac::gen> idents;
+            size_t begin = t * chunk;
+            size_t end = std::min(terms.size(), begin + chunk);
+            slices[t].reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                slices[t].push_back(thread_private_copy(terms[i], idents));
+            }
+        }
+        terms.clear();
+
+        std::vector<giac::gen> partials(n_slices);
+        WorkerPool::instance().run(n_slices, num_threads, [&](size_t t) {
+            partials[t] = pairwise_reduce(slices[t], op);
+            slices[t].clear();
+        });
+        return pairwise_reduce(partials, op);
+    }
+
+    std::vector<giac::gen> vect_elements(const giac::gen& v) {
+        if (v.type != giac::_VECT) {
+            throw std::runtime_error("gen is not a vector");
+        }
+        return std::vector<giac::gen>(v._VECTptr->begin(), v._VECTptr->end());
+    }
+
+    giac::gen sum_of(std::vector<giac::gen> terms, int32_t num_threads) {
+        initialize_giac_library();
+        if (terms.empty()) return giac::gen(0);
+        giac::gen sum = reduce_terms(std::move(terms), num_threads,
+            [](const giac::gen& a, const giac::gen& b) { return a + b; });
+        // Single normalization pass over the assembled sum
+        giac::context& ctx = get_thread_local_context();
+        return giac::eval(sum, &ctx);
+    }
+
+    giac::gen prod_of(std::vector<giac::gen> factors, int32_t num_threads) {
+        initialize_giac_library();
+        if (factors.empty()) return giac::gen(1);
+        giac::gen prod = reduce_terms(std::move(factors), num_threads,
+            [](const giac::gen& a, const giac::gen& b) { return a * b; });
+        giac::context& ctx = get_thread_local_context();
+        return giac::eval(prod, &ctx);
+    }
+}
+
+Gen vect_sum(const std::vector<Gen>& terms, int32_t num_threads) {
+    std::vector<giac::gen> gens;
+    gens.reserve(terms.size());
+    for (const auto& t : terms) gens.push_back(t.impl_->g);
+    return Gen(std::make_unique<GenImpl>(sum_of(std::move(gens), num_threads)));
+}
+
+Gen vect_sum(const Gen& v, int32_t num_threads) {
+    return Gen(std::make_unique<GenImpl>(sum_of(vect_elements(v.impl_->g), num_threads)));
+}
+
+Gen vect_prod(const std::vector<Gen>& factors, int32_t num_threads) {
+    std::vector<giac::gen> gens;
+    gens.reserve(factors.size());
+    for (const auto& f : factors) gens.push_back(f.impl_->g);
+    return Gen(std::make_unique<GenImpl>(prod_of(std::move(gens), num_threads)));
+}
+
+Gen vect_prod(const Gen& v, int32_t num_threads) {
+    return Gen(std::make_unique<GenImpl>(prod_of(vect_elements(v.impl_->g), num_threads)));
+}
+
+// ============================================================================
+// Vector Shape Census
+// ============================================================================
+
+namespace {
+    // Gen type codes fit in this many histogram slots (_FLOAT_ is 21)
+    constexpr size_t kGenTypeSlots = 32;
+
+    // Visit the leaves of the nested _VECT structure of g in row-major order,
+    // using an explicit stack so deeply nested lists cannot overflow.
+    template <class LeafFn>
+    void for_each_vect_leaf(const giac::gen& g, LeafFn leaf) {
+        std::vector<std::pair<const giac::gen*, size_t>> stack;
+        if (g.type != giac::_VECT) {
+            leaf(g);
+            return;
+        }
+        stack.emplace_back(&g, 0);
+        while (!stack.empty()) {
+            auto& top = stack.back();
+            const giac::vecteur& v = *top.first->_VECTptr;
+            if (top.second == v.size()) {
+                stack.pop_back();
+                continue;
+            }
+            const giac::gen& child = v[top.second++];
+            if (child.type == giac::_VECT) {
+                stack.emplace_back(&child, 0);
+            } else {
+                leaf(child);
+            }
+        }
+    }
+}
+
+GenDescription describe(const Gen& g) {
+    GenDescription d;
+    d.type_counts.assign(kGenTypeSlots, 0);
+    d.all_immediate_numeric = true;
+
+    std::vector<int64_t> level_sizes;  // size of the first vector seen per depth
+    int32_t leaf_depth = -1;           // depth of the first leaf seen
+    bool rectangular = true;
+
+    std::vector<std::pair<const giac::gen*, int32_t>> stack;
+    stack.emplace_back(&g.impl_->g, 0);
+    while (!stack.empty()) {
+        const giac::gen* node = stack.back().first;
+        int32_t depth = stack.back().second;
+        stack.pop_back();
+        ++d.node_count;
+
+        if (node->type == giac::_VECT) {
+            const giac::vecteur& v = *node->_VECTptr;
+            d.depth = std::max(d.depth, depth + 1);
+            if (static_cast<size_t>(depth) == level_sizes.size()) {
+                level_sizes.push_back(static_cast<int64_t>(v.size()));
+            } else if (level_sizes[depth] != static_cast<int64_t>(v.size())) {
+                rectangular = false;
+            }
+            if (leaf_depth >= 0 && depth >= leaf_depth) {
+                rectangular = false;  // a vector where siblings hold leaves
+            }
+            // Push in reverse so children are visited in order
+            for (auto it = v.rbegin(); it != v.rend(); ++it) {
+                stack.emplace_back(&*it, depth + 1);
+            }
+        } else {
+            size_t slot = std::min<size_t>(node->type, kGenTypeSlots - 1);
+            ++d.type_counts[slot];
+            if (node->type != giac::_INT_ && node->type != giac::_DOUBLE_) {
+                d.all_immediate_numeric = false;
+            }
+            if (leaf_depth < 0) {
+                leaf_depth = depth;
+                if (static_cast<size_t>(depth) < level_sizes.size()) {
+                    rectangular = false;  // deeper vectors already seen elsewhere
+                }
+            } else if (leaf_depth != depth) {
+                rectangular = false;
+            }
+        }
+    }
+
+    d.rectangular = rectangular;
+    if (rectangular) {
+        d.dims = std::move(level_sizes);
+    }
+    return d;
+}
+
+std::vector<double> flatten_doubles(const Gen& g) {
+    std::vector<double> out;
+    for_each_vect_leaf(g.impl_->g, [&out](const giac::gen& leaf) {
+        if (leaf.type == giac::_DOUBLE_) {
+            out.push_back(leaf._DOUBLE_val);
+        } else if (leaf.type == giac::_INT_) {
+            out.push_back(static_cast<double>(leaf.val));
+        } else {
+            throw std::runtime_error("vector leaf is not a numeric type");
+        }
+    });
+    return out;
+}
+
+std::vector<int64_t> flatten_int64s(const Gen& g) {
+    std::vector<int64_t> out;
+    for_each_vect_leaf(g.impl_->g, [&out](const giac::gen& leaf) {
+        if (leaf.type != giac::_INT_) {
+            throw std::runtime_error("vector leaf is not an integer");
+        }
+        out.push_back(static_cast<int64_t>(leaf.val));
+    });
+    return out;
+}
+
+// ============================================================================
+// Expression Tree Folds
+// ============================================================================
+
+namespace {
+    bool is_integer_gen(const giac::gen& g) {
+        return g.type == giac::_INT_ || g.type == giac::_ZINT;
+    }
+
+    // Depth-first pre-order walk over an expression tree with an explicit
+    // stack. visit(node, depth) returns false to stop the whole walk.
+    // Argument sequences of _SYMB nodes are not nodes of their own: the
+    // arguments are visited directly as children of the operator.
+    template <class Visit>
+    void walk_tree(const giac::gen& root, Visit visit) {
+        std::vector<std::pair<const giac::gen*, int32_t>> stack;
+        stack.emplace_back(&root, 1);
+
+        auto push_all = [&stack](const giac::vecteur& v, int32_t depth) {
+            for (auto it = v.rbegin(); it != v.rend(); ++it) {
+                stack.emplace_back(&*it, depth);
+            }
+        };
+
+        while (!stack.empty()) {
+            const giac::gen* node = stack.back().first;
+            int32_t depth = stack.back().second;
+            stack.pop_back();
+            if (!visit(*node, depth)) return;
+
+            switch (node->type) {
+                case giac::_SYMB: {
+                    const giac::gen& f = node->_SYMBptr->feuille;
+                    if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+                        push_all(*f._VECTptr, depth + 1);
+                    } else {
+                        stack.emplace_back(&f, depth + 1);
+                    }
+                    break;
+                }
+                case giac::_VECT:
+                    push_all(*node->_VECTptr, depth + 1);
+                    break;
+                case giac::_CPLX:
+                    stack.emplace_back(node->_CPLXptr + 1, depth + 1);
+                    stack.emplace_back(node->_CPLXptr, depth + 1);
+                    break;
+                case giac::_FRAC:
+                    if (!is_integer_gen(node->_FRACptr->num) || !is_integer_gen(node->_FRACptr->den)) {
+                        stack.emplace_back(&node->_FRACptr->den, depth + 1);
+                        stack.emplace_back(&node->_FRACptr->num, depth + 1);
+                    }
+                    break;
+                case giac::_MAP:
+                    for (const auto& kv : *node->_MAPptr) {
+                        stack.emplace_back(&kv.second, depth + 1);
+                        stack.emplace_back(&kv.first, depth + 1);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // Real value of a numeric leaf, if it has one
+    bool numeric_leaf_value(const giac::gen& g, double& out) {
+        switch (g.type) {
+            case giac::_INT_:
+                out = static_cast<double>(g.val);
+                return true;
+            case giac::_DOUBLE_:
+                out = g._DOUBLE_val;
+                return true;
+            case giac::_ZINT:
+                out = mpz_get_d(*g._ZINTptr);
+                return true;
+            case giac::_FRAC:
+            case giac::_REAL: {
+                if (g.type == giac::_FRAC &&
+                    (!is_integer_gen(g._FRACptr->num) || !is_integer_gen(g._FRACptr->den))) {
+                    return false;
+                }
+                giac::context& ctx = get_thread_local_context();
+                giac::gen d = giac::evalf_double(g, 1, &ctx);
+                if (d.type != giac::_DOUBLE_) return false;
+                out = d._DOUBLE_val;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+TreeSummary fold_tree(const Gen& g, int32_t reducers) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    TreeSummary summary;
+
+    // Keyed by pointer during the walk; names are resolved once at the end
+    std::unordered_map<const char*, bool> idents;
+    std::unordered_map<const giac::unary_function_abstract*, int64_t> ops;
+
+    walk_tree(g.impl_->g, [&](const giac::gen& node, int32_t depth) {
+        if (reducers & TREE_NODE_COUNT) ++summary.node_count;
+        if (reducers & TREE_DEPTH) summary.depth = std::max(summary.depth, depth);
+
+        if (node.type == giac::_IDNT) {
+            if (reducers & TREE_IDENTIFIERS) idents.emplace(node._IDNTptr->id_name, true);
+        } else if (node.type == giac::_SYMB) {
+            if (reducers & TREE_OPERATORS) ++ops[node._SYMBptr->sommet.ptr()];
+        } else if (reducers & TREE_NUMERIC_RANGE) {
+            double value;
+            if (numeric_leaf_value(node, value)) {
+                if (summary.numeric_leaf_count == 0) {
+                    summary.numeric_min = summary.numeric_max = value;
+                } else {
+                    summary.numeric_min = std::min(summary.numeric_min, value);
+                    summary.numeric_max = std::max(summary.numeric_max, value);
+                }
+                ++summary.numeric_leaf_count;
+            }
+        }
+        return true;
+    });
+
+    if (!idents.empty()) {
+        std::set<std::string> names;
+        for (const auto& kv : idents) names.insert(kv.first);
+        summary.identifiers.assign(names.begin(), names.end());
+    }
+    if (!ops.empty()) {
+        // Distinct function objects may share a printed name
+        std::map<std::string, int64_t> by_name;
+        for (const auto& kv : ops) by_name[kv.first->print(&ctx)] += kv.second;
+        for (const auto& kv : by_name) {
+            summary.operator_names.push_back(kv.first);
+            summary.operator_counts.push_back(kv.second);
+        }
+    }
+    return summary;
+}
+
+bool contains_function(const Gen& g, const std::string& name) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    bool found = false;
+    walk_tree(g.impl_->g, [&](const giac::gen& node, int32_t) {
+        if (node.type == giac::_SYMB && name == node._SYMBptr->sommet.ptr()->print(&ctx)) {
+            found = true;
+        }
+        return !found;
+    });
+    return found;
+}
+
+// ============================================================================
+// Native Printers
+// ============================================================================
+
+namespace {
+    // Append-only sink shared by the native printers: every token goes
+    // straight into one buffer, so printing a tree never builds a string per
+    // node. Numbers are formatted in place. An optional byte limit lets
+    // bounded printers stop early; the buffer itself never cuts a token.
+    class OutBuffer {
+    public:
+        explicit OutBuffer(std::string& out, size_t limit = std::string::npos)
+            : out_(out), limit_(limit) {}
+
+        // Streaming mode: pending bytes are written to fd whenever
+        // flush_at of them accumulate, so the buffer never grows past one
+        // chunk plus the largest single token
+        OutBuffer(std::string& out, int fd, size_t flush_at)
+            : out_(out), limit_(std::string::npos), fd_(fd), flush_at_(flush_at) {}
+
+        void flush() {
+            size_t done = 0;
+            while (done < out_.size()) {
+                auto n = ::write(fd_, out_.data() + done, out_.size() - done);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("write_gen: write failed: ") +
+                                             std::strerror(errno));
+                }
+                done += static_cast<size_t>(n);
+            }
+            out_.clear();
+        }
+
+        bool full() const { return out_.size() >= limit_; }
+        bool bounded() const { return limit_ != std::string::npos; }
+        size_t room() const { return full() ? 0 : limit_ - out_.size(); }
+        bool truncated() const { return truncated_; }
+        void mark_truncated() { truncated_ = true; }
+
+        void put(char c) { out_.push_back(c); pending(); }
+        void put(const char* s) { out_.append(s); pending(); }
+        void put(const char* s, size_t n) { out_.append(s, n); pending(); }
+        void put(const std::string& s) { out_.append(s); pending(); }
+
+        void put_int(long long v) {
+            char buf[24];
+            int n = std::snprintf(buf, sizeof(buf), "%lld", v);
+            put(buf, static_cast<size_t>(n));
+        }
+
+        // Shortest decimal form that reads back to the same double
+        void put_double(double v) {
+            char buf[32];
+            put(buf, format_double(v, buf, sizeof(buf)));
+        }
+
+        static size_t format_double(double v, char* buf, size_t size) {
+            int n = 0;
+            for (int prec = 15; prec <= 17; ++prec) {
+                n = std::snprintf(buf, size, "%.*g", prec, v);
+                if (std::strtod(buf, nullptr) == v) break;
+            }
+            return static_cast<size_t>(n);
+        }
+
+        void put_mpz(const mpz_t z) {
+            size_t pos = out_.size();
+            out_.resize(pos + mpz_sizeinbase(z, 10) + 2);
+            mpz_get_str(&out_[pos], 10, z);
+            out_.resize(pos + std::strlen(&out_[pos]));
+            pending();
+        }
+
+        // Magnitude of z as a u64 byte count then little-endian bytes
+        void put_mpz_magnitude(const mpz_t z) {
+            size_t count = (mpz_sizeinbase(z, 2) + 7) / 8;
+            if (mpz_sgn(z) == 0) count = 0;
+            put_u64(count);
+            size_t pos = out_.size();
+            out_.resize(pos + count);
+            size_t written = 0;
+            if (count) mpz_export(&out_[pos], &written, -1, 1, -1, 0, z);
+            out_.resize(pos + written);
+            pending();
+        }
+
+        void put_u64(uint64_t v) {
+            char b[8];
+            for (int i = 0; i < 8; ++i) b[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+            put(b, 8);
+        }
+
+    private:
+        std::string& out_;
+        size_t limit_;
+        bool truncated_ = false;
+        int fd_ = -1;
+        size_t flush_at_ = 0;
+
+        void pending() {
+            if (fd_ >= 0 && out_.size() >= flush_at_) flush();
+        }
+    };
+
+    // Reused per-thread scratch buffer for printers returning std::string
+    std::string& printer_scratch() {
+        thread_local std::string buf;
+        buf.clear();
+        return buf;
+    }
+
+    bool is_negative_number(const giac::gen& g) {
+        switch (g.type) {
+            case giac::_INT_: return g.val < 0;
+            case giac::_DOUBLE_: return g._DOUBLE_val < 0 || std::signbit(g._DOUBLE_val);
+            case giac::_ZINT: return mpz_sgn(*g._ZINTptr) < 0;
+            case giac::_FRAC: return is_negative_number(g._FRACptr->num);
+            default: return false;
+        }
+    }
+
+    bool is_exact_zero(const giac::gen& g) {
+        return (g.type == giac::_INT_ && g.val == 0) ||
+               (g.type == giac::_DOUBLE_ && g._DOUBLE_val == 0.0);
+    }
+
+    // Arguments of a symbolic node as a flat list
+    const giac::gen* symb_args(const giac::gen& g, size_t& n) {
+        const giac::gen& f = g._SYMBptr->feuille;
+        if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+            n = f._VECTptr->size();
+            return n ? f._VECTptr->data() : nullptr;
+        }
+        n = 1;
+        return &f;
+    }
+
+    bool is_comparison(const giac::unary_function_ptr& s) {
+        return s == giac::at_equal || s == giac::at_same || s == giac::at_different ||
+               s == giac::at_inferieur_strict || s == giac::at_inferieur_egal ||
+               s == giac::at_superieur_strict || s == giac::at_superieur_egal;
+    }
+
+    // Binding strength of the construct being printed; a child whose own
+    // precedence is lower than its context gets parenthesized. Shared by
+    // all infix printers so they agree on where grouping is needed.
+    enum PrintPrec { P_LOWEST, P_OR, P_AND, P_CMP, P_SUM, P_PROD, P_UNARY, P_POW, P_ATOM };
+
+    int print_precedence(const giac::gen& g) {
+        switch (g.type) {
+            case giac::_INT_:
+            case giac::_DOUBLE_:
+            case giac::_ZINT:
+                return is_negative_number(g) ? P_UNARY : P_ATOM;
+            case giac::_CPLX:
+                return is_exact_zero(*g._CPLXptr) ? P_PROD : P_SUM;
+            case giac::_SYMB: {
+                const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+                if (s == giac::at_plus || s == giac::at_binary_minus) return P_SUM;
+                if (s == giac::at_prod || s == giac::at_inv || s == giac::at_division) return P_PROD;
+                if (s == giac::at_neg || s == giac::at_not) return P_UNARY;
+                if (s == giac::at_pow) return P_POW;
+                if (s == giac::at_and) return P_AND;
+                if (s == giac::at_ou) return P_OR;
+                if (is_comparison(s)) return P_CMP;
+                return P_ATOM;  // function call
+            }
+            default:
+                return P_ATOM;  // fractions print as a grouped unit
+        }
+    }
+
+    bool is_inv(const giac::gen& g) {
+        return g.type == giac::_SYMB && g._SYMBptr->sommet == giac::at_inv;
+    }
+
+    // ------------------------------------------------------------------------
+    // Julia syntax
+    // ------------------------------------------------------------------------
+
+    class JuliaPrinter {
+    public:
+        JuliaPrinter(OutBuffer& out, giac::context* ctx, bool broadcast)
+            : out_(out), ctx_(ctx), dot_(broadcast) {}
+
+        void print(const giac::gen& g, int ctx_prec) {
+            int prec = print_precedence(g);
+            bool paren = prec < ctx_prec;
+            if (paren) out_.put('(');
+            print_bare(g);
+            if (paren) out_.put(')');
+        }
+
+    private:
+        OutBuffer& out_;
+        giac::context* ctx_;
+        bool dot_;
+
+        void op(const char* o) {
+            out_.put(' ');
+            if (dot_) out_.put('.');
+            out_.put(o);
+            out_.put(' ');
+        }
+
+        static const char* comparison(const giac::unary_function_ptr& s) {
+            if (s == giac::at_equal || s == giac::at_same) return "==";
+            if (s == giac::at_different) return "!=";
+            if (s == giac::at_inferieur_strict) return "<";
+            if (s == giac::at_inferieur_egal) return "<=";
+            if (s == giac::at_superieur_strict) return ">";
+            if (s == giac::at_superieur_egal) return ">=";
+            return nullptr;
+        }
+
+        static const char* julia_function_name(const char* giac_name) {
+            static const std::unordered_map<std::string_view, const char*> names = {
+                {"ln", "log"}, {"re", "real"}, {"im", "imag"}, {"arg", "angle"},
+                {"evalf", "float"}, {"sq", "abs2"},
+            };
+            auto it = names.find(giac_name);
+            return it == names.end() ? giac_name : it->second;
+        }
+
+        void print_bare(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                    out_.put_int(g.val);
+                    return;
+                case giac::_DOUBLE_:
+                    print_double(g._DOUBLE_val);
+                    return;
+                case giac::_ZINT:
+                    out_.put_mpz(*g._ZINTptr);
+                    return;
+                case giac::_FRAC:
+                    out_.put('(');
+                    print(g._FRACptr->num, P_UNARY);
+                    // Scalar literal: never dotted ("1.//2" would lex as 1.0)
+                    out_.put("//");
+                    print(g._FRACptr->den, P_POW);
+                    out_.put(')');
+                    return;
+                case giac::_CPLX:
+                    print_complex(*g._CPLXptr, *(g._CPLXptr + 1));
+                    return;
+                case giac::_IDNT:
+                    print_identifier(g._IDNTptr->id_name);
+                    return;
+                case giac::_STRNG:
+                    print_string(*g._STRNGptr);
+                    return;
+                case giac::_VECT:
+                    print_vect(g);
+                    return;
+                case giac::_SYMB:
+                    print_symbolic(g);
+                    return;
+                case giac::_REAL:
+                    // Multiprecision float: keep every digit giac has
+                    out_.put("big\"");
+                    out_.put(g.print(ctx_));
+                    out_.put('"');
+                    return;
+                default:
+                    out_.put(g.print(ctx_));
+                    return;
+            }
+        }
+
+        void print_double(double v) {
+            if (std::isnan(v)) { out_.put("NaN"); return; }
+            if (std::isinf(v)) { out_.put(v < 0 ? "-Inf" : "Inf"); return; }
+            char buf[32];
+            size_t n = OutBuffer::format_double(v, buf, sizeof(buf) - 2);
+            // Julia needs a decimal point or exponent to read a Float64
+            if (!std::memchr(buf, '.', n) && !std::memchr(buf, 'e', n)) {
+                buf[n++] = '.';
+                buf[n++] = '0';
+            }
+            out_.put(buf, n);
+        }
+
+        void print_complex(const giac::gen& re, const giac::gen& im) {
+            if (!is_exact_zero(re)) {
+                print(re, P_SUM);
+                if (is_negative_number(im)) {
+                    op("-");
+                    print_scaled_im(-im);
+                } else {
+                    op("+");
+                    print_scaled_im(im);
+                }
+            } else {
+                print_scaled_im(im);
+            }
+        }
+
+        void print_scaled_im(const giac::gen& im) {
+            print(im, P_PROD);
+            out_.put(dot_ ? " .* im" : " * im");
+        }
+
+        void print_identifier(const char* name) {
+            static const std::unordered_map<std::string_view, const char*> constants = {
+                {"infinity", "Inf"}, {"undef", "NaN"},
+                {"euler_gamma", "Base.MathConstants.eulergamma"},
+            };
+            auto it = constants.find(name);
+            out_.put(it == constants.end() ? name : it->second);
+        }
+
+        void print_string(const std::string& s) {
+            out_.put('"');
+            for (char c : s) {
+                switch (c) {
+                    case '"': out_.put("\\\""); break;
+                    case '\\': out_.put("\\\\"); break;
+                    case '$': out_.put("\\$"); break;
+                    case '\n': out_.put("\\n"); break;
+                    case '\t': out_.put("\\t"); break;
+                    default: out_.put(c); break;
+                }
+            }
+            out_.put('"');
+        }
+
+        void print_vect(const giac::gen& g) {
+            const giac::vecteur& v = *g._VECTptr;
+            if (!v.empty() && giac::ckmatrix(g)) {
+                // Matrix literal; entries at atom precedence so "-2" and
+                // "a + b" never split into separate columns
+                out_.put('[');
+                for (size_t i = 0; i < v.size(); ++i) {
+                    if (i > 0) out_.put("; ");
+                    const giac::vecteur& row = *v[i]._VECTptr;
+                    for (size_t j = 0; j < row.size(); ++j) {
+                        if (j > 0) out_.put(' ');
+                        print(row[j], P_ATOM);
+                    }
+                }
+                // "[1; 2]" would read back as a Vector; ";;" keeps one column a Matrix
+                if (v[0]._VECTptr->size() == 1) out_.put(";;");
+                out_.put(']');
+                return;
+            }
+            const char* open = "[";
+            const char* close = "]";
+            if (g.subtype == giac::_SEQ__VECT) {
+                open = "(";
+                close = v.size() == 1 ? ",)" : ")";
+            } else if (g.subtype == giac::_SET__VECT) {
+                open = "Set([";
+                close = "])";
+            }
+            out_.put(open);
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (i > 0) out_.put(", ");
+                print(v[i], P_LOWEST);
+            }
+            out_.put(close);
+        }
+
+        void print_symbolic(const giac::gen& g) {
+            const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+            size_t n = 0;
+            const giac::gen* args = symb_args(g, n);
+
+            if (s == giac::at_plus) {
+                for (size_t i = 0; i < n; ++i) {
+                    const giac::gen& a = args[i];
+                    if (i == 0) {
+                        print(a, P_SUM);
+                    } else if (a.type == giac::_SYMB && a._SYMBptr->sommet == giac::at_neg) {
+                        op("-");
+                        print(a._SYMBptr->feuille, P_PROD);
+                    } else if (is_negative_number(a) && a.type != giac::_FRAC) {
+                        op("-");
+                        print(-a, P_PROD);
+                    } else {
+                        op("+");
+                        print(a, P_SUM);
+                    }
+                }
+                return;
+            }
+            if (s == giac::at_binary_minus && n == 2) {
+                print(args[0], P_SUM);
+                op("-");
+                print(args[1], P_PROD);
+                return;
+            }
+            if (s == giac::at_prod) {
+                // Collect inv(...) factors as a trailing denominator
+                bool any = false;
+                for (size_t i = 0; i < n; ++i) {
+                    if (is_inv(args[i])) continue;
+                    if (any) op("*");
+                    print(args[i], P_PROD);
+                    any = true;
+                }
+                if (!any) out_.put('1');
+                for (size_t i = 0; i < n; ++i) {
+                    if (!is_inv(args[i])) continue;
+                    op("/");
+                    print(args[i]._SYMBptr->feuille, P_UNARY);
+                }
+                return;
+            }
+            if (s == giac::at_inv) {
+                out_.put('1');
+                op("/");
+                print(g._SYMBptr->feuille, P_UNARY);
+                return;
+            }
+            if (s == giac::at_division && n == 2) {
+                print(args[0], P_PROD);
+                op("/");
+                print(args[1], P_UNARY);
+                return;
+            }
+            if (s == giac::at_neg) {
+                out_.put('-');
+                print(g._SYMBptr->feuille, P_POW);
+                return;
+            }
+            if (s == giac::at_not) {
+                out_.put(dot_ ? ".!" : "!");
+                print(g._SYMBptr->feuille, P_POW);
+                return;
+            }
+            if (s == giac::at_pow && n == 2) {
+                print(args[0], P_ATOM);
+                op("^");
+                print(args[1], P_POW);
+                return;
+            }
+            if ((s == giac::at_and || s == giac::at_ou) && n >= 2) {
+                int p = s == giac::at_and ? P_AND : P_OR;
+                const char* o = s == giac::at_and ? (dot_ ? "&" : "&&") : (dot_ ? "|" : "||");
+                for (size_t i = 0; i < n; ++i) {
+                    if (i > 0) op(o);
+                    print(args[i], p + 1);
+                }
+                return;
+            }
+            if (const char* cmp = comparison(s)) {
+                if (n == 2) {
+                    print(args[0], P_SUM);
+                    op(cmp);
+                    print(args[1], P_SUM);
+                    return;
+                }
+            }
+
+            // Function call
+            out_.put(julia_function_name(s.ptr()->print(ctx_)));
+            if (dot_) out_.put('.');
+            out_.put('(');
+            for (size_t i = 0; i < n; ++i) {
+                if (i > 0) out_.put(", ");
+                print(args[i], P_LOWEST);
+            }
+            out_.put(')');
+        }
+    };
+}
+
+std::string to_julia_syntax(const Gen& g, bool broadcast) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    std::string& buf = printer_scratch();
+    OutBuffer out(buf);
+    JuliaPrinter(out, &ctx, broadcast).print(g.impl_->g, P_LOWEST);
+    return buf;
+}
+
+namespace {
+    // Base for printers with a byte budget. The budget is checked before
+    // each node and between list elements, so work stops within one node
+    // of the limit; enclosing nodes still write their closing delimiters so
+    // the truncated text stays well formed.
+    class BoundedPrinter {
+    protected:
+        BoundedPrinter(OutBuffer& out, giac::context* ctx, const char* marker)
+            : out_(out), ctx_(ctx), marker_(marker) {}
+
+        OutBuffer& out_;
+        giac::context* ctx_;
+
+        // True once the budget is spent; the first call leaves the marker
+        bool exhausted() {
+            if (!out_.full()) return false;
+            elide();
+            return true;
+        }
+
+        bool elided() const { return elided_; }
+
+        // marker overrides the printer's marker, e.g. with bare text when
+        // the cut falls inside a token element
+        void elide(const char* marker = nullptr) {
+            if (elided_) return;
+            out_.put(marker ? marker : marker_);
+            out_.mark_truncated();
+            elided_ = true;
+        }
+
+        // Huge integers are elided rather than expanded past the budget
+        bool put_bounded_mpz(const mpz_t z) {
+            if (mpz_sizeinbase(z, 10) > out_.room()) {
+                elide();
+                return false;
+            }
+            out_.put_mpz(z);
+            return true;
+        }
+
+    private:
+        const char* marker_;
+        bool elided_ = false;
+    };
+
+    bool is_one_half(const giac::gen& g) {
+        return g.type == giac::_FRAC &&
+               g._FRACptr->num.type == giac::_INT_ && g._FRACptr->num.val == 1 &&
+               g._FRACptr->den.type == giac::_INT_ && g._FRACptr->den.val == 2;
+    }
+
+    // Symbol for well-known identifier names, as a LaTeX command or an XML
+    // character reference
+    const char* greek_symbol(const char* name, bool latex) {
+        struct Sym { const char* tex; const char* xml; };
+        static const std::unordered_map<std::string_view, Sym> symbols = {
+            {"alpha", {"\\alpha", "&#x3B1;"}}, {"beta", {"\\beta", "&#x3B2;"}},
+            {"gamma", {"\\gamma", "&#x3B3;"}}, {"delta", {"\\delta", "&#x3B4;"}},
+            {"epsilon", {"\\epsilon", "&#x3B5;"}}, {"zeta", {"\\zeta", "&#x3B6;"}},
+            {"eta", {"\\eta", "&#x3B7;"}}, {"theta", {"\\theta", "&#x3B8;"}},
+            {"kappa", {"\\kappa", "&#x3BA;"}}, {"lambda", {"\\lambda", "&#x3BB;"}},
+            {"mu", {"\\mu", "&#x3BC;"}}, {"nu", {"\\nu", "&#x3BD;"}},
+            {"xi", {"\\xi", "&#x3BE;"}}, {"pi", {"\\pi", "&#x3C0;"}},
+            {"rho", {"\\rho", "&#x3C1;"}}, {"sigma", {"\\sigma", "&#x3C3;"}},
+            {"tau", {"\\tau", "&#x3C4;"}}, {"phi", {"\\phi", "&#x3C6;"}},
+            {"chi", {"\\chi", "&#x3C7;"}}, {"psi", {"\\psi", "&#x3C8;"}},
+            {"omega", {"\\omega", "&#x3C9;"}}, {"infinity", {"\\infty", "&#x221E;"}},
+            {"euler_gamma", {"\\gamma", "&#x3B3;"}},
+        };
+        auto it = symbols.find(name);
+        if (it == symbols.end()) return nullptr;
+        return latex ? it->second.tex : it->second.xml;
+    }
+
+    // giac syntax of g cut at max_chars (npos for no limit), for types the
+    // typeset printers have no form of their own for. Returns whether it
+    // was cut. Defined with LimitedPrinter below.
+    bool print_limited(const giac::gen& g, giac::context* ctx, size_t max_chars,
+                       std::string& text);
+
+    // ------------------------------------------------------------------------
+    // LaTeX
+    // ------------------------------------------------------------------------
+
+    class LatexPrinter : BoundedPrinter {
+    public:
+        LatexPrinter(OutBuffer& out, giac::context* ctx)
+            : BoundedPrinter(out, ctx, "\\ldots") {}
+
+        void print(const giac::gen& g, int ctx_prec) {
+            if (exhausted()) return;
+            bool paren = print_precedence(g) < ctx_prec;
+            if (paren) out_.put("\\left(");
+            print_bare(g);
+            if (paren) out_.put("\\right)");
+        }
+
+    private:
+        static const char* comparison(const giac::unary_function_ptr& s) {
+            if (s == giac::at_equal || s == giac::at_same) return " = ";
+            if (s == giac::at_different) return " \\neq ";
+            if (s == giac::at_inferieur_strict) return " < ";
+            if (s == giac::at_inferieur_egal) return " \\leq ";
+            if (s == giac::at_superieur_strict) return " > ";
+            return " \\geq ";
+        }
+
+        // Functions LaTeX typesets upright with a dedicated command
+        static bool has_latex_command(const char* name) {
+            static const std::set<std::string_view> commands = {
+                "sin", "cos", "tan", "cot", "sec", "csc", "sinh", "cosh", "tanh",
+                "coth", "arcsin", "arccos", "arctan", "exp", "ln", "log", "det",
+                "max", "min", "gcd", "arg",
+            };
+            return commands.count(name) != 0;
+        }
+
+        void print_bare(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                    out_.put_int(g.val);
+                    return;
+                case giac::_DOUBLE_:
+                    print_double(g._DOUBLE_val);
+                    return;
+                case giac::_ZINT:
+                    put_bounded_mpz(*g._ZINTptr);
+                    return;
+                case giac::_FRAC:
+                    out_.put("\\frac{");
+                    print(g._FRACptr->num, P_LOWEST);
+                    out_.put("}{");
+                    print(g._FRACptr->den, P_LOWEST);
+                    out_.put('}');
+                    return;
+                case giac::_CPLX: {
+                    const giac::gen& re = *g._CPLXptr;
+                    const giac::gen& im = *(g._CPLXptr + 1);
+                    if (!is_exact_zero(re)) {
+                        print(re, P_SUM);
+                        out_.put(is_negative_number(im) ? " - " : " + ");
+                        print(is_negative_number(im) ? -im : im, P_PROD);
+                    } else {
+                        print(im, P_PROD);
+                    }
+                    out_.put(" i");
+                    return;
+                }
+                case giac::_IDNT:
+                    print_identifier(g._IDNTptr->id_name);
+                    return;
+                case giac::_STRNG:
+                    out_.put("\\text{");
+                    put_escaped(g._STRNGptr->data(), g._STRNGptr->size());
+                    out_.put('}');
+                    return;
+                case giac::_VECT:
+                    print_vect(g);
+                    return;
+                case giac::_SYMB:
+                    print_symbolic(g);
+                    return;
+                default: {
+                    std::string text;
+                    bool cut = print_limited(g, ctx_, out_.bounded() ? out_.room()
+                                                                     : std::string::npos, text);
+                    out_.put("\\mathrm{");
+                    put_escaped(text.data(), text.size());
+                    out_.put('}');
+                    if (cut) out_.mark_truncated();
+                    return;
+                }
+            }
+        }
+
+        void print_double(double v) {
+            if (std::isnan(v)) { out_.put("\\mathrm{NaN}"); return; }
+            if (std::isinf(v)) { out_.put(v < 0 ? "-\\infty" : "\\infty"); return; }
+            char buf[32];
+            size_t n = OutBuffer::format_double(v, buf, sizeof(buf));
+            const char* e = static_cast<const char*>(std::memchr(buf, 'e', n));
+            if (!e) {
+                out_.put(buf, n);
+                return;
+            }
+            // 1.5e-10 -> 1.5 \cdot 10^{-10}
+            out_.put(buf, static_cast<size_t>(e - buf));
+            out_.put(" \\cdot 10^{");
+            const char* exp = e + 1;
+            if (*exp == '+') ++exp;
+            while (*exp == '0' && exp[1]) ++exp;
+            if (*exp == '-') {
+                out_.put('-');
+                ++exp;
+                while (*exp == '0' && exp[1]) ++exp;
+            }
+            out_.put(exp, static_cast<size_t>(buf + n - exp));
+            out_.put('}');
+        }
+
+        void print_identifier(const char* name) {
+            if (const char* sym = greek_symbol(name, true)) {
+                out_.put(sym);
+                return;
+            }
+            size_t n = std::strlen(name);
+            if (n == 1) {
+                out_.put(name, 1);
+                return;
+            }
+            out_.put("\\mathrm{");
+            put_escaped(name, n);
+            out_.put('}');
+        }
+
+        void put_escaped(const char* s, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                if (out_.full()) {
+                    elide();
+                    return;
+                }
+                switch (s[i]) {
+                    case '\\': out_.put("\\textbackslash{}"); break;
+                    case '{': case '}': case '_': case '&': case '%':
+                    case '$': case '#':
+                        out_.put('\\');
+                        out_.put(s[i]);
+                        break;
+                    case '^': out_.put("\\^{}"); break;
+                    case '~': out_.put("\\~{}"); break;
+                    default: out_.put(s[i]); break;
+                }
+            }
+        }
+
+        void print_list(const giac::vecteur& v, const char* sep) {
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (exhausted()) break;
+                if (i > 0) out_.put(sep);
+                print(v[i], P_LOWEST);
+            }
+        }
+
+        void print_vect(const giac::gen& g) {
+            const giac::vecteur& v = *g._VECTptr;
+            if (!v.empty() && giac::ckmatrix(g)) {
+                out_.put("\\begin{pmatrix}");
+                for (size_t i = 0; i < v.size(); ++i) {
+                    if (exhausted()) break;
+                    out_.put(i > 0 ? " \\\\ " : " ");
+                    print_list(*v[i]._VECTptr, " & ");
+                }
+                out_.put(" \\end{pmatrix}");
+                return;
+            }
+            if (g.subtype == giac::_SEQ__VECT) {
+                print_list(v, ", ");
+            } else if (g.subtype == giac::_SET__VECT) {
+                out_.put("\\left\\{");
+                print_list(v, ", ");
+                out_.put("\\right\\}");
+            } else {
+                out_.put("\\left[");
+                print_list(v, ", ");
+                out_.put("\\right]");
+            }
+        }
+
+        // Product of the (non-)inverse factors of a _SYMB product
+        void print_factors(const giac::gen* args, size_t n, bool inverses) {
+            bool any = false;
+            for (size_t i = 0; i < n; ++i) {
+                if (is_inv(args[i]) != inverses) continue;
+                if (exhausted()) break;
+                if (any) out_.put(" \\cdot ");
+                print(inverses ? args[i]._SYMBptr->feuille : args[i], P_PROD);
+                any = true;
+            }
+            if (!any) out_.put('1');
+        }
+
+        void print_symbolic(const giac::gen& g) {
+            const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+            const giac::gen& f = g._SYMBptr->feuille;
+            size_t n = 0;
+            const giac::gen* args = symb_args(g, n);
+
+            if (s == giac::at_plus) {
+                for (size_t i = 0; i < n; ++i) {
+                    if (exhausted()) break;
+                    const giac::gen& a = args[i];
+                    if (i > 0 && a.type == giac::_SYMB && a._SYMBptr->sommet == giac::at_neg) {
+                        out_.put(" - ");
+                        print(a._SYMBptr->feuille, P_PROD);
+                    } else if (i > 0 && is_negative_number(a)) {
+                        out_.put(" - ");
+                        print(-a, P_PROD);
+                    } else {
+                        if (i > 0) out_.put(" + ");
+                        print(a, P_SUM);
+                    }
+                }
+                return;
+            }
+            if (s == giac::at_binary_minus && n == 2) {
+                print(args[0], P_SUM);
+                out_.put(" - ");
+                print(args[1], P_PROD);
+                return;
+            }
+            if (s == giac::at_prod) {
+                bool has_den = false;
+                for (size_t i = 0; i < n; ++i) has_den = has_den || is_inv(args[i]);
+                if (!has_den) {
+                    print_factors(args, n, false);
+                    return;
+                }
+                out_.put("\\frac{");
+                print_factors(args, n, false);
+                out_.put("}{");
+                print_factors(args, n, true);
+                out_.put('}');
+                return;
+            }
+            if (s == giac::at_inv || (s == giac::at_division && n == 2)) {
+                out_.put("\\frac{");
+                if (s == giac::at_inv) out_.put('1');
+                else print(args[0], P_LOWEST);
+                out_.put("}{");
+                print(s == giac::at_inv ? f : args[1], P_LOWEST);
+                out_.put('}');
+                return;
+            }
+            if (s == giac::at_neg) {
+                out_.put('-');
+                print(f, P_POW);
+                return;
+            }
+            if (s == giac::at_not) {
+                out_.put("\\lnot ");
+                print(f, P_POW);
+                return;
+            }
+            if (s == giac::at_pow && n == 2) {
+                if (is_one_half(args[1])) {
+                    out_.put("\\sqrt{");
+                    print(args[0], P_LOWEST);
+                    out_.put('}');
+                    return;
+                }
+                out_.put('{');
+                print(args[0], P_ATOM);
+                out_.put("}^{");
+                print(args[1], P_LOWEST);
+                out_.put('}');
+                return;
+            }
+            if ((s == giac::at_and || s == giac::at_ou) && n >= 2) {
+                int p = s == giac::at_and ? P_AND : P_OR;
+                for (size_t i = 0; i < n; ++i) {
+                    if (exhausted()) break;
+                    if (i > 0) out_.put(s == giac::at_and ? " \\land " : " \\lor ");
+                    print(args[i], p + 1);
+                }
+                return;
+            }
+            if (is_comparison(s) && n == 2) {
+                print(args[0], P_SUM);
+                out_.put(comparison(s));
+                print(args[1], P_SUM);
+                return;
+            }
+            if (s == giac::at_sqrt) {
+                out_.put("\\sqrt{");
+                print(f, P_LOWEST);
+                out_.put('}');
+                return;
+            }
+            if (s == giac::at_exp) {
+                out_.put("e^{");
+                print(f, P_LOWEST);
+                out_.put('}');
+                return;
+            }
+            if (s == giac::at_abs) {
+                out_.put("\\left|");
+                print(f, P_LOWEST);
+                out_.put("\\right|");
+                return;
+            }
+            if (s == giac::at_factorial) {
+                print(f, P_ATOM);
+                out_.put('!');
+                return;
+            }
+
+            // Function call
+            const char* name = s.ptr()->print(ctx_);
+            if (has_latex_command(name)) {
+                out_.put('\\');
+                out_.put(name);
+            } else {
+                out_.put("\\mathrm{");
+                put_escaped(name, std::strlen(name));
+                out_.put('}');
+            }
+            out_.put("\\left(");
+            for (size_t i = 0; i < n; ++i) {
+                if (exhausted()) break;
+                if (i > 0) out_.put(", ");
+                print(args[i], P_LOWEST);
+            }
+            out_.put("\\right)");
+        }
+    };
+
+    // ------------------------------------------------------------------------
+    // Presentation MathML
+    // ------------------------------------------------------------------------
+
+    // Every node prints as exactly one MathML element so it can stand as a
+    // child of <mfrac>, <msup> or <msqrt> without extra grouping.
+    class MathMLPrinter : BoundedPrinter {
+    public:
+        MathMLPrinter(OutBuffer& out, giac::context* ctx)
+            : BoundedPrinter(out, ctx, "<mi>&#x2026;</mi>") {}
+
+        void print(const giac::gen& g, int ctx_prec) {
+            if (out_.full()) {
+                // Callers rely on one element per child (<mfrac>, <msup>),
+                // so slots past the marker get an empty row
+                if (elided()) out_.put("<mrow/>");
+                else elide();
+                return;
+            }
+            bool paren = print_precedence(g) < ctx_prec;
+            if (paren) out_.put("<mrow><mo>(</mo>");
+            print_bare(g);
+            if (paren) out_.put("<mo>)</mo></mrow>");
+        }
+
+    private:
+        static const char* comparison(const giac::unary_function_ptr& s) {
+            if (s == giac::at_equal || s == giac::at_same) return "<mo>=</mo>";
+            if (s == giac::at_different) return "<mo>&#x2260;</mo>";
+            if (s == giac::at_inferieur_strict) return "<mo>&lt;</mo>";
+            if (s == giac::at_inferieur_egal) return "<mo>&#x2264;</mo>";
+            if (s == giac::at_superieur_strict) return "<mo>&gt;</mo>";
+            return "<mo>&#x2265;</mo>";
+        }
+
+        void print_bare(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                case giac::_DOUBLE_:
+                case giac::_ZINT:
+                    print_number(g);
+                    return;
+                case giac::_FRAC:
+                    out_.put("<mfrac>");
+                    print(g._FRACptr->num, P_LOWEST);
+                    print(g._FRACptr->den, P_LOWEST);
+                    out_.put("</mfrac>");
+                    return;
+                case giac::_CPLX: {
+                    const giac::gen& re = *g._CPLXptr;
+                    const giac::gen& im = *(g._CPLXptr + 1);
+                    out_.put("<mrow>");
+                    if (!is_exact_zero(re)) {
+                        print(re, P_SUM);
+                        out_.put(is_negative_number(im) ? "<mo>-</mo>" : "<mo>+</mo>");
+                        print(is_negative_number(im) ? -im : im, P_PROD);
+                    } else {
+                        print(im, P_PROD);
+                    }
+                    out_.put("<mo>&#x2062;</mo><mi>i</mi></mrow>");
+                    return;
+                }
+                case giac::_IDNT: {
+                    const char* name = g._IDNTptr->id_name;
+                    const char* sym = greek_symbol(name, false);
+                    out_.put("<mi>");
+                    if (sym) out_.put(sym);
+                    else put_escaped(name, std::strlen(name));
+                    out_.put("</mi>");
+                    return;
+                }
+                case giac::_STRNG:
+                    out_.put("<ms>");
+                    put_escaped(g._STRNGptr->data(), g._STRNGptr->size());
+                    out_.put("</ms>");
+                    return;
+                case giac::_VECT:
+                    print_vect(g);
+                    return;
+                case giac::_SYMB:
+                    print_symbolic(g);
+                    return;
+                default: {
+                    std::string text;
+                    bool cut = print_limited(g, ctx_, out_.bounded() ? out_.room()
+                                                                     : std::string::npos, text);
+                    out_.put("<mtext>");
+                    put_escaped(text.data(), text.size());
+                    out_.put("</mtext>");
+                    if (cut) out_.mark_truncated();
+                    return;
+                }
+            }
+        }
+
+        void print_number(const giac::gen& g) {
+            bool neg = is_negative_number(g);
+            if (neg) out_.put("<mrow><mo>-</mo>");
+            out_.put("<mn>");
+            if (g.type == giac::_INT_) {
+                out_.put_int(neg ? -static_cast<long long>(g.val) : g.val);
+            } else if (g.type == giac::_ZINT) {
+                if (mpz_sizeinbase(*g._ZINTptr, 10) > out_.room()) {
+                    elide(kTokenEllipsis);
+                } else {
+                    // mpz_get_str writes the sign itself; skip it
+                    std::string& dst = scratch_digits();
+                    OutBuffer digits(dst);
+                    digits.put_mpz(*g._ZINTptr);
+                    out_.put(neg ? dst.c_str() + 1 : dst.c_str());
+                }
+            } else {
+                double v = std::fabs(g._DOUBLE_val);
+                if (std::isnan(v)) out_.put("NaN");
+                else if (std::isinf(v)) out_.put("&#x221E;");
+                else out_.put_double(v);
+            }
+            out_.put("</mn>");
+            if (neg) out_.put("</mrow>");
+        }
+
+        static std::string& scratch_digits() {
+            thread_local std::string buf;
+            buf.clear();
+            return buf;
+        }
+
+        // Token text (<mi>, <mn>, <mtext>, <ms>); a cut here leaves the
+        // ellipsis as text so the open token closes normally
+        static constexpr const char* kTokenEllipsis = "&#x2026;";
+
+        void put_escaped(const char* s, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                if (out_.full()) {
+                    elide(kTokenEllipsis);
+                    return;
+                }
+                switch (s[i]) {
+                    case '<': out_.put("&lt;"); break;
+                    case '>': out_.put("&gt;"); break;
+                    case '&': out_.put("&amp;"); break;
+                    case '"': out_.put("&quot;"); break;
+                    default: out_.put(s[i]); break;
+                }
+            }
+        }
+
+        void print_list(const giac::vecteur& v, const char* sep) {
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (exhausted()) break;
+                if (i > 0) out_.put(sep);
+                print(v[i], P_LOWEST);
+            }
+        }
+
+        void print_vect(const giac::gen& g) {
+            const giac::vecteur& v = *g._VECTptr;
+            if (!v.empty() && giac::ckmatrix(g)) {
+                out_.put("<mrow><mo>(</mo><mtable>");
+                for (size_t i = 0; i < v.size(); ++i) {
+                    if (exhausted()) break;
+                    out_.put("<mtr>");
+                    const giac::vecteur& row = *v[i]._VECTptr;
+                    for (size_t j = 0; j < row.size(); ++j) {
+                        if (exhausted()) break;
+                        out_.put("<mtd>");
+                        print(row[j], P_LOWEST);
+                        out_.put("</mtd>");
+                    }
+                    out_.put("</mtr>");
+                }
+                out_.put("</mtable><mo>)</mo></mrow>");
+                return;
+            }
+            const char* open = "<mo>[</mo>";
+            const char* close = "<mo>]</mo>";
+            if (g.subtype == giac::_SEQ__VECT) {
+                open = close = "";
+            } else if (g.subtype == giac::_SET__VECT) {
+                open = "<mo>{</mo>";
+                close = "<mo>}</mo>";
+            }
+            out_.put("<mrow>");
+            out_.put(open);
+            print_list(v, "<mo>,</mo>");
+            out_.put(close);
+            out_.put("</mrow>");
+        }
+
+        void print_factors(const giac::gen* args, size_t n, bool inverses) {
+            out_.put("<mrow>");
+            bool any = false;
+            for (size_t i = 0; i < n; ++i) {
+                if (is_inv(args[i]) != inverses) continue;
+                if (exhausted()) break;
+                if (any) out_.put("<mo>&#x22C5;</mo>");
+                print(inverses ? args[i]._SYMBptr->feuille : args[i], P_PROD);
+                any = true;
+            }
+            if (!any) out_.put("<mn>1</mn>");
+            out_.put("</mrow>");
+        }
+
+        void print_symbolic(const giac::gen& g) {
+            const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+            const giac::gen& f = g._SYMBptr->feuille;
+            size_t n = 0;
+            const giac::gen* args = symb_args(g, n);
+
+            if (s == giac::at_plus) {
+                out_.put("<mrow>");
+                for (size_t i = 0; i < n; ++i) {
+                    if (exhausted()) break;
+                    const giac::gen& a = args[i];
+                    if (i > 0 && a.type == giac::_SYMB && a._SYMBptr->sommet == giac::at_neg) {
+                        out_.put("<mo>-</mo>");
+                        print(a._SYMBptr->feuille, P_PROD);
+                    } else if (i > 0 && is_negative_number(a)) {
+                        out_.put("<mo>-</mo>");
+                        print(-a, P_PROD);
+                    } else {
+                        if (i > 0) out_.put("<mo>+</mo>");
+                        print(a, P_SUM);
+                    }
+                }
+                out_.put("</mrow>");
+                return;
+            }
+            if (s == giac::at_binary_minus && n == 2) {
+                out_.put("<mrow>");
+                print(args[0], P_SUM);
+                out_.put("<mo>-</mo>");
+                print(args[1], P_PROD);
+                out_.put("</mrow>");
+                return;
+            }
+            if (s == giac::at_prod) {
+                bool has_den = false;
+                for (size_t i = 0; i < n; ++i) has_den = has_den || is_inv(args[i]);
+                if (!has_den) {
+                    print_factors(args, n, false);
+                    return;
+                }
+                out_.put("<mfrac>");
+                print_factors(args, n, false);
+                print_factors(args, n, true);
+                out_.put("</mfrac>");
+                return;
+            }
+            if (s == giac::at_inv || (s == giac::at_division && n == 2)) {
+                out_.put("<mfrac>");
+                if (s == giac::at_inv) out_.put("<mn>1</mn>");
+                else print(args[0], P_LOWEST);
+                print(s == giac::at_inv ? f : args[1], P_LOWEST);
+                out_.put("</mfrac>");
+                return;
+            }
+            if (s == giac::at_neg || s == giac::at_not) {
+                out_.put(s == giac::at_neg ? "<mrow><mo>-</mo>" : "<mrow><mo>&#xAC;</mo>");
+                print(f, P_POW);
+                out_.put("</mrow>");
+                return;
+            }
+            if (s == giac::at_pow && n == 2) {
+                if (is_one_half(args[1])) {
+                    out_.put("<msqrt>");
+                    print(args[0], P_LOWEST);
+                    out_.put("</msqrt>");
+                    return;
+                }
+                out_.put("<msup>");
+                print(args[0], P_ATOM);
+                print(args[1], P_LOWEST);
+                out_.put("</msup>");
+                return;
+            }
+            if ((s == giac::at_and || s == giac::at_ou) && n >= 2) {
+                int p = s == giac::at_and ? P_AND : P_OR;
+                out_.put("<mrow>");
+                for (size_t i = 0; i < n; ++i) {
+                    if (exhausted()) break;
+                    if (i > 0) out_.put(s == giac::at_and ? "<mo>&#x2227;</mo>" : "<mo>&#x2228;</mo>");
+                    print(args[i], p + 1);
+                }
+                out_.put("</mrow>");
+                return;
+            }
+            if (is_comparison(s) && n == 2) {
+                out_.put("<mrow>");
+                print(args[0], P_SUM);
+                out_.put(comparison(s));
+                print(args[1], P_SUM);
+                out_.put("</mrow>");
+                return;
+            }
+            if (s == giac::at_sqrt) {
+                out_.put("<msqrt>");
+                print(f, P_LOWEST);
+                out_.put("</msqrt>");
+                return;
+            }
+            if (s == giac::at_exp) {
+                out_.put("<msup><mi>e</mi>");
+                print(f, P_LOWEST);
+                out_.put("</msup>");
+                return;
+            }
+            if (s == giac::at_abs) {
+                out_.put("<mrow><mo>|</mo>");
+                print(f, P_LOWEST);
+                out_.put("<mo>|</mo></mrow>");
+                return;
+            }
+            if (s == giac::at_factorial) {
+                out_.put("<mrow>");
+                print(f, P_ATOM);
+                out_.put("<mo>!</mo></mrow>");
+                return;
+            }
+
+            // Function call: name, apply-function operator, fenced arguments
+            const char* name = s.ptr()->print(ctx_);
+            out_.put("<mrow><mi>");
+            put_escaped(name, std::strlen(name));
+            out_.put("</mi><mo>&#x2061;</mo><mrow><mo>(</mo>");
+            for (size_t i = 0; i < n; ++i) {
+                if (exhausted()) break;
+                if (i > 0) out_.put("<mo>,</mo>");
+                print(args[i], P_LOWEST);
+            }
+            out_.put("<mo>)</mo></mrow></mrow>");
+        }
+    };
+
+    size_t print_budget(int64_t max_bytes) {
+        return max_bytes > 0 ? static_cast<size_t>(max_bytes) : std::string::npos;
+    }
+}
+
+std::string to_latex(const Gen& g, int64_t max_bytes) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    std::string& buf = printer_scratch();
+    OutBuffer out(buf, print_budget(max_bytes));
+    LatexPrinter(out, &ctx).print(g.impl_->g, P_LOWEST);
+    return buf;
+}
+
+std::string to_mathml(const Gen& g, int64_t max_bytes) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    std::string& buf = printer_scratch();
+    buf.append("<math xmlns=\"http://www.w3.org/1998/Math/MathML\">");
+    // The budget covers the whole document, including the <math> wrapper
+    size_t budget = print_budget(max_bytes);
+    const size_t closing = std::strlen("</math>");
+    if (budget != std::string::npos) budget = budget > closing ? budget - closing : 0;
+    OutBuffer out(buf, budget);
+    MathMLPrinter(out, &ctx).print(g.impl_->g, P_LOWEST);
+    buf.append("</math>");
+    return buf;
+}
+
+namespace {
+    // ------------------------------------------------------------------------
+    // Budgeted giac syntax
+    // ------------------------------------------------------------------------
+
+    // Prints in giac's own syntax under a char / depth / element budget.
+    // Subtrees that fit entirely are handed to giac's printer so untruncated
+    // output matches Gen::to_string(); only the oversized parts are walked
+    // here, which keeps the cost proportional to the budget. Types this
+    // printer cannot size or walk (polynomials, user objects, ...) never
+    // fit and are cut as a whole under a char budget.
+    class LimitedPrinter : BoundedPrinter {
+    public:
+        LimitedPrinter(OutBuffer& out, giac::context* ctx, size_t max_depth, size_t max_elems)
+            : BoundedPrinter(out, ctx, "..."), max_depth_(max_depth), max_elems_(max_elems) {}
+
+        void print(const giac::gen& g, size_t depth, int ctx_prec) {
+            if (exhausted()) return;
+            bool container = g.type == giac::_VECT || g.type == giac::_SYMB ||
+                             g.type == giac::_MAP;
+            if (container && depth >= max_depth_) {
+                cut();
+                return;
+            }
+            // giac prints fractions as a bare "a/b"
+            int prec = g.type == giac::_FRAC ? P_PROD : print_precedence(g);
+            bool paren = prec < ctx_prec;
+            if (paren) out_.put('(');
+            if (fits(g, depth)) {
+                put_clipped(g.print(ctx_));
+                if (paren) out_.put(')');
+                return;
+            }
+            switch (g.type) {
+                case giac::_VECT:
+                    print_vect(g, depth);
+                    break;
+                case giac::_SYMB:
+                    print_symbolic(g, depth);
+                    break;
+                case giac::_MAP:
+                    print_map(*g._MAPptr, depth);
+                    break;
+                case giac::_ZINT:
+                    // Leading digits only; giac would print them all
+                    print_zint_prefix(*g._ZINTptr);
+                    break;
+                case giac::_FRAC:
+                    print(g._FRACptr->num, depth, P_UNARY);
+                    if (exhausted()) break;
+                    out_.put('/');
+                    print(g._FRACptr->den, depth, P_ATOM);
+                    break;
+                case giac::_CPLX:
+                    print(g._CPLXptr[0], depth, P_SUM);
+                    if (exhausted()) break;
+                    out_.put('+');
+                    print(g._CPLXptr[1], depth, P_PROD);
+                    if (exhausted()) break;
+                    out_.put("*i");
+                    break;
+                case giac::_MOD:
+                    print(g._MODptr[0], depth, P_ATOM);
+                    if (exhausted()) break;
+                    out_.put(" % ");
+                    print(g._MODptr[1], depth, P_ATOM);
+                    break;
+                case giac::_STRNG:
+                    print_string_prefix(*g._STRNGptr);
+                    break;
+                case giac::_IDNT:
+                case giac::_INT_:
+                case giac::_DOUBLE_:
+                case giac::_REAL:
+                case giac::_FLOAT_:
+                case giac::_FUNC:
+                    // Short tokens; only the tail can be over budget
+                    put_clipped(g.print(ctx_));
+                    break;
+                default:
+                    // Unknown size: printing it could cost anything
+                    if (out_.bounded()) {
+                        cut();
+                    } else {
+                        out_.put(g.print(ctx_));
+                    }
+                    break;
+            }
+            if (paren) out_.put(')');
+        }
+
+    private:
+        size_t max_depth_;
+        size_t max_elems_;
+
+        // Depth or element cut; unlike the char budget it can occur many times
+        void cut() {
+            out_.put("...");
+            out_.mark_truncated();
+        }
+
+        static bool token_char(char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+        }
+
+        // Cut at the last token boundary within the budget, so a name or
+        // number is never split
+        void put_clipped(const std::string& text) {
+            size_t room = out_.room();
+            if (text.size() <= room) {
+                out_.put(text);
+                return;
+            }
+            size_t cut = room;
+            while (cut > 0 && token_char(text[cut - 1]) && token_char(text[cut])) --cut;
+            out_.put(text.data(), cut);
+            elide();
+        }
+
+        void print_zint_prefix(const mpz_t z) {
+            // Leading digits come from a quotient with at most room+1 digits
+            mpz_t q;
+            mpz_init(q);
+            size_t digits = mpz_sizeinbase(z, 10);
+            size_t keep = std::min(out_.room(), digits);
+            mpz_tdiv_q_ui_pow(q, z, digits - keep);
+            out_.put_mpz(q);
+            mpz_clear(q);
+            elide();
+        }
+
+        void print_string_prefix(const std::string& text) {
+            out_.put('"');
+            size_t keep = std::min(out_.room(), text.size());
+            out_.put(text.data(), keep);
+            if (keep < text.size()) {
+                elide();
+                return;
+            }
+            out_.put('"');
+        }
+
+        static void mpz_tdiv_q_ui_pow(mpz_t q, const mpz_t z, size_t exp10) {
+            mpz_t p;
+            mpz_init(p);
+            mpz_ui_pow_ui(p, 10, exp10);
+            mpz_tdiv_q(q, z, p);
+            mpz_clear(p);
+        }
+
+        // Whether g prints within the remaining budget without any cut.
+        // Each node prints at least one character, so the walk visits at
+        // most room() nodes before giving up.
+        bool fits(const giac::gen& g, size_t depth) const {
+            size_t budget = out_.room();
+            if (budget == 0) return false;
+            size_t chars = 0;
+            bool ok = true;
+            struct Item { const giac::gen* g; size_t depth; };
+            std::vector<Item> stack{{&g, depth}};
+            while (ok && !stack.empty()) {
+                Item it = stack.back();
+                stack.pop_back();
+                const giac::gen& n = *it.g;
+                switch (n.type) {
+                    case giac::_VECT: {
+                        const giac::vecteur& v = *n._VECTptr;
+                        if (it.depth >= max_depth_ || v.size() > max_elems_ ||
+                            v.size() > budget - chars) {
+                            ok = false;
+                            break;
+                        }
+                        chars += 2;
+                        for (const giac::gen& e : v) stack.push_back({&e, it.depth + 1});
+                        break;
+                    }
+                    case giac::_SYMB: {
+                        // Arguments sit one level below the operator, as in print()
+                        const giac::gen& f = n._SYMBptr->feuille;
+                        if (it.depth >= max_depth_) { ok = false; break; }
+                        size_t args = 1;
+                        if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+                            if (f._VECTptr->size() > max_elems_) { ok = false; break; }
+                            args = f._VECTptr->size();
+                            for (const giac::gen& e : *f._VECTptr) stack.push_back({&e, it.depth + 1});
+                        } else {
+                            stack.push_back({&f, it.depth + 1});
+                        }
+                        // The operator text with its spaces or parentheses,
+                        // once per infix occurrence ("a and b and c")
+                        size_t op = std::strlen(n._SYMBptr->sommet.ptr()->print(ctx_)) + 2;
+                        chars += op * (args > 1 ? args - 1 : 1);
+                        break;
+                    }
+                    case giac::_IDNT:
+                        chars += std::strlen(n._IDNTptr->id_name);
+                        break;
+                    case giac::_INT_:
+                        chars += 11;
+                        break;
+                    case giac::_DOUBLE_:
+                        chars += 24;
+                        break;
+                    case giac::_ZINT:
+                        chars += mpz_sizeinbase(*n._ZINTptr, 10);
+                        break;
+                    case giac::_STRNG:
+                        chars += n._STRNGptr->size() + 2;
+                        break;
+                    case giac::_FRAC:
+                        stack.push_back({&n._FRACptr->num, it.depth});
+                        stack.push_back({&n._FRACptr->den, it.depth});
+                        chars += 1;
+                        break;
+                    case giac::_CPLX:
+                        stack.push_back({n._CPLXptr, it.depth});
+                        stack.push_back({n._CPLXptr + 1, it.depth});
+                        chars += 2;
+                        break;
+                    case giac::_MOD:
+                        stack.push_back({n._MODptr, it.depth});
+                        stack.push_back({n._MODptr + 1, it.depth});
+                        chars += 3;
+                        break;
+                    case giac::_MAP: {
+                        // "table(" plus "key=value" and a separator per entry
+                        const giac::gen_map& m = *n._MAPptr;
+                        if (it.depth >= max_depth_ || m.size() > max_elems_ ||
+                            m.size() > budget - chars) {
+                            ok = false;
+                            break;
+                        }
+                        chars += 8 + 4 * m.size();
+                        for (const auto& kv : m) {
+                            stack.push_back({&kv.first, it.depth + 1});
+                            stack.push_back({&kv.second, it.depth + 1});
+                        }
+                        break;
+                    }
+                    case giac::_FUNC:
+                        chars += std::strlen(n._FUNCptr->ptr()->print(ctx_));
+                        break;
+                    case giac::_FLOAT_:
+                        chars += 24;
+                        break;
+                    default:
+                        // Size unknown without printing it, so never "fits"
+                        ok = false;
+                        break;
+                }
+                if (chars > budget) ok = false;
+            }
+            return ok;
+        }
+
+        void print_list(const giac::vecteur& v, size_t depth) {
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (exhausted()) return;
+                if (i > 0) out_.put(',');
+                if (i >= max_elems_) {
+                    cut();
+                    return;
+                }
+                print(v[i], depth + 1, P_LOWEST);
+            }
+        }
+
+        void print_map(const giac::gen_map& m, size_t depth) {
+            out_.put("table(");
+            size_t i = 0;
+            for (const auto& kv : m) {
+                if (exhausted()) return;
+                if (i > 0) out_.put(',');
+                if (i++ >= max_elems_) {
+                    cut();
+                    break;
+                }
+                print(kv.first, depth + 1, P_ATOM);
+                if (exhausted()) return;
+                out_.put('=');
+                print(kv.second, depth + 1, P_SUM);
+            }
+            out_.put(')');
+        }
+
+        void print_vect(const giac::gen& g, size_t depth) {
+            const char* open = "[";
+            const char* close = "]";
+            if (g.subtype == giac::_SEQ__VECT) {
+                open = "(";
+                close = ")";
+            } else if (g.subtype == giac::_SET__VECT) {
+                open = "set[";
+            }
+            out_.put(open);
+            print_list(*g._VECTptr, depth);
+            out_.put(close);
+        }
+
+        static const char* infix(const giac::unary_function_ptr& s) {
+            if (s == giac::at_equal) return "=";
+            if (s == giac::at_same) return "==";
+            if (s == giac::at_different) return "!=";
+            if (s == giac::at_inferieur_strict) return "<";
+            if (s == giac::at_inferieur_egal) return "<=";
+            if (s == giac::at_superieur_strict) return ">";
+            if (s == giac::at_superieur_egal) return ">=";
+            if (s == giac::at_and) return " and ";
+            if (s == giac::at_ou) return " or ";
+            if (s == giac::at_binary_minus) return "-";
+            if (s == giac::at_division) return "/";
+            return nullptr;
+        }
+
+        void print_symbolic(const giac::gen& g, size_t depth) {
+            const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+            const giac::gen& f = g._SYMBptr->feuille;
+            size_t n = 0;
+            const giac::gen* args = symb_args(g, n);
+            size_t d = depth + 1;
+            int prec = print_precedence(g);
+
+            if (s == giac::at_plus || s == giac::at_prod) {
+                bool sum = s == giac::at_plus;
+                for (size_t i = 0; i < n; ++i) {
+                    if (exhausted()) return;
+                    if (i >= max_elems_) {
+                        out_.put(sum ? "+" : "*");
+                        cut();
+                        return;
+                    }
+                    const giac::gen& a = args[i];
+                    if (sum && i > 0 && a.type == giac::_SYMB && a._SYMBptr->sommet == giac::at_neg) {
+                        out_.put('-');
+                        print(a._SYMBptr->feuille, d + 1, P_PROD);
+                    } else if (!sum && i > 0 && is_inv(a)) {
+                        out_.put('/');
+                        print(a._SYMBptr->feuille, d + 1, P_UNARY);
+                    } else {
+                        if (i > 0) out_.put(sum ? '+' : '*');
+                        print(a, d, prec);
+                    }
+                }
+                return;
+            }
+            if (s == giac::at_neg) {
+                out_.put('-');
+                print(f, d, P_POW);
+                return;
+            }
+            if (s == giac::at_inv) {
+                out_.put("1/");
+                print(f, d, P_UNARY);
+                return;
+            }
+            if (s == giac::at_pow && n == 2) {
+                print(args[0], d, P_ATOM);
+                out_.put('^');
+                print(args[1], d, P_ATOM);
+                return;
+            }
+            if (const char* op = infix(s)) {
+                if (n == 2 || s == giac::at_and || s == giac::at_ou) {
+                    for (size_t i = 0; i < n; ++i) {
+                        if (exhausted()) return;
+                        if (i > 0) out_.put(op);
+                        print(args[i], d, prec + 1);
+                    }
+                    return;
+                }
+            }
+
+            out_.put(s.ptr()->print(ctx_));
+            out_.put('(');
+            print_list(f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT
+                           ? *f._VECTptr : giac::vecteur(1, f), depth);
+            out_.put(')');
+        }
+    };
+
+    bool print_limited(const giac::gen& g, giac::context* ctx, size_t max_chars,
+                       std::string& text) {
+        OutBuffer out(text, max_chars);
+        size_t unlimited = std::numeric_limits<size_t>::max();
+        LimitedPrinter(out, ctx, unlimited, unlimited).print(g, 0, P_LOWEST);
+        return out.truncated();
+    }
+
+    size_t positive_or_unlimited(int64_t v) {
+        return v > 0 ? static_cast<size_t>(v) : std::numeric_limits<size_t>::max();
+    }
+}
+
+LimitedString Gen::to_string_limited(int64_t max_chars, int32_t max_depth,
+                                     int64_t max_elems) const {
+    giac::context& ctx = get_thread_local_context();
+    std::string& buf = printer_scratch();
+    OutBuffer out(buf, print_budget(max_chars));
+    LimitedPrinter(out, &ctx, positive_or_unlimited(max_depth),
+                   positive_or_unlimited(max_elems))
+        .print(impl_->g, 0, P_LOWEST);
+    return LimitedString{buf, out.truncated()};
+}
+
+// ============================================================================
+// Streaming Serialization
+// ============================================================================
+
+namespace {
+    // Output is flushed to the descriptor in chunks of this size
+    constexpr size_t kStreamChunk = 64 * 1024;
+
+    const char kBinaryMagic[8] = {'G', 'I', 'A', 'C', 'G', 'E', 'N', 1};
+
+    enum BinaryTag : uint8_t {
+        BIN_INT = 1, BIN_DOUBLE, BIN_ZINT, BIN_FRAC, BIN_CPLX,
+        BIN_IDNT, BIN_STRNG, BIN_VECT, BIN_SYMB, BIN_TEXT,
+    };
+
+    // Whether an operator's printed name resolves back to the same function
+    // (binary minus travels as "-"), cached per operator. Both writers only
+    // emit operators by name when the reader can rebuild them.
+    class OperatorNames {
+    public:
+        explicit OperatorNames(giac::context* ctx) : ctx_(ctx) {}
+
+        bool resolvable(const giac::unary_function_ptr& op, const char* name) {
+            auto it = cache_.find(op.ptr());
+            if (it != cache_.end()) return it->second;
+            bool ok = false;
+            try {
+                const giac::unary_function_ptr back = lookup_operator(name, *ctx_);
+                ok = back == op || (op == giac::at_binary_minus && back == giac::at_neg);
+            } catch (const std::exception&) {
+            }
+            return cache_.emplace(op.ptr(), ok).first->second;
+        }
+
+    private:
+        giac::context* ctx_;
+        std::unordered_map<const void*, bool> cache_;
+    };
+
+    // Preorder encoding with an explicit stack, so arbitrarily deep trees
+    // serialize without recursion. Integers are little-endian.
+    class BinaryWriter {
+    public:
+        BinaryWriter(OutBuffer& out, giac::context* ctx) : out_(out), ctx_(ctx), names_(ctx) {}
+
+        void write(const giac::gen& root) {
+            out_.put(kBinaryMagic, sizeof(kBinaryMagic));
+            std::vector<const giac::gen*> stack{&root};
+            while (!stack.empty()) {
+                const giac::gen& g = *stack.back();
+                stack.pop_back();
+                node(g, stack);
+            }
+        }
+
+    private:
+        OutBuffer& out_;
+        giac::context* ctx_;
+        OperatorNames names_;  // the reader rebuilds operators by name
+
+        void tag(BinaryTag t) { out_.put(static_cast<char>(t)); }
+
+        void bytes(const char* s, size_t n) {
+            out_.put_u64(n);
+            out_.put(s, n);
+        }
+
+        void node(const giac::gen& g, std::vector<const giac::gen*>& stack) {
+            switch (g.type) {
+                case giac::_INT_:
+                    tag(BIN_INT);
+                    out_.put(static_cast<char>(g.subtype));
+                    out_.put_u64(static_cast<uint64_t>(static_cast<int64_t>(g.val)));
+                    return;
+                case giac::_DOUBLE_: {
+                    uint64_t bits;
+                    std::memcpy(&bits, &g._DOUBLE_val, sizeof(bits));
+                    tag(BIN_DOUBLE);
+                    out_.put_u64(bits);
+                    return;
+                }
+                case giac::_ZINT:
+                    tag(BIN_ZINT);
+                    out_.put(static_cast<char>(mpz_sgn(*g._ZINTptr) < 0 ? 1 : 0));
+                    out_.put_mpz_magnitude(*g._ZINTptr);
+                    return;
+                case giac::_FRAC:
+                    tag(BIN_FRAC);
+                    stack.push_back(&g._FRACptr->den);
+                    stack.push_back(&g._FRACptr->num);
+                    return;
+                case giac::_CPLX:
+                    tag(BIN_CPLX);
+                    stack.push_back(g._CPLXptr + 1);
+                    stack.push_back(g._CPLXptr);
+                    return;
+                case giac::_IDNT: {
+                    const char* name = g._IDNTptr->id_name;
+                    tag(BIN_IDNT);
+                    bytes(name, std::strlen(name));
+                    return;
+                }
+                case giac::_STRNG:
+                    tag(BIN_STRNG);
+                    bytes(g._STRNGptr->data(), g._STRNGptr->size());
+                    return;
+                case giac::_VECT: {
+                    const giac::vecteur& v = *g._VECTptr;
+                    tag(BIN_VECT);
+                    out_.put(static_cast<char>(g.subtype));
+                    out_.put_u64(v.size());
+                    for (size_t i = v.size(); i-- > 0;) stack.push_back(&v[i]);
+                    return;
+                }
+                case giac::_SYMB: {
+                    const giac::unary_function_ptr& op = g._SYMBptr->sommet;
+                    const char* name = op.ptr()->print(ctx_);
+                    if (!names_.resolvable(op, name)) {
+                        throw std::runtime_error(std::string("write_gen: operator '") + name +
+                                                 "' cannot be read back by name");
+                    }
+                    tag(BIN_SYMB);
+                    bytes(name, std::strlen(name));
+                    stack.push_back(&g._SYMBptr->feuille);
+                    return;
+                }
+                default: {
+                    // Rare types (maps, polynomials, multiprecision floats)
+                    // travel as giac source text
+                    const std::string text = g.print(ctx_);
+                    tag(BIN_TEXT);
+                    bytes(text.data(), text.size());
+                    return;
+                }
+            }
+        }
+    };
+
+    // Fixed-size read buffer over a file descriptor
+    class InBuffer {
+    public:
+        explicit InBuffer(int fd) : fd_(fd), buf_(kStreamChunk) {}
+
+        void get(void* dst, size_t n) {
+            char* out = static_cast<char*>(dst);
+            while (n > 0) {
+                if (pos_ == end_ && !refill()) {
+                    throw std::runtime_error("read_gen: unexpected end of input");
+                }
+                size_t k = std::min(n, end_ - pos_);
+                std::memcpy(out, buf_.data() + pos_, k);
+                pos_ += k;
+                out += k;
+                n -= k;
+            }
+        }
+
+        uint8_t get_u8() {
+            uint8_t v;
+            get(&v, 1);
+            return v;
+        }
+
+        uint64_t get_u64() {
+            unsigned char b[8];
+            get(b, 8);
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; --i) v = (v << 8) | b[i];
+            return v;
+        }
+
+        std::string get_bytes() {
+            std::string s(static_cast<size_t>(get_u64()), '\0');
+            get(&s[0], s.size());
+            return s;
+        }
+
+        // Remaining input, for the text format
+        void drain(std::string& dst) {
+            dst.append(buf_.data() + pos_, end_ - pos_);
+            pos_ = end_;
+            while (refill()) {
+                dst.append(buf_.data(), end_);
+                pos_ = end_;
+            }
+        }
+
+    private:
+        int fd_;
+        std::vector<char> buf_;
+        size_t pos_ = 0;
+        size_t end_ = 0;
+
+        bool refill() {
+            for (;;) {
+                auto n = ::read(fd_, buf_.data(), static_cast<unsigned>(buf_.size()));
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("read_gen: read failed: ") +
+                                             std::strerror(errno));
+                }
+                pos_ = 0;
+                end_ = static_cast<size_t>(n);
+                return n > 0;
+            }
+        }
+    };
+
+    // Mirror of BinaryWriter: composite nodes become frames on an explicit
+    // stack that collect their children, so input depth is bounded by
+    // memory rather than by the call stack.
+    class BinaryReader {
+    public:
+        BinaryReader(InBuffer& in, giac::context& ctx) : in_(in), ctx_(ctx) {}
+
+        giac::gen read() {
+            char magic[sizeof(kBinaryMagic)];
+            in_.get(magic, sizeof(magic));
+            if (std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0) {
+                throw std::runtime_error("read_gen: not a binary gen stream");
+            }
+            std::vector<Frame> stack;
+            for (;;) {
+                giac::gen value;
+                if (!node(value, stack)) continue;
+                // Hand the finished node up until a frame still needs children
+                for (;;) {
+                    if (stack.empty()) return value;
+                    Frame& f = stack.back();
+                    f.items.push_back(std::move(value));
+                    if (f.items.size() < f.count) break;
+                    value = finish(f);
+                    stack.pop_back();
+                }
+            }
+        }
+
+    private:
+        struct Frame {
+            uint8_t tag;
+            short subtype;
+            uint64_t count;
+            const giac::unary_function_ptr* op;
+            giac::vecteur items;
+        };
+
+        InBuffer& in_;
+        giac::context& ctx_;
+        std::unordered_map<std::string, giac::unary_function_ptr> ops_;
+
+        // Reads one tag. Leaves are stored in out and return true; composite
+        // nodes push a frame and return false, unless they have no children.
+        bool node(giac::gen& out, std::vector<Frame>& stack) {
+            uint8_t t = in_.get_u8();
+            switch (t) {
+                case BIN_INT: {
+                    signed char sub = static_cast<signed char>(in_.get_u8());
+                    out = giac::gen(static_cast<int>(static_cast<int64_t>(in_.get_u64())));
+                    out.subtype = sub;
+                    return true;
+                }
+                case BIN_DOUBLE: {
+                    uint64_t bits = in_.get_u64();
+                    double v;
+                    std::memcpy(&v, &bits, sizeof(v));
+                    out = giac::gen(v);
+                    return true;
+                }
+                case BIN_ZINT: {
+                    bool neg = in_.get_u8() != 0;
+                    std::string mag = in_.get_bytes();
+                    mpz_t z;
+                    mpz_init(z);
+                    mpz_import(z, mag.size(), -1, 1, -1, 0, mag.data());
+                    if (neg) mpz_neg(z, z);
+                    out = giac::gen(z);
+                    mpz_clear(z);
+                    return true;
+                }
+                case BIN_FRAC:
+                case BIN_CPLX:
+                    stack.push_back(Frame{t, 0, 2, nullptr, {}});
+                    stack.back().items.reserve(2);
+                    return false;
+                case BIN_IDNT:
+                    out = giac::identificateur(in_.get_bytes());
+                    return true;
+                case BIN_STRNG:
+                    out = giac::string2gen(in_.get_bytes(), false);
+                    return true;
+                case BIN_VECT: {
+                    short sub = static_cast<signed char>(in_.get_u8());
+                    uint64_t n = in_.get_u64();
+                    if (n == 0) {
+                        out = giac::gen(giac::vecteur(), sub);
+                        return true;
+                    }
+                    stack.push_back(Frame{t, sub, n, nullptr, {}});
+                    stack.back().items.reserve(
+                        static_cast<size_t>(std::min<uint64_t>(n, kStreamChunk)));
+                    return false;
+                }
+                case BIN_SYMB: {
+                    const giac::unary_function_ptr* op = &resolve(in_.get_bytes());
+                    stack.push_back(Frame{t, 0, 1, op, {}});
+                    return false;
+                }
+                case BIN_TEXT:
+                    out = giac::gen(in_.get_bytes(), &ctx_);
+                    return true;
+                default:
+                    throw std::runtime_error("read_gen: corrupt binary gen stream");
+            }
+        }
+
+        giac::gen finish(Frame& f) {
+            switch (f.tag) {
+                case BIN_FRAC:
+                    return giac::fraction(f.items[0], f.items[1]);
+                case BIN_CPLX:
+                    return giac::gen(f.items[0], f.items[1]);
+                case BIN_VECT:
+                    return giac::gen(std::move(f.items), f.subtype);
+                default: {
+                    const giac::gen& feuille = f.items[0];
+                    if (*f.op == giac::at_neg && feuille.type == giac::_VECT &&
+                        feuille.subtype == giac::_SEQ__VECT && feuille._VECTptr->size() == 2) {
+                        return giac::symbolic(giac::at_binary_minus, feuille);
+                    }
+                    return giac::symbolic(*f.op, feuille);
+                }
+            }
+        }
+
+        // Node-based map, so the returned reference stays valid while
+        // frames hold it
+        const giac::unary_function_ptr& resolve(const std::string& name) {
+            auto it = ops_.find(name);
+            if (it == ops_.end()) {
+                it = ops_.emplace(name, lookup_operator(name, ctx_)).first;
+            }
+            return it->second;
+        }
+    };
+
+    // giac source that the parser alone turns back into the same tree.
+    // Where parsing would build something else, the text is marked:
+    // negative, fractional and complex numbers become eval(...) literals
+    // the reader folds, and nodes the parser would merge into their parent
+    // (a sum inside a sum) or that carry a reader marker name are wrapped
+    // in quote(...), which the reader strips. Recursive, like giac's parser.
+    class TextWriter {
+    public:
+        TextWriter(OutBuffer& out, giac::context* ctx) : out_(out), ctx_(ctx), names_(ctx) {}
+
+        void write(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                    if (g.subtype != 0) {
+                        out_.put(g.print(ctx_));  // true / false
+                        return;
+                    }
+                    number(g);
+                    return;
+                case giac::_DOUBLE_:
+                case giac::_ZINT:
+                case giac::_FRAC:
+                case giac::_CPLX:
+                    number(g);
+                    return;
+                case giac::_IDNT:
+                    out_.put(g._IDNTptr->id_name);
+                    return;
+                case giac::_STRNG:
+                    string(*g._STRNGptr);
+                    return;
+                case giac::_VECT:
+                    vect(g);
+                    return;
+                case giac::_MAP:
+                    table(*g._MAPptr);
+                    return;
+                case giac::_SYMB:
+                    symbolic(g);
+                    return;
+                default:
+                    // Rare types (polynomials, multiprecision floats) print
+                    // as giac source already
+                    out_.put(g.print(ctx_));
+                    return;
+            }
+        }
+
+    private:
+        OutBuffer& out_;
+        giac::context* ctx_;
+        OperatorNames names_;
+
+        void number(const giac::gen& g) {
+            bool composite = is_negative_number(g) || g.type == giac::_FRAC ||
+                             g.type == giac::_CPLX;
+            if (composite) out_.put("eval(");
+            literal(g);
+            if (composite) out_.put(')');
+        }
+
+        // Plain arithmetic; only valid inside an eval(...) literal
+        void literal(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                    out_.put_int(g.val);
+                    return;
+                case giac::_DOUBLE_:
+                    double_literal(g._DOUBLE_val);
+                    return;
+                case giac::_ZINT:
+                    out_.put_mpz(*g._ZINTptr);
+                    return;
+                case giac::_FRAC:
+                    literal(g._FRACptr->num);
+                    out_.put('/');
+                    literal(g._FRACptr->den);
+                    return;
+                case giac::_CPLX:
+                    literal(g._CPLXptr[0]);
+                    out_.put("+(");
+                    literal(g._CPLXptr[1]);
+                    out_.put(")*i");
+                    return;
+                default:
+                    out_.put(g.print(ctx_));
+                    return;
+            }
+        }
+
+        void double_literal(double v) {
+            if (!std::isfinite(v)) {
+                throw std::runtime_error("write_gen: non-finite double has no text form; "
+                                         "use GEN_FORMAT_BINARY");
+            }
+            char buf[32];
+            size_t n = OutBuffer::format_double(v, buf, sizeof(buf));
+            out_.put(buf, n);
+            // A bare integer would read back as an exact number
+            if (!std::strpbrk(buf, ".e")) out_.put(".0");
+        }
+
+        void string(const std::string& text) {
+            out_.put('"');
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out_.put('\\');
+                    out_.put(c);
+                } else if (c == '\n') {
+                    out_.put("\\n");
+                } else {
+                    out_.put(c);
+                }
+            }
+            out_.put('"');
+        }
+
+        void vect(const giac::gen& g) {
+            const char* open;
+            switch (g.subtype) {
+                case 0: open = "["; break;
+                case giac::_SEQ__VECT: open = "seq["; break;
+                case giac::_SET__VECT: open = "set["; break;
+                case giac::_POLY1__VECT: open = "poly1["; break;
+                case giac::_MATRIX__VECT: open = "matrix["; break;
+                default:
+                    throw std::runtime_error("write_gen: vector subtype " +
+                                             std::to_string(g.subtype) +
+                                             " has no text form; use GEN_FORMAT_BINARY");
+            }
+            out_.put(open);
+            list(*g._VECTptr);
+            out_.put(']');
+        }
+
+        void list(const giac::vecteur& v) {
+            for (size_t i = 0; i < v.size(); ++i) {
+                if (i > 0) out_.put(',');
+                write(v[i]);
+            }
+        }
+
+        void table(const giac::gen_map& m) {
+            out_.put("table(");
+            bool first = true;
+            for (const auto& kv : m) {
+                if (!first) out_.put(',');
+                first = false;
+                out_.put('(');
+                write(kv.first);
+                out_.put(")=(");
+                write(kv.second);
+                out_.put(')');
+            }
+            out_.put(')');
+        }
+
+        static const char* binary_infix(const giac::unary_function_ptr& s) {
+            if (s == giac::at_equal) return "=";
+            if (s == giac::at_same) return "==";
+            if (s == giac::at_different) return "!=";
+            if (s == giac::at_inferieur_strict) return "<";
+            if (s == giac::at_inferieur_egal) return "<=";
+            if (s == giac::at_superieur_strict) return ">";
+            if (s == giac::at_superieur_egal) return ">=";
+            if (s == giac::at_binary_minus) return "-";
+            if (s == giac::at_division) return "/";
+            if (s == giac::at_pow) return "^";
+            if (s == giac::at_interval) return "..";
+            return nullptr;
+        }
+
+        static const char* nary_infix(const giac::unary_function_ptr& s) {
+            if (s == giac::at_plus) return "+";
+            if (s == giac::at_prod) return "*";
+            if (s == giac::at_and) return " and ";
+            if (s == giac::at_ou) return " or ";
+            return nullptr;
+        }
+
+        static bool identifier(const char* name) {
+            if (!std::isalpha(static_cast<unsigned char>(name[0])) && name[0] != '_') return false;
+            for (const char* p = name; *p; ++p) {
+                if (!std::isalnum(static_cast<unsigned char>(*p)) && *p != '_') return false;
+            }
+            return true;
+        }
+
+        // Parenthesized operand; the parser would flatten a same-operator
+        // child of an n-ary node, so that child is quoted
+        void operand(const giac::gen& a, const giac::unary_function_ptr* merges) {
+            bool quote = merges && a.type == giac::_SYMB && a._SYMBptr->sommet == *merges;
+            out_.put(quote ? "(quote(" : "(");
+            write(a);
+            out_.put(quote ? "))" : ")");
+        }
+
+        void call(const char* name, const giac::gen& f) {
+            out_.put(name);
+            out_.put('(');
+            if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+                list(*f._VECTptr);
+            } else {
+                write(f);
+            }
+            out_.put(')');
+        }
+
+        void symbolic(const giac::gen& g) {
+            const giac::unary_function_ptr& op = g._SYMBptr->sommet;
+            const giac::gen& f = g._SYMBptr->feuille;
+            const char* name = op.ptr()->print(ctx_);
+            size_t n = 0;
+            const giac::gen* args = symb_args(g, n);
+
+            if (op == giac::at_quote || op == giac::at_eval || op == giac::at_table) {
+                // The reader gives these names a meaning of their own
+                out_.put("quote(");
+                call(name, f);
+                out_.put(')');
+                return;
+            }
+            if (const char* sym = nary_infix(op)) {
+                if (n >= 2) {
+                    for (size_t i = 0; i < n; ++i) {
+                        if (i > 0) out_.put(sym);
+                        operand(args[i], &op);
+                    }
+                    return;
+                }
+            }
+            if (op == giac::at_neg) {
+                out_.put("-(");
+                write(f);
+                out_.put(')');
+                return;
+            }
+            if (op == giac::at_sto && n == 2) {
+                // sto(value, target) reads back from "target:=value"
+                if (args[1].type == giac::_IDNT) {
+                    write(args[1]);
+                } else {
+                    operand(args[1], nullptr);
+                }
+                out_.put(":=");
+                operand(args[0], nullptr);
+                return;
+            }
+            if (const char* sym = binary_infix(op)) {
+                if (n == 2) {
+                    operand(args[0], nullptr);
+                    out_.put(sym);
+                    operand(args[1], nullptr);
+                    return;
+                }
+            }
+            if (identifier(name) && names_.resolvable(op, name)) {
+                call(name, f);
+                return;
+            }
+            throw std::runtime_error(std::string("write_gen: operator '") + name +
+                                     "' has no text form; use GEN_FORMAT_BINARY");
+        }
+    };
+
+    // Parses TextWriter output without evaluating it, then undoes the
+    // writer's markers
+    class TextReader {
+    public:
+        explicit TextReader(giac::context& ctx) : ctx_(ctx) {}
+
+        giac::gen read(const std::string& text) {
+            giac::first_error_line(0, &ctx_);
+            giac::gen parsed(text, &ctx_);
+            if (giac::first_error_line(&ctx_) != 0) {
+                throw std::runtime_error(std::string("read_gen: syntax error near '") +
+                                         giac::error_token_name(&ctx_) + "'");
+            }
+            return decode(parsed);
+        }
+
+    private:
+        giac::context& ctx_;
+
+        giac::gen decode(const giac::gen& g) {
+            if (g.type == giac::_VECT) {
+                giac::vecteur v;
+                v.reserve(g._VECTptr->size());
+                for (const giac::gen& e : *g._VECTptr) v.push_back(decode(e));
+                return giac::gen(v, g.subtype);
+            }
+            if (g.type != giac::_SYMB) return g;
+            const giac::unary_function_ptr& op = g._SYMBptr->sommet;
+            const giac::gen& f = g._SYMBptr->feuille;
+            if (op == giac::at_quote) {
+                // The quoted node is kept as is; only its arguments decode
+                if (f.type != giac::_SYMB) return decode(f);
+                return giac::symbolic(f._SYMBptr->sommet, decode(f._SYMBptr->feuille));
+            }
+            if (op == giac::at_eval) {
+                // A number literal; anything else would run arbitrary code
+                if (!number_literal(f)) {
+                    throw std::runtime_error("read_gen: eval() in text input is not a number");
+                }
+                return giac::eval(f, &ctx_);
+            }
+            if (op == giac::at_table) return table(g);
+            return giac::symbolic(op, decode(f));
+        }
+
+        static bool number_literal(const giac::gen& g) {
+            switch (g.type) {
+                case giac::_INT_:
+                case giac::_DOUBLE_:
+                case giac::_ZINT:
+                case giac::_FRAC:
+                case giac::_CPLX:
+                case giac::_REAL:
+                    return true;
+                case giac::_IDNT:
+                    return std::strcmp(g._IDNTptr->id_name, "i") == 0;
+                case giac::_SYMB: {
+                    const giac::unary_function_ptr& s = g._SYMBptr->sommet;
+                    if (s != giac::at_plus && s != giac::at_prod && s != giac::at_neg &&
+                        s != giac::at_division && s != giac::at_binary_minus && s != giac::at_inv) {
+                        return false;
+                    }
+                    size_t n = 0;
+                    const giac::gen* args = symb_args(g, n);
+                    for (size_t i = 0; i < n; ++i) {
+                        if (!number_literal(args[i])) return false;
+                    }
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        giac::gen table(const giac::gen& g) {
+            giac::gen_map m;
+            size_t n = 0;
+            const giac::gen* entries = symb_args(g, n);
+            for (size_t i = 0; i < n; ++i) {
+                const giac::gen& e = entries[i];
+                size_t k = 0;
+                const giac::gen* kv = e.type == giac::_SYMB && e._SYMBptr->sommet == giac::at_equal
+                                          ? symb_args(e, k) : nullptr;
+                if (k != 2) throw std::runtime_error("read_gen: malformed table entry");
+                m[decode(kv[0])] = decode(kv[1]);
+            }
+            return giac::gen(m);
+        }
+    };
+}
+
+void write_gen(const Gen& g, int32_t fd, int32_t format) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    thread_local std::string chunk;
+    chunk.clear();
+    chunk.reserve(kStreamChunk);
+    OutBuffer out(chunk, fd, kStreamChunk);
+    if (format == GEN_FORMAT_BINARY) {
+        BinaryWriter(out, &ctx).write(g.impl_->g);
+    } else if (format == GEN_FORMAT_TEXT) {
+        TextWriter(out, &ctx).write(g.impl_->g);
+    } else {
+        throw std::runtime_error("write_gen: unknown format " + std::to_string(format));
+    }
+    out.flush();
+}
+
+Gen read_gen(int32_t fd, int32_t format) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    InBuffer in(fd);
+    if (format == GEN_FORMAT_BINARY) {
+        return Gen(std::make_unique<GenImpl>(BinaryReader(in, ctx).read()));
+    }
+    if (format == GEN_FORMAT_TEXT) {
+        std::string text;
+        in.drain(text);
+        return Gen(std::make_unique<GenImpl>(TextReader(ctx).read(text)));
+    }
+    throw std::runtime_error("read_gen: unknown format " + std::to_string(format));
+}
+
+// ============================================================================
+// ExpressionReader Implementation
+// ============================================================================
+
+namespace {
+    // Parse (and optionally evaluate) text without throwing. On failure the
+    // exception is kept unformatted in error, and a syntax error leaves the
+    // offending token in token, so callers decide when to build a message.
+    int32_t parse_and_eval(const std::string& text, bool evaluate, giac::context& ctx,
+                           giac::gen& out, std::exception_ptr& error, std::string& token) {
+        if (text.find_first_not_of(" \t\r") == std::string::npos) {
+            return GIAC_STATUS_EMPTY;
+        }
+        bool parsed_ok = false;
+        try {
+            giac::first_error_line(0, &ctx);
+            giac::gen parsed(text, &ctx);
+            if (giac::first_error_line(&ctx) != 0) {
+                token = giac::error_token_name(&ctx);
+                return GIAC_STATUS_PARSE_ERROR;
+            }
+            parsed_ok = true;
+            out = evaluate ? giac::eval(parsed, &ctx) : parsed;
+            return GIAC_STATUS_OK;
+        } catch (...) {
+            error = std::current_exception();
+        }
+        return parsed_ok ? GIAC_STATUS_EVAL_ERROR : GIAC_STATUS_PARSE_ERROR;
+    }
+
+    std::string status_message(int32_t status, const std::exception_ptr& error,
+                               const std::string& token) {
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                return e.what();
+            } catch (...) {
+                return "unknown error";
+            }
+        }
+        if (status == GIAC_STATUS_PARSE_ERROR) {
+            return "syntax error near '" + token + "'";
+        }
+        return std::string();
+    }
+
+    // Per-line variant for the batch reader: message built immediately
+    int32_t parse_line(const std::string& text, bool evaluate, giac::context& ctx,
+                       giac::gen& out, std::string& error) {
+        std::exception_ptr err;
+        std::string token;
+        int32_t status = parse_and_eval(text, evaluate, ctx, out, err, token);
+        if (status == GIAC_STATUS_PARSE_ERROR || status == GIAC_STATUS_EVAL_ERROR) {
+            error = status_message(status, err, token);
+        }
+        return status;
+    }
+
+    // Evaluate a parsed line in place; the value becomes 0 on failure
+    int32_t eval_line(giac::gen& g, giac::context& ctx, std::string& error) {
+        try {
+            g = giac::eval(g, &ctx);
+            return GIAC_STATUS_OK;
+        } catch (...) {
+            error = status_message(GIAC_STATUS_EVAL_ERROR, std::current_exception(), std::string());
+        }
+        g = giac::gen(0);
+        return GIAC_STATUS_EVAL_ERROR;
+    }
+}
+
+struct ExpressionReaderImpl {
+    std::FILE* file;
+    std::vector<char> buf;
+    size_t pos = 0;
+    size_t end = 0;
+    bool eof = false;
+    bool evaluate;
+    int32_t num_threads;
+    int64_t line_no = 0;
+    // Lines are evaluated in file order in this context, so `:=` bindings
+    // carry from one line to the next and stay out of every other context.
+    // Never freed, like GiacContextImpl::ctx.
+    giac::context* ctx = nullptr;
+    // Reused across batches to keep their capacity
+    std::vector<std::string> lines;
+    std::vector<giac::gen> gens;
+
+    ExpressionReaderImpl(std::FILE* f, bool eval, int32_t threads)
+        : file(f), buf(1 << 20), evaluate(eval), num_threads(threads) {
+        if (evaluate) ctx = new giac::context();
+    }
+
+    ~ExpressionReaderImpl() {
+        std::fclose(file);
+    }
+
+    // Make unread bytes available; false once input is exhausted
+    bool fill() {
+        if (pos < end) return true;
+        if (eof) return false;
+        end = std::fread(buf.data(), 1, buf.size(), file);
+        pos = 0;
+        if (end == 0 && std::ferror(file)) {
+            throw std::runtime_error(std::string("ExpressionReader: read failed: ") +
+                                     std::strerror(errno));
+        }
+        eof = end == 0;
+        return !eof;
+    }
+
+    // Next line without its terminator; false once input is exhausted
+    bool next_line(std::string& line) {
+        line.clear();
+        if (!fill()) return false;
+        while (fill()) {
+            const char* start = buf.data() + pos;
+            const char* nl = static_cast<const char*>(std::memchr(start, '\n', end - pos));
+            if (nl) {
+                line.append(start, static_cast<size_t>(nl - start));
+                pos += static_cast<size_t>(nl - start) + 1;
+                break;
+            }
+            line.append(start, end - pos);
+            pos = end;
+        }
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    }
+};
+
+ExpressionReader::ExpressionReader(const std::string& path, bool evaluate, int32_t num_threads) {
+    initialize_giac_library();
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        throw std::runtime_error("ExpressionReader: cannot open " + path);
+    }
+    impl_ = std::make_unique<ExpressionReaderImpl>(f, evaluate, num_threads);
+}
+
+ExpressionReader::~ExpressionReader() = default;
+
+bool ExpressionReader::at_end() {
+    return !impl_->fill();
+}
+
+int64_t ExpressionReader::lines_read() const {
+    return impl_->line_no;
+}
+
+ExpressionBatch ExpressionReader::next_batch(int64_t max_lines) {
+    ExpressionReaderImpl& r = *impl_;
+    ExpressionBatch batch;
+    batch.first_line = r.line_no + 1;
+    batch.error_count = 0;
+
+    size_t n = 0;
+    size_t cap = max_lines > 0 ? static_cast<size_t>(max_lines) : 0;
+    while (n < cap) {
+        if (r.lines.size() <= n) r.lines.emplace_back();
+        if (!r.next_line(r.lines[n])) break;
+        ++n;
+    }
+    r.line_no += static_cast<int64_t>(n);
+
+    r.gens.assign(n, giac::gen(0));
+    batch.status.assign(n, GIAC_STATUS_OK);
+    batch.errors.assign(n, std::string());
+    bool parallel = n > 1 && WorkerPool::resolve_threads(r.num_threads) > 1;
+    WorkerPool::instance().run(n, r.num_threads, [&](size_t i) {
+        // Pool threads parse with their own thread-local contexts; a serial
+        // batch parses in the context it is evaluated in
+        giac::context& ctx = parallel || !r.ctx ? get_thread_local_context() : *r.ctx;
+        if (!parallel) {
+            batch.status[i] = parse_line(r.lines[i], false, ctx, r.gens[i], batch.errors[i]);
+            return;
+        }
+        // A pool thread's result can share nodes with that thread's context,
+        // so the caller only ever receives a copy made from scratch
+        giac::gen parsed(0);
+        batch.status[i] = parse_line(r.lines[i], false, ctx, parsed, batch.errors[i]);
+        std::unordered_map<const char*, giac::gen> idents;
+        r.gens[i] = thread_private_copy(parsed, idents);
+    });
+    // Evaluation is sequential so that a line sees the bindings of the
+    // lines before it, whatever the number of parsing threads
+    if (r.evaluate) {
+        for (size_t i = 0; i < n; ++i) {
+            if (batch.status[i] != GIAC_STATUS_OK) continue;
+            batch.status[i] = eval_line(r.gens[i], *r.ctx, batch.errors[i]);
+        }
+    }
+
+    batch.values.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        int32_t st = batch.status[i];
+        if (st == GIAC_STATUS_PARSE_ERROR || st == GIAC_STATUS_EVAL_ERROR) ++batch.error_count;
+        batch.values.push_back(Gen(std::make_unique<GenImpl>(r.gens[i])));
+    }
+    r.gens.clear();
+    return batch;
+}
+
+// ============================================================================
+// No-throw Variants
+// ============================================================================
+
+TryResult::TryResult(Gen value, int32_t status, std::exception_ptr error, std::string detail)
+    : value_(std::move(value)), status_(status), error_(std::move(error)),
+      detail_(std::move(detail)) {}
+
+std::string TryResult::message() const {
+    return status_message(status_, error_, detail_);
+}
+
+namespace {
+    // Run a throwing entry point and capture its failure as a status
+    template <class F>
+    TryResult capture(F&& call) {
+        try {
+            return TryResult(call(), GIAC_STATUS_OK, nullptr, std::string());
+        } catch (...) {
+            return TryResult(Gen(), GIAC_STATUS_EVAL_ERROR, std::current_exception(),
+                             std::string());
+        }
+    }
+}
+
+TryResult try_eval(const std::string& expr) {
+    initialize_giac_library();
+    giac::gen out(0);
+    std::exception_ptr error;
+    std::string token;
+    int32_t status = parse_and_eval(expr, true, get_thread_local_context(), out, error, token);
+    return TryResult(Gen(std::make_unique<GenImpl>(out)), status, std::move(error),
+                     std::move(token));
+}
+
+TryResult try_eval(const std::string& expr, GiacContext& ctx) {
+    initialize_giac_library();
+    giac::gen out(0);
+    std::exception_ptr error;
+    std::string token;
+    int32_t status = parse_and_eval(expr, true, *ctx.impl_->ctx, out, error, token);
+    return TryResult(Gen(std::make_unique<GenImpl>(out)), status, std::move(error),
+                     std::move(token));
+}
+
+TryResult try_apply_func0(const std::string& name) {
+    return capture([&]() { return apply_func0(name); });
+}
+
+TryResult try_apply_func1(const std::string& name, const Gen& arg) {
+    return capture([&]() { return apply_func1(name, arg); });
+}
+
+TryResult try_apply_func2(const std::string& name, const Gen& arg1, const Gen& arg2) {
+    return capture([&]() { return apply_func2(name, arg1, arg2); });
+}
+
+TryResult try_apply_func3(const std::string& name, const Gen& arg1, const Gen& arg2, const Gen& arg3) {
+    return capture([&]() { return apply_func3(name, arg1, arg2, arg3); });
+}
+
+TryResult try_apply_funcN(const std::string& name, const std::vector<Gen>& args) {
+    return capture([&]() { return apply_funcN(name, args); });
+}
+
+// Helper macros mirroring the Tier 1 wrappers
+#define TRY_TIER1_SINGLE_ARG(name) \
+    TryResult try_giac_##name(const Gen& arg) { \
+        return capture([&]() { return giac_##name(arg); }); \
+    }
+
+#define TRY_TIER1_TWO_ARG(name) \
+    TryResult try_giac_##name(const Gen& arg1, const Gen& arg2) { \
+        return capture([&]() { return giac_##name(arg1, arg2); }); \
+    }
+
+#define TRY_TIER1_THREE_ARG(name) \
+    TryResult try_giac_##name(const Gen& arg1, const Gen& arg2, const Gen& arg3) { \
+        return capture([&]() { return giac_##name(arg1, arg2, arg3); }); \
+    }
+
+// Trigonometry
+TRY_TIER1_SINGLE_ARG(sin)
+TRY_TIER1_SINGLE_ARG(cos)
+TRY_TIER1_SINGLE_ARG(tan)
+TRY_TIER1_SINGLE_ARG(asin)
+TRY_TIER1_SINGLE_ARG(acos)
+TRY_TIER1_SINGLE_ARG(atan)
+
+// Exponential / Logarithm
+TRY_TIER1_SINGLE_ARG(exp)
+TRY_TIER1_SINGLE_ARG(ln)
+TRY_TIER1_SINGLE_ARG(log10)
+TRY_TIER1_SINGLE_ARG(sqrt)
+
+// Arithmetic
+TRY_TIER1_SINGLE_ARG(abs)
+TRY_TIER1_SINGLE_ARG(sign)
+TRY_TIER1_SINGLE_ARG(floor)
+TRY_TIER1_SINGLE_ARG(ceil)
+
+// Complex
+TRY_TIER1_SINGLE_ARG(re)
+TRY_TIER1_SINGLE_ARG(im)
+TRY_TIER1_SINGLE_ARG(conj)
+
+// Algebra
+TRY_TIER1_SINGLE_ARG(normal)
+TRY_TIER1_SINGLE_ARG(evalf)
+
+// Calculus (multi-argument)
+TRY_TIER1_TWO_ARG(diff)
+TRY_TIER1_TWO_ARG(integrate)
+TRY_TIER1_THREE_ARG(subst)
+TRY_TIER1_TWO_ARG(solve)
+TRY_TIER1_THREE_ARG(limit)
+TRY_TIER1_THREE_ARG(series)
+
+// Arithmetic (multi-argument)
+TRY_TIER1_TWO_ARG(gcd)
+TRY_TIER1_TWO_ARG(lcm)
+
+// Power
+TRY_TIER1_TWO_ARG(pow)
+
+#undef TRY_TIER1_SINGLE_ARG
+#undef TRY_TIER1_TWO_ARG
+#undef TRY_TIER1_THREE_ARG
+
+
+// ============================================================================
+// Exact Linear Algebra on Flat Buffers
+// ============================================================================
+
+namespace {
+    // RAII mpz_t
+    struct Mpz {
+        mpz_t z;
+        Mpz() { mpz_init(z); }
+        ~Mpz() { mpz_clear(z); }
+        Mpz(const Mpz&) = delete;
+        Mpz& operator=(const Mpz&) = delete;
+    };
+
+    size_t exact_size(const ExactInts& v) {
+        return v.limb_offset.empty() ? v.values.size() : v.sign.size();
+    }
+
+    void check_exact_ints(const ExactInts& v) {
+        if (v.limb_offset.empty()) {
+            return;
+        }
+        if (v.limb_offset.size() != v.sign.size() + 1 || v.limb_offset.front() != 0) {
+            throw std::runtime_error("ExactInts: limb_offset must have sign.size() + 1 entries starting at 0");
+        }
+        for (size_t i = 1; i < v.limb_offset.size(); ++i) {
+            if (v.limb_offset[i] < v.limb_offset[i - 1]) {
+                throw std::runtime_error("ExactInts: limb_offset must be non-decreasing");
+            }
+        }
+        if (static_cast<uint64_t>(v.limb_offset.back()) > v.limbs.size()) {
+            throw std::runtime_error("ExactInts: limb_offset points past the limbs");
+        }
+    }
+
+    void set_mpz_int64(mpz_t out, int64_t v) {
+        // mpz_set_si takes a long, which is 32 bits on Windows
+        uint64_t m = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+        mpz_import(out, 1, -1, sizeof(uint64_t), 0, 0, &m);
+        if (v < 0) mpz_neg(out, out);
+    }
+
+    void read_exact(const ExactInts& v, size_t i, mpz_t out) {
+        if (v.limb_offset.empty()) {
+            set_mpz_int64(out, v.values[i]);
+            return;
+        }
+        size_t begin = static_cast<size_t>(v.limb_offset[i]);
+        size_t count = static_cast<size_t>(v.limb_offset[i + 1]) - begin;
+        mpz_import(out, count, -1, sizeof(uint64_t), 0, 0, v.limbs.data() + begin);
+        if (v.sign[i] < 0) mpz_neg(out, out);
+    }
+
+    // Integer gen -> int64 when |g| < 2^63
+    bool small_int(const giac::gen& g, int64_t& out) {
+        if (g.type == giac::_INT_) {
+            out = g.val;
+            return true;
+        }
+        const mpz_t& z = *g._ZINTptr;
+        if (mpz_sizeinbase(z, 2) > 63) {
+            return false;
+        }
+        uint64_t m = 0;
+        mpz_export(&m, nullptr, -1, sizeof(uint64_t), 0, 0, z);
+        out = mpz_sgn(z) < 0 ? -static_cast<int64_t>(m) : static_cast<int64_t>(m);
+        return true;
+    }
+
+    ExactInts pack_exact(const std::vector<giac::gen>& v) {
+        ExactInts out;
+        out.values.reserve(v.size());
+        int64_t x = 0;
+        for (const giac::gen& g : v) {
+            if (!small_int(g, x)) {
+                out.values.clear();
+                break;
+            }
+            out.values.push_back(x);
+        }
+        if (out.values.size() == v.size()) {
+            return out;
+        }
+
+        out.sign.reserve(v.size());
+        out.limb_offset.reserve(v.size() + 1);
+        out.limb_offset.push_back(0);
+        Mpz tmp;
+        for (const giac::gen& g : v) {
+            const mpz_t* z = &tmp.z;
+            if (g.type == giac::_INT_) {
+                set_mpz_int64(tmp.z, g.val);
+            } else {
+                z = g._ZINTptr;
+            }
+            out.sign.push_back(mpz_sgn(*z));
+            size_t old = out.limbs.size();
+            out.limbs.resize(old + (mpz_sizeinbase(*z, 2) + 63) / 64);
+            size_t written = 0;
+            mpz_export(out.limbs.data() + old, &written, -1, sizeof(uint64_t), 0, 0, *z);
+            out.limbs.resize(old + written);
+            out.limb_offset.push_back(static_cast<int64_t>(out.limbs.size()));
+        }
+        return out;
+    }
+
+    // Integer rows of an exact input: every row of [A | B] is multiplied by
+    // the lcm of its denominators, so giac only ever sees integer matrices
+    // and picks its fraction-free / multimodular algorithms
+    struct ClearedRows {
+        giac::gen a;
+        giac::gen b;
+        std::vector<giac::gen> scale;   // row multipliers, empty when A and B are integer
+    };
+
+    void check_exact_matrix(const ExactMatrix& m, const char* what) {
+        if (m.rows < 0 || m.cols < 0) {
+            throw std::runtime_error(std::string(what) + ": negative dimension");
+        }
+        size_t n = static_cast<size_t>(m.rows) * static_cast<size_t>(m.cols);
+        check_exact_ints(m.num);
+        check_exact_ints(m.den);
+        if (exact_size(m.num) != n) {
+            throw std::runtime_error(std::string(what) + ": num must have rows * cols entries");
+        }
+        if (exact_size(m.den) != n && exact_size(m.den) != 0) {
+            throw std::runtime_error(std::string(what) + ": den must be empty or have rows * cols entries");
+        }
+    }
+
+    ClearedRows clear_rows(const ExactMatrix& a, const ExactMatrix* b) {
+        bool rational = exact_size(a.den) != 0 || (b && exact_size(b->den) != 0);
+        const ExactMatrix* parts[2] = {&a, b};
+        giac::vecteur rows_out[2];
+        ClearedRows out;
+        Mpz num, den, lcm, t;
+
+        for (int64_t i = 0; i < a.rows; ++i) {
+            if (rational) {
+                mpz_set_ui(lcm.z, 1);
+                for (const ExactMatrix* m : parts) {
+                    if (!m || exact_size(m->den) == 0) continue;
+                    for (int64_t j = 0; j < m->cols; ++j) {
+                        read_exact(m->den, static_cast<size_t>(i * m->cols + j), den.z);
+                        if (mpz_sgn(den.z) <= 0) {
+                            throw std::runtime_error("ExactMatrix: denominators must be positive");
+                        }
+                        mpz_lcm(lcm.z, lcm.z, den.z);
+                    }
+                }
+                out.scale.push_back(giac::gen(lcm.z));
+            }
+            for (int k = 0; k < 2; ++k) {
+                const ExactMatrix* m = parts[k];
+                if (!m) continue;
+                giac::vecteur row;
+                row.reserve(static_cast<size_t>(m->cols));
+                for (int64_t j = 0; j < m->cols; ++j) {
+                    size_t idx = static_cast<size_t>(i * m->cols + j);
+                    if (!rational && m->num.limb_offset.empty()) {
+                        row.push_back(giac::gen(static_cast<long long>(m->num.values[idx])));
+                        continue;
+                    }
+                    read_exact(m->num, idx, num.z);
+                    if (rational) {
+                        if (exact_size(m->den) != 0) {
+                            read_exact(m->den, idx, den.z);
+                            mpz_divexact(t.z, lcm.z, den.z);
+                            mpz_mul(num.z, num.z, t.z);
+                        } else {
+                            mpz_mul(num.z, num.z, lcm.z);
+                        }
+                    }
+                    row.push_back(giac::gen(num.z));
+                }
+                rows_out[k].push_back(giac::gen(row));
+            }
+        }
+        out.a = giac::gen(rows_out[0], giac::_MATRIX__VECT);
+        out.b = giac::gen(rows_out[1], giac::_MATRIX__VECT);
+        return out;
+    }
+
+    // Integer or fraction -> (num, den) with den > 0
+    bool split_rational(const giac::gen& e, giac::gen& num, giac::gen& den) {
+        if (e.type == giac::_INT_ || e.type == giac::_ZINT) {
+            num = e;
+            den = giac::gen(1);
+            return true;
+        }
+        if (e.type != giac::_FRAC) {
+            return false;
+        }
+        const giac::gen& n = e._FRACptr->num;
+        const giac::gen& d = e._FRACptr->den;
+        if ((n.type != giac::_INT_ && n.type != giac::_ZINT) ||
+            (d.type != giac::_INT_ && d.type != giac::_ZINT)) {
+            return false;
+        }
+        bool flip = d.type == giac::_INT_ ? d.val < 0 : mpz_sgn(*d._ZINTptr) < 0;
+        num = flip ? -n : n;
+        den = flip ? -d : d;
+        return true;
+    }
+
+    // Rational matrix gen -> ExactMatrix; throws if the shape or entries
+    // are not what the operation should have produced
+    ExactMatrix unpack_exact(const giac::gen& m, int64_t rows, int64_t cols, const char* what) {
+        auto fail = [&]() -> ExactMatrix {
+            throw std::runtime_error(std::string(what) + ": unexpected result " + m.print(&get_thread_local_context()));
+        };
+        if (m.type != giac::_VECT) fail();
+        const giac::vecteur& r = *m._VECTptr;
+        if (rows >= 0 && static_cast<int64_t>(r.size()) != rows) fail();
+
+        ExactMatrix out;
+        out.rows = static_cast<int64_t>(r.size());
+        out.cols = cols;
+        std::vector<giac::gen> num, den;
+        num.reserve(r.size() * static_cast<size_t>(cols));
+        den.reserve(num.capacity());
+        bool integer = true;
+        for (const giac::gen& row : r) {
+            if (row.type != giac::_VECT || static_cast<int64_t>(row._VECTptr->size()) != cols) fail();
+            for (const giac::gen& e : *row._VECTptr) {
+                giac::gen n, d;
+                if (!split_rational(e, n, d)) fail();
+                integer = integer && d.type == giac::_INT_ && d.val == 1;
+                num.push_back(n);
+                den.push_back(d);
+            }
+        }
+        out.num = pack_exact(num);
+        if (!integer) out.den = pack_exact(den);
+        return out;
+    }
+
+    void require_square(const ExactMatrix& a, const char* what) {
+        check_exact_matrix(a, what);
+        if (a.rows != a.cols) {
+            throw std::runtime_error(std::string(what) + ": matrix must be square");
+        }
+    }
+}
+
+ExactInts make_exact_ints(const std::vector<int64_t>& values) {
+    ExactInts v;
+    v.values = values;
+    return v;
+}
+
+ExactInts make_exact_ints_limbs(const std::vector<int32_t>& sign,
+                                const std::vector<int64_t>& limb_offset,
+                                const std::vector<uint64_t>& limbs) {
+    ExactInts v;
+    v.sign = sign;
+    v.limb_offset = limb_offset;
+    v.limbs = limbs;
+    if (limb_offset.empty()) {
+        v.limb_offset.push_back(0);   // zero values in limb form
+    }
+    check_exact_ints(v);
+    return v;
+}
+
+ExactMatrix make_exact_matrix(int64_t rows, int64_t cols, const ExactInts& num,
+                              const ExactInts& den) {
+    ExactMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.num = num;
+    m.den = den;
+    check_exact_matrix(m, "make_exact_matrix");
+    return m;
+}
+
+ExactMatrix exact_det(const ExactMatrix& a) {
+    initialize_giac_library();
+    require_square(a, "exact_det");
+    giac::context& ctx = get_thread_local_context();
+    ClearedRows c = clear_rows(a, nullptr);
+    giac::gen d = a.rows == 0 ? giac::gen(1) : giac::_det(c.a, &ctx);
+    for (const giac::gen& s : c.scale) {
+        d = d / s;   // det(D A) = prod(D) det(A)
+    }
+    giac::vecteur row, rows;
+    row.push_back(d);
+    rows.push_back(giac::gen(row));
+    return unpack_exact(giac::gen(rows), 1, 1, "exact_det");
+}
+
+ExactMatrix exact_rref(const ExactMatrix& a) {
+    initialize_giac_library();
+    check_exact_matrix(a, "exact_rref");
+    if (a.rows == 0 || a.cols == 0) return a;
+    giac::context& ctx = get_thread_local_context();
+    // Row scaling does not change the reduced row echelon form
+    ClearedRows c = clear_rows(a, nullptr);
+    return unpack_exact(giac::_rref(c.a, &ctx), a.rows, a.cols, "exact_rref");
+}
+
+ExactMatrix exact_inverse(const ExactMatrix& a) {
+    initialize_giac_library();
+    require_square(a, "exact_inverse");
+    if (a.rows == 0) return a;
+    giac::context& ctx = get_thread_local_context();
+    ClearedRows c = clear_rows(a, nullptr);
+    giac::gen inv = giac::_inv(c.a, &ctx);
+    if (inv.type != giac::_VECT || static_cast<int64_t>(inv._VECTptr->size()) != a.rows) {
+        throw std::runtime_error("exact_inverse: matrix is singular");
+    }
+    if (!c.scale.empty()) {
+        // A^-1 = (D A)^-1 D: scale column j by D_j
+        giac::vecteur rows = *inv._VECTptr;
+        for (giac::gen& row : rows) {
+            if (row.type != giac::_VECT) break;
+            giac::vecteur r = *row._VECTptr;
+            for (size_t j = 0; j < r.size() && j < c.scale.size(); ++j) {
+                r[j] = r[j] * c.scale[j];
+            }
+            row = giac::gen(r);
+        }
+        inv = giac::gen(rows, giac::_MATRIX__VECT);
+    }
+    return unpack_exact(inv, a.rows, a.cols, "exact_inverse");
+}
+
+ExactMatrix exact_linsolve(const ExactMatrix& a, const ExactMatrix& b) {
+    initialize_giac_library();
+    check_exact_matrix(a, "exact_linsolve");
+    check_exact_matrix(b, "exact_linsolve");
+    if (b.rows != a.rows) {
+        throw std::runtime_error("exact_linsolve: A and B must have the same number of rows");
+    }
+    giac::context& ctx = get_thread_local_context();
+    // Scaling row i of [A | B] leaves the solution unchanged
+    ClearedRows c = clear_rows(a, &b);
+    giac::gen x = giac::_simult(giac::gen(giac::makevecteur(c.a, c.b), giac::_SEQ__VECT), &ctx);
+    if (x.type != giac::_VECT || static_cast<int64_t>(x._VECTptr->size()) != a.cols) {
+        throw std::runtime_error("exact_linsolve: system has no unique solution");
+    }
+    return unpack_exact(x, a.cols, b.cols, "exact_linsolve");
+}
+
+ExactMatrix exact_ker(const ExactMatrix& a) {
+    initialize_giac_library();
+    check_exact_matrix(a, "exact_ker");
+    giac::context& ctx = get_thread_local_context();
+    ClearedRows c = clear_rows(a, nullptr);
+    giac::gen k = giac::_ker(c.a, &ctx);
+    if (k.type == giac::_VECT) {
+        // giac reports a trivial kernel as a single zero vector
+        giac::vecteur basis;
+        for (const giac::gen& v : *k._VECTptr) {
+            bool zero = v.type == giac::_VECT;
+            if (zero) {
+                for (const giac::gen& e : *v._VECTptr) {
+                    if (!is_exact_zero(e)) { zero = false; break; }
+                }
+            }
+            if (!zero) basis.push_back(v);
+        }
+        k = giac::gen(basis);
+    }
+    return unpack_exact(k, -1, a.cols, "exact_ker");
+}
+
+
+// ============================================================================
+// Modular (Z/pZ) Dense Linear Algebra and Polynomials
+// ============================================================================
+
+namespace {
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    // Unsigned element type and double-width accumulator per buffer type
+    template <class T> struct ModTraits;
+    template <> struct ModTraits<int32_t> { using U = uint32_t; using W = uint64_t; };
+    template <> struct ModTraits<int64_t> { using U = uint64_t; using W = uint128_t; };
+
+    // Arithmetic in Z/pZ on reduced values in [0, p)
+    template <class T>
+    struct Zp {
+        using U = typename ModTraits<T>::U;
+        using W = typename ModTraits<T>::W;
+        U p;
+
+        explicit Zp(int64_t modulus) {
+            if (modulus < 2 || modulus > std::numeric_limits<T>::max()) {
+                throw std::runtime_error("modulus must satisfy 2 <= p <= " +
+                                         std::to_string(std::numeric_limits<T>::max()));
+            }
+            p = static_cast<U>(modulus);
+        }
+
+        U reduce(int64_t x) const {
+            int64_t r = x % static_cast<int64_t>(p);
+            return static_cast<U>(r < 0 ? r + static_cast<int64_t>(p) : r);
+        }
+        U add(U a, U b) const { U s = a + b; return s >= p ? s - p : s; }
+        U sub(U a, U b) const { return a >= b ? a - b : a + (p - b); }
+        U mul(U a, U b) const { return static_cast<U>(static_cast<W>(a) * b % p); }
+
+        U inv(U a) const {
+            // Extended Euclid on signed values; p < 2^63 so they fit
+            int64_t r0 = static_cast<int64_t>(p), r1 = static_cast<int64_t>(a);
+            int64_t s0 = 0, s1 = 1;
+            while (r1 != 0) {
+                int64_t q = r0 / r1;
+                int64_t t = r0 - q * r1; r0 = r1; r1 = t;
+                t = s0 - q * s1; s0 = s1; s1 = t;
+            }
+            if (r0 != 1) {
+                throw std::runtime_error("element is not invertible mod " + std::to_string(p) +
+                                         " (is the modulus prime?)");
+            }
+            return reduce(s0);
+        }
+
+        // How many products (each < (p-1)^2) a W accumulator below p can
+        // absorb before it has to be reduced
+        size_t fold() const {
+            W q = static_cast<W>(p - 1) * (p - 1);
+            if (q == 0) return std::numeric_limits<size_t>::max();
+            W n = (~W(0) - p) / q;
+            return n > W(std::numeric_limits<size_t>::max()) ? std::numeric_limits<size_t>::max()
+                                                              : static_cast<size_t>(n);
+        }
+
+        std::vector<U> load(const std::vector<T>& a) const {
+            std::vector<U> out(a.size());
+            for (size_t i = 0; i < a.size(); ++i) out[i] = reduce(a[i]);
+            return out;
+        }
+
+        std::vector<T> store(const std::vector<U>& a) const {
+            return std::vector<T>(a.begin(), a.end());
+        }
+    };
+
+    void check_matrix_size(size_t size, int64_t rows, int64_t cols, const char* what) {
+        if (rows < 0 || cols < 0 || size != static_cast<size_t>(rows) * static_cast<size_t>(cols)) {
+            throw std::runtime_error(std::string(what) + ": buffer size does not match dimensions");
+        }
+    }
+
+    // Gaussian elimination in place; returns the rank. With full = true the
+    // result is the reduced row echelon form. det (optional) receives the
+    // determinant when the matrix is square.
+    template <class T>
+    int64_t mod_eliminate(std::vector<typename Zp<T>::U>& m, int64_t rows, int64_t cols,
+                          const Zp<T>& z, bool full, typename Zp<T>::U* det) {
+        using U = typename Zp<T>::U;
+        size_t c = static_cast<size_t>(cols);
+        int64_t rank = 0;
+        U d = 1;
+        bool negate = false;
+        for (int64_t col = 0; col < cols && rank < rows; ++col) {
+            int64_t piv = rank;
+            while (piv < rows && m[piv * c + col] == 0) ++piv;
+            if (piv == rows) continue;
+            if (piv != rank) {
+                std::swap_ranges(m.begin() + piv * c, m.begin() + (piv + 1) * c, m.begin() + rank * c);
+                negate = !negate;
+            }
+            U* prow = m.data() + rank * c;
+            d = z.mul(d, prow[col]);
+            U pinv = z.inv(prow[col]);
+            if (full) {
+                for (int64_t j = col; j < cols; ++j) prow[j] = z.mul(prow[j], pinv);
+                pinv = 1;
+            }
+            for (int64_t i = full ? 0 : rank + 1; i < rows; ++i) {
+                if (i == rank) continue;
+                U* row = m.data() + i * c;
+                if (row[col] == 0) continue;
+                U f = z.mul(row[col], pinv);
+                for (int64_t j = col; j < cols; ++j) row[j] = z.sub(row[j], z.mul(f, prow[j]));
+            }
+            ++rank;
+        }
+        if (det) {
+            *det = rank < rows ? 0 : (negate ? z.sub(0, d) : d);
+        }
+        return rank;
+    }
+
+    template <class T>
+    int64_t mod_rank_impl(const std::vector<T>& a, int64_t rows, int64_t cols, int64_t p) {
+        check_matrix_size(a.size(), rows, cols, "mod_rank");
+        Zp<T> z(p);
+        auto m = z.load(a);
+        return mod_eliminate<T>(m, rows, cols, z, false, nullptr);
+    }
+
+    template <class T>
+    int64_t mod_det_impl(const std::vector<T>& a, int64_t n, int64_t p) {
+        check_matrix_size(a.size(), n, n, "mod_det");
+        Zp<T> z(p);
+        auto m = z.load(a);
+        typename Zp<T>::U d = 1;
+        mod_eliminate<T>(m, n, n, z, false, &d);
+        return static_cast<int64_t>(d);
+    }
+
+    template <class T>
+    std::vector<T> mod_rref_impl(const std::vector<T>& a, int64_t rows, int64_t cols, int64_t p) {
+        check_matrix_size(a.size(), rows, cols, "mod_rref");
+        Zp<T> z(p);
+        auto m = z.load(a);
+        mod_eliminate<T>(m, rows, cols, z, true, nullptr);
+        return z.store(m);
+    }
+
+    template <class T>
+    std::vector<T> mod_inverse_impl(const std::vector<T>& a, int64_t n, int64_t p) {
+        check_matrix_size(a.size(), n, n, "mod_inverse");
+        Zp<T> z(p);
+        size_t un = static_cast<size_t>(n);
+        // rref of [A | I]: the left block becomes I exactly when A is invertible
+        std::vector<typename Zp<T>::U> m(un * 2 * un, 0);
+        for (size_t i = 0; i < un; ++i) {
+            for (size_t j = 0; j < un; ++j) m[i * 2 * un + j] = z.reduce(a[i * un + j]);
+            m[i * 2 * un + un + i] = 1;
+        }
+        mod_eliminate<T>(m, n, 2 * n, z, true, nullptr);
+        std::vector<T> out(un * un);
+        for (size_t i = 0; i < un; ++i) {
+            if (m[i * 2 * un + i] != 1) {
+                throw std::runtime_error("mod_inverse: matrix is singular mod " + std::to_string(p));
+            }
+            std::copy(m.begin() + i * 2 * un + un, m.begin() + (i + 1) * 2 * un, out.begin() + i * un);
+        }
+        return out;
+    }
+
+    template <class T>
+    std::vector<T> mod_matmul_impl(const std::vector<T>& a, const std::vector<T>& b,
+                                   int64_t m, int64_t k, int64_t n, int64_t p, int32_t num_threads) {
+        using U = typename Zp<T>::U;
+        using W = typename Zp<T>::W;
+        check_matrix_size(a.size(), m, k, "mod_matmul");
+        check_matrix_size(b.size(), k, n, "mod_matmul");
+        Zp<T> z(p);
+        auto A = z.load(a);
+        auto B = z.load(b);
+        size_t uk = static_cast<size_t>(k), un = static_cast<size_t>(n);
+        size_t fold = z.fold();
+        std::vector<T> out(static_cast<size_t>(m) * un);
+
+        size_t threads = WorkerPool::resolve_threads(num_threads);
+        size_t n_slices = std::min<size_t>(static_cast<size_t>(m), threads * 4);
+        WorkerPool::instance().run(n_slices, num_threads, [&](size_t t) {
+            std::vector<W> acc(un);
+            for (size_t i = t; i < static_cast<size_t>(m); i += n_slices) {
+                std::fill(acc.begin(), acc.end(), W(0));
+                size_t pending = 0;
+                for (size_t kk = 0; kk < uk; ++kk) {
+                    U aik = A[i * uk + kk];
+                    if (aik == 0) continue;
+                    const U* brow = B.data() + kk * un;
+                    for (size_t j = 0; j < un; ++j) acc[j] += static_cast<W>(aik) * brow[j];
+                    if (++pending == fold) {
+                        for (W& x : acc) x %= z.p;
+                        pending = 0;
+                    }
+                }
+                for (size_t j = 0; j < un; ++j) out[i * un + j] = static_cast<T>(acc[j] % z.p);
+            }
+        });
+        return out;
+    }
+
+    template <class U>
+    void trim(std::vector<U>& a) {
+        while (!a.empty() && a.back() == 0) a.pop_back();
+    }
+
+    template <class T>
+    std::vector<T> mod_poly_mul_impl(const std::vector<T>& a, const std::vector<T>& b, int64_t p) {
+        using U = typename Zp<T>::U;
+        using W = typename Zp<T>::W;
+        Zp<T> z(p);
+        auto A = z.load(a);
+        auto B = z.load(b);
+        trim(A);
+        trim(B);
+        if (A.empty() || B.empty()) return {};
+        // Schoolbook product with the same delayed reduction as mod_matmul
+        size_t fold = z.fold();
+        std::vector<W> acc(A.size() + B.size() - 1, W(0));
+        size_t pending = 0;
+        for (size_t i = 0; i < A.size(); ++i) {
+            if (A[i] == 0) continue;
+            for (size_t j = 0; j < B.size(); ++j) acc[i + j] += static_cast<W>(A[i]) * B[j];
+            if (++pending == fold) {
+                for (W& x : acc) x %= z.p;
+                pending = 0;
+            }
+        }
+        std::vector<U> out(acc.size());
+        for (size_t i = 0; i < acc.size(); ++i) out[i] = static_cast<U>(acc[i] % z.p);
+        trim(out);
+        return z.store(out);
+    }
+
+    // Long division on reduced, trimmed operands; b must be non-empty
+    template <class T>
+    void mod_divrem_reduced(std::vector<typename Zp<T>::U>& r, const std::vector<typename Zp<T>::U>& b,
+                            std::vector<typename Zp<T>::U>* q, const Zp<T>& z) {
+        using U = typename Zp<T>::U;
+        size_t db = b.size() - 1;
+        U lead_inv = z.inv(b.back());
+        if (q) q->assign(r.size() >= b.size() ? r.size() - db : 0, 0);
+        while (r.size() >= b.size()) {
+            size_t shift = r.size() - b.size();
+            U f = z.mul(r.back(), lead_inv);
+            if (q) (*q)[shift] = f;
+            for (size_t j = 0; j < db; ++j) r[shift + j] = z.sub(r[shift + j], z.mul(f, b[j]));
+            r.pop_back();
+            trim(r);
+        }
+    }
+
+    template <class T>
+    ModDivRem<T> mod_poly_divrem_impl(const std::vector<T>& a, const std::vector<T>& b, int64_t p) {
+        Zp<T> z(p);
+        auto R = z.load(a);
+        auto B = z.load(b);
+        trim(R);
+        trim(B);
+        if (B.empty()) {
+            throw std::runtime_error("mod_poly_divrem: division by the zero polynomial");
+        }
+        std::vector<typename Zp<T>::U> Q;
+        mod_divrem_reduced<T>(R, B, &Q, z);
+        trim(Q);
+        return ModDivRem<T>{z.store(Q), z.store(R)};
+    }
+
+    template <class T>
+    std::vector<T> mod_poly_gcd_impl(const std::vector<T>& a, const std::vector<T>& b, int64_t p) {
+        Zp<T> z(p);
+        auto A = z.load(a);
+        auto B = z.load(b);
+        trim(A);
+        trim(B);
+        while (!B.empty()) {
+            mod_divrem_reduced<T>(A, B, nullptr, z);
+            std::swap(A, B);
+        }
+        if (!A.empty()) {
+            auto lead_inv = z.inv(A.back());
+            for (auto& c : A) c = z.mul(c, lead_inv);
+        }
+        return z.store(A);
+    }
+
+    template <class T>
+    std::vector<T> mod_poly_eval_impl(const std::vector<T>& a, const std::vector<T>& points,
+                                      int64_t p, int32_t num_threads) {
+        using U = typename Zp<T>::U;
+        Zp<T> z(p);
+        auto A = z.load(a);
+        trim(A);
+        std::vector<T> out(points.size());
+        size_t threads = WorkerPool::resolve_threads(num_threads);
+        size_t n_slices = std::min(points.size(), threads * 4);
+        WorkerPool::instance().run(n_slices, num_threads, [&](size_t t) {
+            for (size_t i = t; i < points.size(); i += n_slices) {
+                U x = z.reduce(points[i]);
+                U y = 0;
+                for (size_t j = A.size(); j-- > 0;) y = z.add(z.mul(y, x), A[j]);
+                out[i] = static_cast<T>(y);
+            }
+        });
+        return out;
+    }
+}
+
+int64_t mod_rank(const std::vector<int32_t>& a, int64_t rows, int64_t cols, int64_t p) {
+    return mod_rank_impl(a, rows, cols, p);
+}
+
+int64_t mod_rank(const std::vector<int64_t>& a, int64_t rows, int64_t cols, int64_t p) {
+    return mod_rank_impl(a, rows, cols, p);
+}
+
+int64_t mod_det(const std::vector<int32_t>& a, int64_t n, int64_t p) {
+    return mod_det_impl(a, n, p);
+}
+
+int64_t mod_det(const std::vector<int64_t>& a, int64_t n, int64_t p) {
+    return mod_det_impl(a, n, p);
+}
+
+std::vector<int32_t> mod_rref(const std::vector<int32_t>& a, int64_t rows, int64_t cols, int64_t p) {
+    return mod_rref_impl(a, rows, cols, p);
+}
+
+std::vector<int64_t> mod_rref(const std::vector<int64_t>& a, int64_t rows, int64_t cols, int64_t p) {
+    return mod_rref_impl(a, rows, cols, p);
+}
+
+std::vector<int32_t> mod_inverse(const std::vector<int32_t>& a, int64_t n, int64_t p) {
+    return mod_inverse_impl(a, n, p);
+}
+
+std::vector<int64_t> mod_inverse(const std::vector<int64_t>& a, int64_t n, int64_t p) {
+    return mod_inverse_impl(a, n, p);
+}
+
+std::vector<int32_t> mod_matmul(const std::vector<int32_t>& a, const std::vector<int32_t>& b,
+                                int64_t m, int64_t k, int64_t n, int64_t p, int32_t num_threads) {
+    return mod_matmul_impl(a, b, m, k, n, p, num_threads);
+}
+
+std::vector<int64_t> mod_matmul(const std::vector<int64_t>& a, const std::vector<int64_t>& b,
+                                int64_t m, int64_t k, int64_t n, int64_t p, int32_t num_threads) {
+    return mod_matmul_impl(a, b, m, k, n, p, num_threads);
+}
+
+std::vector<int32_t> mod_poly_mul(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p) {
+    return mod_poly_mul_impl(a, b, p);
+}
+
+std::vector<int64_t> mod_poly_mul(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p) {
+    return mod_poly_mul_impl(a, b, p);
+}
+
+ModDivRem<int32_t> mod_poly_divrem(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p) {
+    return mod_poly_divrem_impl(a, b, p);
+}
+
+ModDivRem<int64_t> mod_poly_divrem(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p) {
+    return mod_poly_divrem_impl(a, b, p);
+}
+
+std::vector<int32_t> mod_poly_gcd(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p) {
+    return mod_poly_gcd_impl(a, b, p);
+}
+
+std::vector<int64_t> mod_poly_gcd(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p) {
+    return mod_poly_gcd_impl(a, b, p);
+}
+
+std::vector<int32_t> mod_poly_eval(const std::vector<int32_t>& a, const std::vector<int32_t>& points,
+                                   int64_t p, int32_t num_threads) {
+    return mod_poly_eval_impl(a, points, p, num_threads);
+}
+
+std::vector<int64_t> mod_poly_eval(const std::vector<int64_t>& a, const std::vector<int64_t>& points,
+                                   int64_t p, int32_t num_threads) {
+    return mod_poly_eval_impl(a, points, p, num_threads);
+}
+
+
+// ============================================================================
+// Sparse Matrices (CSC)
+// ============================================================================
+
+namespace {
+    void check_csc(const CscMatrix& m) {
+        if (m.rows < 0 || m.cols < 0) {
+            throw std::runtime_error("CscMatrix: negative dimension");
+        }
+        if (m.colptr.size() != static_cast<size_t>(m.cols) + 1 || m.colptr.front() != 0) {
+            throw std::runtime_error("CscMatrix: colptr must have cols + 1 entries starting at 0");
+        }
+        for (size_t j = 1; j < m.colptr.size(); ++j) {
+            if (m.colptr[j] < m.colptr[j - 1]) {
+                throw std::runtime_error("CscMatrix: colptr must be non-decreasing");
+            }
+        }
+        size_t nnz = static_cast<size_t>(m.colptr.back());
+        if (m.rowval.size() != nnz || m.nzval.size() != nnz) {
+            throw std::runtime_error("CscMatrix: rowval and nzval must have colptr[cols] entries");
+        }
+        for (int64_t r : m.rowval) {
+            if (r < 0 || r >= m.rows) {
+                throw std::runtime_error("CscMatrix: row index out of range");
+            }
+        }
+    }
+
+    giac::gen sparse_key(int64_t i, int64_t j) {
+        return giac::gen(giac::makevecteur(giac::gen(static_cast<long long>(i)),
+                                           giac::gen(static_cast<long long>(j))),
+                         giac::_SEQ__VECT);
+    }
+
+    bool index_of(const giac::gen& g, int64_t& out) {
+        if (g.type != giac::_INT_ || g.val < 0) return false;
+        out = g.val;
+        return true;
+    }
+
+    double entry_double(const giac::gen& v, giac::context& ctx) {
+        if (v.type == giac::_DOUBLE_) return v._DOUBLE_val;
+        if (v.type == giac::_INT_) return v.val;
+        giac::gen d = giac::evalf_double(v, 1, &ctx);
+        if (d.type != giac::_DOUBLE_) {
+            throw std::runtime_error("gen_to_csc: entry is not numeric: " + v.print(&ctx));
+        }
+        return d._DOUBLE_val;
+    }
+
+    // Row-major copy for the parallel matrix-vector products
+    struct Csr {
+        std::vector<int64_t> rowptr;
+        std::vector<int64_t> colind;
+        std::vector<double> val;
+    };
+
+    Csr to_csr(const CscMatrix& a) {
+        Csr c;
+        size_t nnz = a.nzval.size();
+        c.rowptr.assign(static_cast<size_t>(a.rows) + 1, 0);
+        for (int64_t r : a.rowval) ++c.rowptr[static_cast<size_t>(r) + 1];
+        for (size_t i = 1; i < c.rowptr.size(); ++i) c.rowptr[i] += c.rowptr[i - 1];
+        c.colind.resize(nnz);
+        c.val.resize(nnz);
+        std::vector<int64_t> next(c.rowptr.begin(), c.rowptr.end() - 1);
+        for (int64_t j = 0; j < a.cols; ++j) {
+            for (int64_t k = a.colptr[j]; k < a.colptr[j + 1]; ++k) {
+                int64_t dst = next[static_cast<size_t>(a.rowval[k])]++;
+                c.colind[dst] = j;
+                c.val[dst] = a.nzval[k];
+            }
+        }
+        return c;
+    }
+
+    void spmv(const Csr& a, const std::vector<double>& x, std::vector<double>& y,
+              size_t n_slices, int32_t num_threads) {
+        size_t n = y.size();
+        WorkerPool::instance().run(n_slices, num_threads, [&](size_t t) {
+            size_t begin = n * t / n_slices, end = n * (t + 1) / n_slices;
+            for (size_t i = begin; i < end; ++i) {
+                double sum = 0.0;
+                for (int64_t k = a.rowptr[i]; k < a.rowptr[i + 1]; ++k) sum += a.val[k] * x[a.colind[k]];
+                y[i] = sum;
+            }
+        });
+    }
+
+    double dot(const std::vector<double>& a, const std::vector<double>& b) {
+        double s = 0.0;
+        for (size_t i = 0; i < a.size(); ++i) s += a[i] * b[i];
+        return s;
+    }
+
+    struct SparseEntry {
+        int64_t col;
+        uint64_t val;
+    };
+}
+
+CscMatrix make_csc_matrix(int64_t rows, int64_t cols, const std::vector<int64_t>& colptr,
+                          const std::vector<int64_t>& rowval, const std::vector<double>& nzval) {
+    CscMatrix m;
+    m.rows = rows;
+    m.cols = cols;
+    m.colptr = colptr;
+    m.rowval = rowval;
+    m.nzval = nzval;
+    if (m.colptr.empty() && cols == 0) m.colptr.push_back(0);
+    check_csc(m);
+    return m;
+}
+
+Gen csc_to_gen(const CscMatrix& m) {
+    initialize_giac_library();
+    check_csc(m);
+    giac::gen_map entries;
+    // Repeated (row, col) pairs are summed, as in the products and sparse_solve
+    std::map<int64_t, double> column;
+    for (int64_t j = 0; j < m.cols; ++j) {
+        column.clear();
+        for (int64_t k = m.colptr[j]; k < m.colptr[j + 1]; ++k) {
+            column[m.rowval[k]] += m.nzval[k];
+        }
+        for (const auto& [row, value] : column) {
+            if (value == 0.0) continue;
+            entries[sparse_key(row, j)] = giac::gen(value);
+        }
+    }
+    return Gen(std::make_unique<GenImpl>(giac::gen(entries)));
+}
+
+CscMatrix gen_to_csc(const Gen& m, int64_t rows, int64_t cols) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    const giac::gen& g = m.impl_->g;
+
+    struct Triple { int64_t col, row; double val; };
+    std::vector<Triple> t;
+    int64_t max_row = -1, max_col = -1;
+
+    if (g.type == giac::_MAP) {
+        t.reserve(g._MAPptr->size());
+        for (const auto& kv : *g._MAPptr) {
+            const giac::gen& key = kv.first;
+            int64_t i = 0, j = 0;
+            if (key.type != giac::_VECT || key._VECTptr->size() != 2 ||
+                !index_of((*key._VECTptr)[0], i) || !index_of((*key._VECTptr)[1], j)) {
+                throw std::runtime_error("gen_to_csc: map keys must be [row, col] index pairs");
+            }
+            double v = entry_double(kv.second, ctx);
+            if (v == 0.0) continue;
+            t.push_back({j, i, v});
+            max_row = std::max(max_row, i);
+            max_col = std::max(max_col, j);
+        }
+    } else if (g.type == giac::_VECT) {
+        const giac::vecteur& r = *g._VECTptr;
+        max_row = static_cast<int64_t>(r.size()) - 1;
+        for (size_t i = 0; i < r.size(); ++i) {
+            if (r[i].type != giac::_VECT) {
+                throw std::runtime_error("gen_to_csc: dense matrix rows must be vectors");
+            }
+            const giac::vecteur& row = *r[i]._VECTptr;
+            max_col = std::max(max_col, static_cast<int64_t>(row.size()) - 1);
+            for (size_t j = 0; j < row.size(); ++j) {
+                double v = entry_double(row[j], ctx);
+                if (v != 0.0) t.push_back({static_cast<int64_t>(j), static_cast<int64_t>(i), v});
+            }
+        }
+    } else {
+        throw std::runtime_error("gen_to_csc: expected a sparse (_MAP) or dense matrix");
+    }
+
+    CscMatrix out;
+    out.rows = rows >= 0 ? rows : max_row + 1;
+    out.cols = cols >= 0 ? cols : max_col + 1;
+    if (max_row >= out.rows || max_col >= out.cols) {
+        throw std::runtime_error("gen_to_csc: matrix has entries outside rows x cols");
+    }
+    std::sort(t.begin(), t.end(), [](const Triple& a, const Triple& b) {
+        return a.col != b.col ? a.col < b.col : a.row < b.row;
+    });
+    out.colptr.assign(static_cast<size_t>(out.cols) + 1, 0);
+    out.rowval.reserve(t.size());
+    out.nzval.reserve(t.size());
+    for (const Triple& e : t) {
+        ++out.colptr[static_cast<size_t>(e.col) + 1];
+        out.rowval.push_back(e.row);
+        out.nzval.push_back(e.val);
+    }
+    for (size_t j = 1; j < out.colptr.size(); ++j) out.colptr[j] += out.colptr[j - 1];
+    return out;
+}
+
+SparseSolveResult sparse_solve(const CscMatrix& a, const std::vector<double>& b, double tol,
+                               int64_t max_iter, int32_t num_threads) {
+    check_csc(a);
+    if (a.rows != a.cols) {
+        throw std::runtime_error("sparse_solve: matrix must be square");
+    }
+    if (b.size() != static_cast<size_t>(a.rows)) {
+        throw std::runtime_error("sparse_solve: b must have one entry per row");
+    }
+    size_t n = b.size();
+    if (max_iter <= 0) max_iter = 2 * a.rows;
+
+    SparseSolveResult res;
+    res.x.assign(n, 0.0);
+    double bnorm = std::sqrt(dot(b, b));
+    if (n == 0 || bnorm == 0.0) {
+        res.converged = true;
+        return res;
+    }
+
+    Csr csr = to_csr(a);
+    size_t n_slices = std::min(n, WorkerPool::resolve_threads(num_threads) * 4);
+
+    // Jacobi preconditioner: M^-1 = 1 / diag(A), 1 where the diagonal is zero
+    std::vector<double> minv(n, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        for (int64_t k = csr.rowptr[i]; k < csr.rowptr[i + 1]; ++k) {
+            if (csr.colind[k] == static_cast<int64_t>(i) && csr.val[k] != 0.0) minv[i] = 1.0 / csr.val[k];
+        }
+    }
+
+    // Right-preconditioned BiCGSTAB from x0 = 0
+    std::vector<double> r = b, r_hat = b, p(n, 0.0), v(n, 0.0), y(n), s(n), z(n), t(n);
+    double rho = 1.0, alpha = 1.0, omega = 1.0;
+    double threshold = tol * bnorm;
+    res.residual = 1.0;
+    for (int64_t it = 1; it <= max_iter; ++it) {
+        res.iterations = it;
+        double rho_new = dot(r_hat, r);
+        if (rho_new == 0.0 || omega == 0.0) break;   // breakdown
+        double beta = (rho_new / rho) * (alpha / omega);
+        for (size_t i = 0; i < n; ++i) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+        for (size_t i = 0; i < n; ++i) y[i] = minv[i] * p[i];
+        spmv(csr, y, v, n_slices, num_threads);
+        double rv = dot(r_hat, v);
+        if (rv == 0.0) break;
+        alpha = rho_new / rv;
+        for (size_t i = 0; i < n; ++i) s[i] = r[i] - alpha * v[i];
+        double snorm = std::sqrt(dot(s, s));
+        if (snorm <= threshold) {
+            for (size_t i = 0; i < n; ++i) res.x[i] += alpha * y[i];
+            res.residual = snorm / bnorm;
+            res.converged = true;
+            return res;
+        }
+        for (size_t i = 0; i < n; ++i) z[i] = minv[i] * s[i];
+        spmv(csr, z, t, n_slices, num_threads);
+        double tt = dot(t, t);
+        omega = tt == 0.0 ? 0.0 : dot(t, s) / tt;
+        for (size_t i = 0; i < n; ++i) {
+            res.x[i] += alpha * y[i] + omega * z[i];
+            r[i] = s[i] - omega * t[i];
+        }
+        double rnorm = std::sqrt(dot(r, r));
+        res.residual = rnorm / bnorm;
+        if (rnorm <= threshold) {
+            res.converged = true;
+            return res;
+        }
+        rho = rho_new;
+    }
+    return res;
+}
+
+int64_t sparse_rank(const CscMatrix& a, int64_t p) {
+    check_csc(a);
+    Zp<int64_t> z(p == 0 ? 2147483647 : p);
+
+    // Rows as (col, value) lists, cols ascending
+    std::vector<std::vector<SparseEntry>> rows(static_cast<size_t>(a.rows));
+    for (int64_t j = 0; j < a.cols; ++j) {
+        for (int64_t k = a.colptr[j]; k < a.colptr[j + 1]; ++k) {
+            double v = a.nzval[k];
+            if (v != std::nearbyint(v) || std::fabs(v) >= 9.2e18) {
+                throw std::runtime_error("sparse_rank: matrix entries must be integers");
+            }
+            uint64_t r = z.reduce(static_cast<int64_t>(v));
+            if (r != 0) rows[static_cast<size_t>(a.rowval[k])].push_back({j, r});
+        }
+    }
+    std::vector<size_t> order(rows.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return rows[x].size() < rows[y].size();
+    });
+
+    // Monic pivot rows keyed by leading column
+    std::unordered_map<int64_t, std::vector<SparseEntry>> pivots;
+    std::vector<SparseEntry> merged;
+    for (size_t idx : order) {
+        std::vector<SparseEntry> row = std::move(rows[idx]);
+        while (!row.empty()) {
+            auto it = pivots.find(row.front().col);
+            if (it == pivots.end()) {
+                uint64_t inv = z.inv(row.front().val);
+                for (SparseEntry& e : row) e.val = z.mul(e.val, inv);
+                pivots.emplace(row.front().col, std::move(row));
+                break;
+            }
+            // row -= row[0] * pivot, which cancels the leading entry
+            const std::vector<SparseEntry>& piv = it->second;
+            uint64_t f = row.front().val;
+            merged.clear();
+            size_t i = 1, k = 1;
+            while (i < row.size() || k < piv.size()) {
+                if (k == piv.size() || (i < row.size() && row[i].col < piv[k].col)) {
+                    merged.push_back(row[i++]);
+                } else if (i == row.size() || piv[k].col < row[i].col) {
+                    merged.push_back({piv[k].col, z.sub(0, z.mul(f, piv[k].val))});
+                    ++k;
+                } else {
+                    uint64_t v = z.sub(row[i].val, z.mul(f, piv[k].val));
+                    if (v != 0) merged.push_back({row[i].col, v});
+                    ++i;
+                    ++k;
+                }
+            }
+            row.swap(merged);
+        }
+    }
+    return static_cast<int64_t>(pivots.size());
+}
+
+
+// ============================================================================
+// Poly - Polynomial handle in giac's internal representation
+// ============================================================================
+
+struct PolyImpl {
+    giac::polynome p;
+    giac::vecteur vars;               // identifiers, in exponent order
+    std::vector<std::string> names;
+};
+
+namespace {
+    std::unique_ptr<PolyImpl> poly_like(const PolyImpl& shape, giac::polynome p) {
+        auto out = std::make_unique<PolyImpl>();
+        out->p = std::move(p);
+        out->vars = shape.vars;
+        out->names = shape.names;
+        return out;
+    }
+
+    giac::polynome constant_poly(const giac::gen& c, size_t dim) {
+        giac::polynome p(static_cast<int>(dim));
+        if (!(c.type == giac::_INT_ && c.val == 0)) {
+            p.coord.push_back(giac::monomial<giac::gen>(c, giac::index_m(giac::index_t(dim, 0))));
+        }
+        return p;
+    }
+
+    // Distributed form of e2r's result: a _POLY, a constant, or a _POLY
+    // over a constant denominator (rational coefficients)
+    giac::polynome to_polynome(const giac::gen& r, size_t dim) {
+        if (r.type == giac::_POLY) {
+            return *r._POLYptr;
+        }
+        if (r.type == giac::_FRAC) {
+            const giac::gen& num = r._FRACptr->num;
+            const giac::gen& den = r._FRACptr->den;
+            if (den.type == giac::_POLY) {
+                throw std::runtime_error("Poly: expression is a rational function, not a polynomial");
+            }
+            if (num.type != giac::_POLY) {
+                return constant_poly(r, dim);
+            }
+            giac::polynome p = *num._POLYptr;
+            for (auto& m : p.coord) m.value = m.value / den;
+            return p;
+        }
+        return constant_poly(r, dim);
+    }
+
+    // e2r keeps any non-polynomial subterm as a coefficient, so sin(x)*y
+    // in [x, y] would come back as sin(x) times y
+    void require_coefficients_free_of_vars(const PolyImpl& p) {
+        for (const auto& m : p.p.coord) {
+            const std::string* hit = nullptr;
+            walk_tree(m.value, [&](const giac::gen& node, int32_t) {
+                if (node.type == giac::_IDNT) {
+                    for (const std::string& name : p.names) {
+                        if (name == node._IDNTptr->id_name) hit = &name;
+                    }
+                }
+                return hit == nullptr;
+            });
+            if (hit) {
+                throw std::runtime_error("Poly: expression is not a polynomial in " + *hit);
+            }
+        }
+    }
+
+    void require_same_vars(const PolyImpl& a, const PolyImpl& b) {
+        if (a.names != b.names) {
+            throw std::runtime_error("Poly: operands have different variable lists");
+        }
+    }
+
+    std::unique_ptr<PolyImpl> poly_impl_for(const std::vector<std::string>& vars) {
+        initialize_giac_library();
+        auto impl = std::make_unique<PolyImpl>();
+        impl->names = vars;
+        for (const std::string& name : vars) {
+            impl->vars.push_back(giac::gen(giac::identificateur(name)));
+        }
+        impl->p = giac::polynome(static_cast<int>(vars.size()));
+        return impl;
+    }
+
+    size_t var_index(const PolyImpl& p, int32_t var) {
+        if (var < 0 || static_cast<size_t>(var) >= p.names.size()) {
+            throw std::runtime_error("Poly: variable index out of range");
+        }
+        return static_cast<size_t>(var);
+    }
+}
+
+Poly::Poly(const Gen& expr, const std::vector<std::string>& vars) : impl_(poly_impl_for(vars)) {
+    giac::context& ctx = get_thread_local_context();
+    impl_->p = to_polynome(giac::e2r(expr.impl_->g, impl_->vars, &ctx), vars.size());
+    require_coefficients_free_of_vars(*impl_);
+}
+
+Poly::Poly(std::unique_ptr<PolyImpl> impl) : impl_(std::move(impl)) {}
+
+Poly::~Poly() = default;
+
+Poly::Poly(const Poly& other) : impl_(std::make_unique<PolyImpl>(*other.impl_)) {}
+
+Poly& Poly::operator=(const Poly& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<PolyImpl>(*other.impl_);
+    }
+    return *this;
+}
+
+Poly::Poly(Poly&& other) noexcept = default;
+Poly& Poly::operator=(Poly&& other) noexcept = default;
+
+std::vector<std::string> Poly::variables() const {
+    return impl_->names;
+}
+
+int64_t Poly::nterms() const {
+    return static_cast<int64_t>(impl_->p.coord.size());
+}
+
+bool Poly::is_zero() const {
+    return impl_->p.coord.empty();
+}
+
+int64_t Poly::degree(int32_t var) const {
+    size_t j = var_index(*impl_, var);
+    int64_t d = -1;
+    for (const auto& m : impl_->p.coord) {
+        d = std::max<int64_t>(d, m.index[j]);
+    }
+    return d;
+}
+
+int64_t Poly::total_degree() const {
+    int64_t d = -1;
+    for (const auto& m : impl_->p.coord) {
+        int64_t sum = 0;
+        for (giac::deg_t e : m.index) sum += e;
+        d = std::max(d, sum);
+    }
+    return d;
+}
+
+Gen Poly::to_gen() const {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    if (impl_->p.coord.empty()) {
+        return Gen(std::make_unique<GenImpl>(giac::gen(0)));
+    }
+    return Gen(std::make_unique<GenImpl>(giac::r2e(giac::gen(impl_->p), impl_->vars, &ctx)));
+}
+
+std::string Poly::to_string() const {
+    return to_gen().to_string();
+}
+
+Poly Poly::operator+(const Poly& other) const {
+    require_same_vars(*impl_, *other.impl_);
+    return Poly(poly_like(*impl_, impl_->p + other.impl_->p));
+}
+
+Poly Poly::operator-(const Poly& other) const {
+    require_same_vars(*impl_, *other.impl_);
+    return Poly(poly_like(*impl_, impl_->p - other.impl_->p));
+}
+
+Poly Poly::operator*(const Poly& other) const {
+    require_same_vars(*impl_, *other.impl_);
+    return Poly(poly_like(*impl_, impl_->p * other.impl_->p));
+}
+
+Poly Poly::operator-() const {
+    return Poly(poly_like(*impl_, -impl_->p));
+}
+
+Poly Poly::pow(int32_t n) const {
+    if (n < 0) {
+        throw std::runtime_error("Poly::pow: exponent must be non-negative");
+    }
+    giac::polynome result = constant_poly(giac::gen(1), impl_->names.size());
+    giac::polynome base = impl_->p;
+    while (n > 0) {
+        if (n & 1) result = result * base;
+        n >>= 1;
+        if (n > 0) base = base * base;
+    }
+    return Poly(poly_like(*impl_, std::move(result)));
+}
+
+Poly Poly::derivative(int32_t var) const {
+    size_t j = var_index(*impl_, var);
+    giac::polynome d(static_cast<int>(impl_->names.size()));
+    // Dividing every monomial by x_j keeps them in the same order (monomial
+    // orders are compatible with multiplication), so no re-sort is needed
+    for (const auto& m : impl_->p.coord) {
+        giac::deg_t e = m.index[j];
+        if (e == 0) continue;
+        giac::index_t idx(m.index.begin(), m.index.end());
+        --idx[j];
+        d.coord.push_back(giac::monomial<giac::gen>(m.value * giac::gen(static_cast<int>(e)),
+                                                    giac::index_m(idx)));
+    }
+    return Poly(poly_like(*impl_, std::move(d)));
+}
+
+Gen Poly::evaluate(const std::vector<Gen>& values) const {
+    initialize_giac_library();
+    size_t dim = impl_->names.size();
+    if (values.size() != dim) {
+        throw std::runtime_error("Poly::evaluate: need one value per variable");
+    }
+    // Power tables up to each variable's degree, shared by all monomials
+    std::vector<std::vector<giac::gen>> powers(dim);
+    for (size_t k = 0; k < dim; ++k) {
+        powers[k].push_back(giac::gen(1));
+    }
+    giac::gen sum(0);
+    for (const auto& m : impl_->p.coord) {
+        giac::gen term = m.value;
+        for (size_t k = 0; k < dim; ++k) {
+            size_t e = static_cast<size_t>(m.index[k]);
+            std::vector<giac::gen>& pw = powers[k];
+            while (pw.size() <= e) pw.push_back(pw.back() * values[k].impl_->g);
+            if (e > 0) term = term * pw[e];
+        }
+        sum = sum + term;
+    }
+    return Gen(std::make_unique<GenImpl>(sum));
+}
+
+Poly poly_gcd(const Poly& a, const Poly& b) {
+    initialize_giac_library();
+    require_same_vars(*a.impl_, *b.impl_);
+    if (a.impl_->p.coord.empty()) return b;
+    if (b.impl_->p.coord.empty()) return a;
+    return Poly(poly_like(*a.impl_, giac::gcd(a.impl_->p, b.impl_->p)));
+}
+
+PolyFactorization poly_factor(const Poly& p) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    PolyFactorization out;
+    if (p.impl_->p.coord.empty()) {
+        return out;
+    }
+    // giac's factorizer takes an expression; this is the one step that
+    // round-trips through the tree form
+    giac::gen expr = giac::r2e(giac::gen(p.impl_->p), p.impl_->vars, &ctx);
+    giac::gen f = giac::_factors(expr, &ctx);
+    if (f.type != giac::_VECT || f._VECTptr->size() % 2 != 0) {
+        throw std::runtime_error("poly_factor: unexpected result " + f.print(&ctx));
+    }
+    const giac::vecteur& v = *f._VECTptr;
+    size_t dim = p.impl_->names.size();
+    for (size_t i = 0; i < v.size(); i += 2) {
+        auto impl = poly_like(*p.impl_, to_polynome(giac::e2r(v[i], p.impl_->vars, &ctx), dim));
+        out.factors.push_back(Poly(std::move(impl)));
+        out.multiplicities.push_back(v[i + 1].type == giac::_INT_ ? v[i + 1].val : 1);
+    }
+    return out;
+}
+
+
+// ============================================================================
+// Sparse Polynomial Exchange (exponent matrix + coefficients)
+// ============================================================================
+
+namespace {
+    SparsePoly polynome_to_sparse(const giac::polynome& p, size_t dim) {
+        SparsePoly out;
+        out.nvars = static_cast<int64_t>(dim);
+        out.nterms = static_cast<int64_t>(p.coord.size());
+        out.exponents.reserve(p.coord.size() * dim);
+        std::vector<giac::gen> num, den;
+        num.reserve(p.coord.size());
+        den.reserve(p.coord.size());
+        bool integer = true;
+        for (const auto& m : p.coord) {
+            for (giac::deg_t e : m.index) out.exponents.push_back(e);
+            giac::gen n, d;
+            if (!split_rational(m.value, n, d)) {
+                throw std::runtime_error("poly_to_sparse: coefficient is not rational: " +
+                                         m.value.print(&get_thread_local_context()));
+            }
+            integer = integer && d.type == giac::_INT_ && d.val == 1;
+            num.push_back(n);
+            den.push_back(d);
+        }
+        out.num = pack_exact(num);
+        if (!integer) out.den = pack_exact(den);
+        return out;
+    }
+
+    giac::gen exact_gen(const ExactInts& v, size_t i, Mpz& tmp) {
+        if (v.limb_offset.empty()) {
+            return giac::gen(static_cast<long long>(v.values[i]));
+        }
+        read_exact(v, i, tmp.z);
+        return giac::gen(tmp.z);
+    }
+
+    void check_sparse_poly(const SparsePoly& sp) {
+        check_exact_ints(sp.num);
+        check_exact_ints(sp.den);
+        size_t nterms = exact_size(sp.num);
+        if (sp.nterms < 0 || static_cast<size_t>(sp.nterms) != nterms) {
+            throw std::runtime_error("SparsePoly: nterms does not match the coefficients");
+        }
+        if (sp.nvars < 0 || sp.exponents.size() != nterms * static_cast<size_t>(sp.nvars)) {
+            throw std::runtime_error("SparsePoly: exponents must have nterms * nvars entries");
+        }
+        if (exact_size(sp.den) != 0 && exact_size(sp.den) != nterms) {
+            throw std::runtime_error("SparsePoly: den must be empty or have one entry per term");
+        }
+    }
+
+    giac::polynome sparse_to_polynome(const SparsePoly& sp, size_t dim) {
+        check_sparse_poly(sp);
+        if (static_cast<size_t>(sp.nvars) != dim) {
+            throw std::runtime_error("poly_from_sparse: nvars does not match the variable list");
+        }
+        size_t n = static_cast<size_t>(sp.nterms);
+        bool rational = exact_size(sp.den) != 0;
+        giac::polynome p(static_cast<int>(dim));
+        p.coord.reserve(n);
+        Mpz tmp;
+        giac::index_t idx(dim);
+        for (size_t t = 0; t < n; ++t) {
+            giac::gen c = exact_gen(sp.num, t, tmp);
+            if (rational) {
+                giac::gen d = exact_gen(sp.den, t, tmp);
+                if ((d.type == giac::_INT_ ? d.val : mpz_sgn(*d._ZINTptr)) <= 0) {
+                    throw std::runtime_error("SparsePoly: denominators must be positive");
+                }
+                c = c / d;
+            }
+            if (c.type == giac::_INT_ && c.val == 0) continue;
+            for (size_t k = 0; k < dim; ++k) {
+                int32_t e = sp.exponents[t * dim + k];
+                if (e < 0 || e > std::numeric_limits<giac::deg_t>::max()) {
+                    throw std::runtime_error("poly_from_sparse: exponent out of range: " + std::to_string(e));
+                }
+                idx[k] = static_cast<giac::deg_t>(e);
+            }
+            p.coord.push_back(giac::monomial<giac::gen>(c, giac::index_m(idx)));
+        }
+        // Sort into giac's monomial order, then merge repeated exponents
+        p.tsort();
+        size_t w = 0;
+        for (size_t r = 0; r < p.coord.size(); ++r) {
+            if (w > 0 && p.coord[w - 1].index == p.coord[r].index) {
+                p.coord[w - 1].value = p.coord[w - 1].value + p.coord[r].value;
+            } else {
+                p.coord[w++] = p.coord[r];
+            }
+        }
+        p.coord.resize(w);
+        p.coord.erase(std::remove_if(p.coord.begin(), p.coord.end(),
+                                     [](const giac::monomial<giac::gen>& m) {
+                                         return m.value.type == giac::_INT_ && m.value.val == 0;
+                                     }),
+                      p.coord.end());
+        return p;
+    }
+}
+
+SparsePoly make_sparse_poly(int64_t nvars, const std::vector<int32_t>& exponents,
+                            const ExactInts& num, const ExactInts& den) {
+    SparsePoly sp;
+    sp.nvars = nvars;
+    sp.nterms = static_cast<int64_t>(exact_size(num));
+    sp.exponents = exponents;
+    sp.num = num;
+    sp.den = den;
+    check_sparse_poly(sp);
+    return sp;
+}
+
+SparsePoly poly_to_sparse(const Gen& expr, const std::vector<std::string>& vars) {
+    return poly_to_sparse(Poly(expr, vars));
+}
+
+SparsePoly poly_to_sparse(const Poly& p) {
+    return polynome_to_sparse(p.impl_->p, p.impl_->names.size());
+}
+
+Gen poly_from_sparse(const SparsePoly& sp, const std::vector<std::string>& vars) {
+    return sparse_to_poly(sp, vars).to_gen();
+}
+
+Poly sparse_to_poly(const SparsePoly& sp, const std::vector<std::string>& vars) {
+    auto impl = poly_impl_for(vars);
+    impl->p = sparse_to_polynome(sp, vars.size());
+    return Poly(std::move(impl));
+}
+
+
+// ============================================================================
+// Groebner Bases
+// ============================================================================
+
+namespace {
+    // giac::threads is process-wide; groebner holds this lock while it
+    // carries the caller's thread count. proba_epsilon belongs to the
+    // calling thread's context and needs no lock.
+    std::mutex groebner_mutex;
+
+    // Install thread count and check mode for one call, restore on exit.
+    // The thread count is only written when it differs from giac's, so
+    // calls that keep it leave other giac work untouched.
+    class GroebnerSettings {
+    public:
+        GroebnerSettings(int threads, bool certify, giac::context& ctx)
+            : ctx_(ctx), threads_(giac::threads), epsilon_(giac::proba_epsilon(&ctx)) {
+            if (threads != threads_) giac::threads = threads;
+            if (certify) giac::proba_epsilon(&ctx) = 0;
+        }
+        ~GroebnerSettings() {
+            if (giac::threads != threads_) giac::threads = threads_;
+            giac::proba_epsilon(&ctx_) = epsilon_;
+        }
+        GroebnerSettings(const GroebnerSettings&) = delete;
+        GroebnerSettings& operator=(const GroebnerSettings&) = delete;
+
+    private:
+        giac::context& ctx_;
+        int threads_;
+        double epsilon_;
+    };
+
+    // giac's order codes, tagged the way its parser tags the keywords
+    giac::gen groebner_order(int32_t order) {
+        int code;
+        switch (order) {
+            case GROEBNER_REVLEX: code = giac::_REVLEX_ORDER; break;
+            case GROEBNER_PLEX: code = giac::_PLEX_ORDER; break;
+            case GROEBNER_TDEG: code = giac::_TDEG_ORDER; break;
+            default:
+                throw std::runtime_error("groebner: unknown monomial order " + std::to_string(order));
+        }
+        giac::gen g(code);
+        g.subtype = giac::_INT_GROEBNER;
+        return g;
+    }
+
+    bool is_prime_int64(int64_t n) {
+        if (n < 2) return false;
+        Mpz z;
+        set_mpz_int64(z.z, n);
+        // Deterministic (Baillie-PSW) below 2^64
+        return mpz_probab_prime_p(z.z, 25) != 0;
+    }
+
+    void report(const GroebnerOptions& options, int32_t stage, int64_t done, int64_t total) {
+        if (options.progress) {
+            options.progress(stage, done, total, options.progress_data);
+        }
+    }
+
+    // Rational coefficients -> symmetric residues mod p, dropping terms
+    // that vanish; giac's modular environment works on plain integers
+    void reduce_coefficients(giac::polynome& p, const giac::gen& modulus, giac::context& ctx) {
+        size_t w = 0;
+        for (size_t r = 0; r < p.coord.size(); ++r) {
+            giac::gen n, d;
+            split_rational(p.coord[r].value, n, d);
+            if (giac::is_zero(giac::smod(d, modulus), &ctx)) {
+                throw std::runtime_error("groebner: a coefficient denominator is divisible by the modulus");
+            }
+            giac::gen c = giac::smod(n * giac::invmod(d, modulus), modulus);
+            if (giac::is_zero(c, &ctx)) continue;
+            p.coord[w] = p.coord[r];
+            p.coord[w++].value = c;
+        }
+        p.coord.resize(w);
+    }
+
+    // Back from a degree order to giac's default lex term order, the order
+    // poly_to_sparse exports; the polynomial is only read afterwards
+    void sort_lex(giac::polynome& p) {
+        std::sort(p.coord.begin(), p.coord.end(),
+                  [](const giac::monomial<giac::gen>& a, const giac::monomial<giac::gen>& b) {
+                      return giac::i_lex_is_strictly_greater(a.index, b.index);
+                  });
+    }
+
+    // Residues mod p -> integers in [0, p)
+    void lift_coefficients(giac::polynome& p, int64_t modulus) {
+        Mpz m, r;
+        set_mpz_int64(m.z, modulus);
+        for (auto& mono : p.coord) {
+            const giac::gen& v = mono.value.type == giac::_MOD ? *mono.value._MODptr : mono.value;
+            int64_t x;
+            if (v.type == giac::_INT_) {
+                x = v.val;
+            } else if (v.type == giac::_ZINT) {
+                // mpz_fdiv_ui takes an unsigned long, 32 bits on Windows
+                mpz_fdiv_r(r.z, *v._ZINTptr, m.z);
+                uint64_t u = 0;
+                mpz_export(&u, nullptr, -1, sizeof(uint64_t), 0, 0, r.z);
+                x = static_cast<int64_t>(u);
+            } else {
+                throw std::runtime_error("groebner: unexpected coefficient " +
+                                         mono.value.print(&get_thread_local_context()));
+            }
+            x %= modulus;
+            if (x < 0) x += modulus;
+            mono.value = giac::gen(static_cast<long long>(x));
+        }
+    }
+}
+
+GroebnerOptions make_groebner_options(int32_t num_threads, int64_t modulus, bool certify) {
+    GroebnerOptions options;
+    options.num_threads = num_threads;
+    options.modulus = modulus;
+    options.certify = certify;
+    return options;
+}
+
+std::vector<SparsePoly> groebner(const std::vector<SparsePoly>& polys,
+                                 const std::vector<std::string>& vars,
+                                 int32_t order, const GroebnerOptions& options) {
+    giac::gen order_gen = groebner_order(order);
+    if (options.modulus != 0 && !is_prime_int64(options.modulus)) {
+        throw std::runtime_error("groebner: modulus must be 0 or a prime");
+    }
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    size_t dim = vars.size();
+    giac::gen modulus(static_cast<long long>(options.modulus));
+
+    // Generators are built straight from the buffers and handed to giac's
+    // polynomial-level gbasis; zero generators do not change the ideal.
+    // sparse_to_polynome sorts in lex order, so each generator is re-sorted
+    // in the requested order first, as giac's gbasis command does.
+    bool lex = order == GROEBNER_PLEX;
+    giac::vectpoly gens;
+    gens.reserve(polys.size());
+    int64_t total = static_cast<int64_t>(polys.size());
+    for (int64_t k = 0; k < total; ++k) {
+        giac::polynome p = sparse_to_polynome(polys[k], dim);
+        if (options.modulus != 0) {
+            reduce_coefficients(p, modulus, ctx);
+        }
+        if (!p.coord.empty()) {
+            if (!lex) giac::change_monomial_order(p, order_gen);
+            gens.push_back(std::move(p));
+        }
+        report(options, GROEBNER_STAGE_INPUT, k + 1, total);
+    }
+    if (gens.empty()) {
+        return {};
+    }
+
+    giac::vectpoly basis;
+    {
+        std::lock_guard<std::mutex> lock(groebner_mutex);
+        GroebnerSettings settings(static_cast<int>(WorkerPool::resolve_threads(options.num_threads)),
+                                  options.certify, ctx);
+        report(options, GROEBNER_STAGE_COMPUTE, 0, 1);
+        giac::environment env;
+        env.moduloon = options.modulus != 0;
+        env.modulo = modulus;
+        env.pn = modulus;
+        env.complexe = false;
+        // Same defaults as giac's gbasis command; over Q the multimodular
+        // algorithm is requested
+        giac::gbasis_param_t param = {true, 0, false};
+        basis = giac::gbasis(gens, order_gen, false, options.modulus == 0 ? 1 : 0, &env, &ctx, param);
+        report(options, GROEBNER_STAGE_COMPUTE, 1, 1);
+    }
+
+    std::vector<SparsePoly> out;
+    out.reserve(basis.size());
+    total = static_cast<int64_t>(basis.size());
+    for (int64_t k = 0; k < total; ++k) {
+        if (options.modulus != 0) {
+            lift_coefficients(basis[k], options.modulus);
+        }
+        if (!lex) sort_lex(basis[k]);
+        out.push_back(polynome_to_sparse(basis[k], dim));
+        report(options, GROEBNER_STAGE_OUTPUT, k + 1, total);
+    }
+    return out;
+}
+
+
+// ============================================================================
+// Batch Polynomial Roots
+// ============================================================================
+
+namespace {
+    void check_root_offsets(const std::vector<int64_t>& offsets, size_t ncoeffs) {
+        if (offsets.empty() || offsets.front() != 0 ||
+            static_cast<size_t>(offsets.back()) != ncoeffs) {
+            throw std::runtime_error("proot_batch: offsets must run from 0 to the number of coefficients");
+        }
+        for (size_t k = 1; k < offsets.size(); ++k) {
+            if (offsets[k] < offsets[k - 1]) {
+                throw std::runtime_error("proot_batch: offsets must be nondecreasing");
+            }
+        }
+    }
+
+    double root_part(const giac::gen& x, giac::context& ctx) {
+        giac::gen d = giac::evalf_double(x, 1, &ctx);
+        if (d.type == giac::_DOUBLE_) return d._DOUBLE_val;
+        if (d.type == giac::_INT_) return d.val;
+        throw std::runtime_error("proot: non-numeric root " + x.print(&ctx));
+    }
+
+    // Roots of one polynomial (coefficients highest degree first) appended
+    // to out as (re, im) pairs; above 15 digits the giac values are kept in
+    // mp as well. The zero polynomial is rejected, since every point is a
+    // root of it.
+    int32_t proot_one(giac::vecteur coeffs, int32_t digits, std::vector<double>& out,
+                      giac::vecteur& mp, giac::context& ctx) {
+        size_t lead = 0;
+        while (lead < coeffs.size() && giac::is_zero(coeffs[lead], &ctx)) ++lead;
+        if (lead == coeffs.size()) return GIAC_STATUS_INVALID_ARGUMENT;
+        coeffs.erase(coeffs.begin(), coeffs.begin() + lead);
+        if (coeffs.size() < 2) return GIAC_STATUS_OK;
+        bool multiprecision = digits > 15;
+        giac::gen arg = multiprecision ? giac::makesequence(giac::gen(coeffs), giac::gen(digits))
+                                       : giac::gen(coeffs);
+        giac::gen r = giac::_proot(arg, &ctx);
+        if (r.type != giac::_VECT) {
+            throw std::runtime_error("proot: unexpected result " + r.print(&ctx));
+        }
+        out.reserve(2 * r._VECTptr->size());
+        for (const auto& z : *r._VECTptr) {
+            out.push_back(root_part(giac::_re(z, &ctx), ctx));
+            out.push_back(root_part(giac::_im(z, &ctx), ctx));
+        }
+        if (multiprecision) mp = *r._VECTptr;
+        return GIAC_STATUS_OK;
+    }
+
+    // Shared driver: coeff(i, c) builds the i-th coefficient on the worker
+    // thread, so no giac node is shared between threads, and returns false
+    // for a coefficient that is not a finite number
+    template <class Coeff>
+    RootBatch run_proot_batch(const std::vector<int64_t>& offsets, int32_t digits,
+                              int32_t num_threads, Coeff coeff, giac::vecteur& mp_roots) {
+        initialize_giac_library();
+        size_t npolys = offsets.size() - 1;
+        std::vector<std::vector<double>> roots(npolys);
+        std::vector<giac::vecteur> mp(npolys);
+        bool parallel = npolys > 1 && WorkerPool::resolve_threads(num_threads) > 1;
+        RootBatch out;
+        out.status.assign(npolys, GIAC_STATUS_OK);
+        WorkerPool::instance().run(npolys, num_threads, [&](size_t k) {
+            giac::context& ctx = get_thread_local_context();
+            try {
+                giac::vecteur v;
+                v.reserve(static_cast<size_t>(offsets[k + 1] - offsets[k]));
+                for (int64_t i = offsets[k]; i < offsets[k + 1]; ++i) {
+                    v.push_back(giac::gen(0));
+                    if (!coeff(static_cast<size_t>(i), v.back())) {
+                        out.status[k] = GIAC_STATUS_INVALID_ARGUMENT;
+                        return;
+                    }
+                }
+                giac::vecteur found;
+                out.status[k] = proot_one(std::move(v), digits, roots[k], found, ctx);
+                if (parallel && !found.empty()) {
+                    // Handed back to the caller, so copied off this thread
+                    std::unordered_map<const char*, giac::gen> idents;
+                    for (auto& z : found) z = thread_private_copy(z, idents);
+                }
+                mp[k] = std::move(found);
+            } catch (const std::exception&) {
+                roots[k].clear();
+                mp[k].clear();
+                out.status[k] = GIAC_STATUS_EVAL_ERROR;
+            }
+        });
+
+        out.offsets.reserve(npolys + 1);
+        out.offsets.push_back(0);
+        size_t total = 0;
+        for (const auto& r : roots) total += r.size();
+        out.roots.reserve(total);
+        if (digits > 15) mp_roots.reserve(total / 2);
+        for (size_t k = 0; k < npolys; ++k) {
+            out.roots.insert(out.roots.end(), roots[k].begin(), roots[k].end());
+            out.offsets.push_back(static_cast<int64_t>(out.roots.size() / 2));
+            for (auto& z : mp[k]) mp_roots.push_back(std::move(z));
+            if (out.status[k] != GIAC_STATUS_OK) ++out.error_count;
+        }
+        return out;
+    }
+}
+
+RootBatch proot_batch(const std::vector<double>& coeffs, const std::vector<int64_t>& offsets,
+                      int32_t digits, int32_t num_threads) {
+    check_root_offsets(offsets, coeffs.size());
+    giac::vecteur mp;
+    RootBatch out = run_proot_batch(offsets, digits, num_threads, [&](size_t i, giac::gen& c) {
+        if (!std::isfinite(coeffs[i])) return false;
+        c = giac::gen(coeffs[i]);
+        return true;
+    }, mp);
+    out.mp_roots.reserve(mp.size());
+    for (auto& z : mp) out.mp_roots.push_back(Gen(std::make_unique<GenImpl>(std::move(z))));
+    return out;
+}
+
+RootBatch proot_batch(const ExactInts& coeffs, const std::vector<int64_t>& offsets,
+                      int32_t digits, int32_t num_threads) {
+    check_exact_ints(coeffs);
+    check_root_offsets(offsets, exact_size(coeffs));
+    giac::vecteur mp;
+    RootBatch out = run_proot_batch(offsets, digits, num_threads, [&](size_t i, giac::gen& c) {
+        thread_local Mpz tmp;
+        c = exact_gen(coeffs, i, tmp);
+        return true;
+    }, mp);
+    out.mp_roots.reserve(mp.size());
+    for (auto& z : mp) out.mp_roots.push_back(Gen(std::make_unique<GenImpl>(std::move(z))));
+    return out;
+}
+
+
+// ============================================================================
+// Multipoint Substitution
+// ============================================================================
+
+namespace {
+    // Below this many points per thread the pool overhead outweighs the gain
+    constexpr size_t kSubstRowsPerThread = 16;
+
+    // One step of a substitution tape. Steps are in post-order, so every
+    // argument slot is filled before the step that reads it.
+    struct SubstStep {
+        enum Kind : uint8_t { CONST, VAR, CALL, VECT, FALLBACK };
+        Kind kind = CONST;
+        giac::gen value;                              // CONST: value; FALLBACK: subtree
+        const giac::unary_function_ptr* f = nullptr;  // CALL: operator, owned by SubstTape::expr
+        int32_t var = -1;                             // VAR: column
+        bool seq = false;                             // CALL: arguments form a sequence
+        signed char subtype = 0;                      // VECT: vector subtype
+        std::vector<int32_t> args;                    // CALL / VECT: argument slots
+    };
+
+    struct SubstTape {
+        giac::gen expr;           // keeps the operators referenced by CALL steps alive
+        giac::vecteur vars;
+        std::vector<SubstStep> steps;
+    };
+
+    bool mentions_var(const giac::gen& g, const std::unordered_map<const char*, int32_t>& var_of) {
+        bool found = false;
+        walk_tree(g, [&](const giac::gen& node, int32_t) {
+            if (node.type == giac::_IDNT && var_of.count(node._IDNTptr->id_name)) {
+                found = true;
+            }
+            return !found;
+        });
+        return found;
+    }
+
+    SubstTape compile_subst(const giac::gen& expr, const std::vector<std::string>& names,
+                            giac::context& ctx) {
+        SubstTape tape;
+        tape.expr = expr;
+        std::unordered_map<const char*, int32_t> var_of;
+        for (size_t k = 0; k < names.size(); ++k) {
+            giac::gen id(giac::identificateur(names[k]));
+            tape.vars.push_back(id);
+            var_of.emplace(id._IDNTptr->id_name, static_cast<int32_t>(k));
+        }
+
+        auto push = [&tape](SubstStep step) {
+            tape.steps.push_back(std::move(step));
+            return static_cast<int32_t>(tape.steps.size() - 1);
+        };
+        auto constant = [&](const giac::gen& g) {
+            SubstStep step;
+            step.value = giac::eval(g, 1, &ctx);
+            return push(std::move(step));
+        };
+
+        // Explicit-stack post-order walk; `slots` holds the finished
+        // children of the frames still open. Shared composite nodes are
+        // compiled once.
+        struct Frame { const giac::gen* node; bool open; };
+        std::vector<Frame> stack{{&tape.expr, false}};
+        std::vector<int32_t> slots;
+        std::unordered_map<const void*, int32_t> shared;
+
+        auto elements = [](const giac::vecteur& v) -> std::pair<const giac::gen*, size_t> {
+            return {v.empty() ? nullptr : &v[0], v.size()};
+        };
+        auto children = [&elements](const giac::gen& g) -> std::pair<const giac::gen*, size_t> {
+            if (g.type == giac::_VECT) {
+                return elements(*g._VECTptr);
+            }
+            const giac::gen& f = g._SYMBptr->feuille;
+            if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+                return elements(*f._VECTptr);
+            }
+            return {&f, 1};
+        };
+        auto key = [](const giac::gen& g) -> const void* {
+            return g.type == giac::_SYMB ? static_cast<const void*>(g._SYMBptr)
+                                         : static_cast<const void*>(g._VECTptr);
+        };
+
+        while (!stack.empty()) {
+            Frame frame = stack.back();
+            stack.pop_back();
+            const giac::gen& g = *frame.node;
+            bool composite = g.type == giac::_SYMB || g.type == giac::_VECT;
+
+            if (!frame.open) {
+                if (g.type == giac::_IDNT && var_of.count(g._IDNTptr->id_name)) {
+                    SubstStep step;
+                    step.kind = SubstStep::VAR;
+                    step.var = var_of[g._IDNTptr->id_name];
+                    slots.push_back(push(std::move(step)));
+                } else if (composite && shared.count(key(g))) {
+                    slots.push_back(shared[key(g)]);
+                } else if (!composite) {
+                    if (mentions_var(g, var_of)) {
+                        SubstStep step;
+                        step.kind = SubstStep::FALLBACK;
+                        step.value = g;
+                        slots.push_back(push(std::move(step)));
+                    } else {
+                        slots.push_back(constant(g));
+                    }
+                } else if (g.type == giac::_SYMB && g._SYMBptr->sommet.quoted()) {
+                    // Quoted operators evaluate their own arguments
+                    int32_t slot;
+                    if (mentions_var(g, var_of)) {
+                        SubstStep step;
+                        step.kind = SubstStep::FALLBACK;
+                        step.value = g;
+                        slot = push(std::move(step));
+                    } else {
+                        slot = constant(g);
+                    }
+                    shared.emplace(key(g), slot);
+                    slots.push_back(slot);
+                } else {
+                    stack.push_back({frame.node, true});
+                    auto kids = children(g);
+                    for (size_t k = kids.second; k-- > 0;) {
+                        stack.push_back({kids.first + k, false});
+                    }
+                }
+                continue;
+            }
+
+            auto kids = children(g);
+            SubstStep step;
+            step.args.assign(slots.end() - kids.second, slots.end());
+            slots.resize(slots.size() - kids.second);
+            bool folds = true;
+            for (int32_t a : step.args) {
+                folds = folds && tape.steps[a].kind == SubstStep::CONST;
+            }
+            int32_t slot;
+            if (folds) {
+                slot = constant(g);
+            } else {
+                if (g.type == giac::_VECT) {
+                    step.kind = SubstStep::VECT;
+                    step.subtype = g.subtype;
+                } else {
+                    step.kind = SubstStep::CALL;
+                    step.f = &g._SYMBptr->sommet;
+                    const giac::gen& f = g._SYMBptr->feuille;
+                    step.seq = f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT;
+                }
+                slot = push(std::move(step));
+            }
+            shared.emplace(key(g), slot);
+            slots.push_back(slot);
+        }
+
+        // Drop the steps that only fed folded constants
+        int32_t root = slots.back();
+        std::vector<char> live(tape.steps.size(), 0);
+        live[root] = 1;
+        for (int32_t k = root; k >= 0; --k) {
+            if (!live[k]) continue;
+            for (int32_t a : tape.steps[k].args) live[a] = 1;
+        }
+        std::vector<int32_t> remap(tape.steps.size(), -1);
+        std::vector<SubstStep> kept;
+        for (size_t k = 0; k <= static_cast<size_t>(root); ++k) {
+            if (!live[k]) continue;
+            for (int32_t& a : tape.steps[k].args) a = remap[a];
+            remap[k] = static_cast<int32_t>(kept.size());
+            kept.push_back(std::move(tape.steps[k]));
+        }
+        tape.steps = std::move(kept);
+        return tape;
+    }
+
+    // Copy of the tape whose gens belong to the calling thread alone; the
+    // operator pointers still refer to the original expression, which is
+    // only read
+    SubstTape private_tape(const SubstTape& tape) {
+        std::unordered_map<const char*, giac::gen> idents;
+        SubstTape out;
+        out.steps = tape.steps;
+        for (auto& step : out.steps) {
+            step.value = thread_private_copy(step.value, idents);
+        }
+        for (const auto& v : tape.vars) {
+            out.vars.push_back(thread_private_copy(v, idents));
+        }
+        return out;
+    }
+
+    giac::gen run_subst(const SubstTape& tape, const giac::gen* row,
+                        std::vector<giac::gen>& slot, giac::context& ctx) {
+        slot.resize(tape.steps.size());
+        for (size_t k = 0; k < tape.steps.size(); ++k) {
+            const SubstStep& step = tape.steps[k];
+            switch (step.kind) {
+                case SubstStep::CONST:
+                    slot[k] = step.value;
+                    break;
+                case SubstStep::VAR:
+                    slot[k] = row[step.var];
+                    break;
+                case SubstStep::FALLBACK: {
+                    giac::vecteur values;
+                    values.reserve(tape.vars.size());
+                    for (size_t j = 0; j < tape.vars.size(); ++j) values.push_back(row[j]);
+                    slot[k] = giac::eval(giac::subst(step.value, giac::gen(tape.vars),
+                                                     giac::gen(values), false, &ctx), 1, &ctx);
+                    break;
+                }
+                case SubstStep::VECT: {
+                    giac::vecteur v;
+                    v.reserve(step.args.size());
+                    for (int32_t a : step.args) v.push_back(slot[a]);
+                    slot[k] = giac::gen(v, step.subtype);
+                    break;
+                }
+                case SubstStep::CALL: {
+                    const giac::unary_function_ptr& f = *step.f;
+                    const auto& a = step.args;
+                    if (step.seq && f == giac::at_plus) {
+                        giac::gen acc = slot[a[0]];
+                        for (size_t j = 1; j < a.size(); ++j) acc = acc + slot[a[j]];
+                        slot[k] = acc;
+                    } else if (step.seq && f == giac::at_prod) {
+                        giac::gen acc = slot[a[0]];
+                        for (size_t j = 1; j < a.size(); ++j) acc = acc * slot[a[j]];
+                        slot[k] = acc;
+                    } else if (!step.seq && f == giac::at_neg) {
+                        slot[k] = -slot[a[0]];
+                    } else if (!step.seq && f == giac::at_inv) {
+                        slot[k] = giac::gen(1) / slot[a[0]];
+                    } else if (step.seq && a.size() == 2 && f == giac::at_pow) {
+                        slot[k] = giac::pow(slot[a[0]], slot[a[1]], &ctx);
+                    } else if (step.seq) {
+                        giac::vecteur v;
+                        v.reserve(a.size());
+                        for (int32_t j : a) v.push_back(slot[j]);
+                        slot[k] = f(giac::gen(v, giac::_SEQ__VECT), &ctx);
+                    } else {
+                        slot[k] = f(slot[a[0]], &ctx);
+                    }
+                    break;
+                }
+            }
+        }
+        giac::gen result = slot.back();
+        slot.clear();
+        return result;
+    }
+
+    // Rows per worker slice in subst_rows; npoints when it runs serially
+    size_t subst_chunk(size_t npoints, int32_t num_threads) {
+        size_t threads = std::min(WorkerPool::resolve_threads(num_threads),
+                                  npoints / kSubstRowsPerThread);
+        return threads <= 1 ? npoints : (npoints + threads - 1) / threads;
+    }
+
+    // Evaluate the tape for rows [0, npoints). row_values(r, out) fills the
+    // row on the worker thread; the row storage passed in is reused.
+    template <class RowValues>
+    std::vector<giac::gen> subst_rows(const SubstTape& tape, size_t npoints, int32_t num_threads,
+                                      RowValues row_values) {
+        std::vector<giac::gen> results(npoints);
+        size_t chunk = subst_chunk(npoints, num_threads);
+        if (chunk >= npoints) {
+            giac::context& ctx = get_thread_local_context();
+            std::vector<giac::gen> row(tape.vars.size()), slot;
+            for (size_t r = 0; r < npoints; ++r) {
+                row_values(r, row);
+                results[r] = run_subst(tape, row.data(), slot, ctx);
+            }
+            return results;
+        }
+
+        size_t n_slices = (npoints + chunk - 1) / chunk;
+        std::vector<SubstTape> tapes;
+        tapes.reserve(n_slices);
+        for (size_t t = 0; t < n_slices; ++t) tapes.push_back(private_tape(tape));
+        WorkerPool::instance().run(n_slices, num_threads, [&](size_t t) {
+            giac::context& ctx = get_thread_local_context();
+            std::vector<giac::gen> row(tape.vars.size()), slot;
+            size_t end = std::min(npoints, (t + 1) * chunk);
+            for (size_t r = t * chunk; r < end; ++r) {
+                row_values(r, row);
+                results[r] = run_subst(tapes[t], row.data(), slot, ctx);
+            }
+            tapes[t] = SubstTape();
+        });
+        return results;
+    }
+}
+
+std::vector<Gen> subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                            const std::vector<Gen>& values, int32_t num_threads) {
+    initialize_giac_library();
+    size_t nvars = vars.size();
+    if (nvars == 0 ? !values.empty() : values.size() % nvars != 0) {
+        throw std::runtime_error("subst_many: values must have npoints * vars.size() entries");
+    }
+    size_t npoints = nvars == 0 ? 0 : values.size() / nvars;
+    giac::context& ctx = get_thread_local_context();
+    SubstTape tape = compile_subst(expr.impl_->g, vars, ctx);
+
+    // Values are detached on this thread before workers see them, with one
+    // identifier map per slice so that no two workers share a node
+    std::vector<giac::gen> cells;
+    cells.reserve(values.size());
+    size_t slice_cells = subst_chunk(npoints, num_threads) * nvars;
+    bool parallel = slice_cells < values.size();
+    std::unordered_map<const char*, giac::gen> idents;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const giac::gen& v = values[i].impl_->g;
+        if (!parallel) {
+            cells.push_back(v);
+            continue;
+        }
+        if (i % slice_cells == 0) idents.clear();
+        cells.push_back(thread_private_copy(v, idents));
+    }
+
+    std::vector<giac::gen> results = subst_rows(tape, npoints, num_threads,
+        [&](size_t r, std::vector<giac::gen>& row) {
+            for (size_t k = 0; k < nvars; ++k) row[k] = cells[r * nvars + k];
+        });
+    std::vector<Gen> out;
+    out.reserve(results.size());
+    for (auto& g : results) out.push_back(Gen(std::make_unique<GenImpl>(std::move(g))));
+    return out;
+}
+
+ExactMatrix subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                       const ExactMatrix& values, int32_t num_threads) {
+    check_exact_matrix(values, "subst_many");
+    if (static_cast<size_t>(values.cols) != vars.size()) {
+        throw std::runtime_error("subst_many: values must have one column per variable");
+    }
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    SubstTape tape = compile_subst(expr.impl_->g, vars, ctx);
+    size_t nvars = vars.size();
+    bool rational = exact_size(values.den) != 0;
+
+    std::vector<giac::gen> results = subst_rows(tape, static_cast<size_t>(values.rows), num_threads,
+        [&](size_t r, std::vector<giac::gen>& row) {
+            thread_local Mpz tmp;
+            for (size_t k = 0; k < nvars; ++k) {
+                size_t i = r * nvars + k;
+                row[k] = exact_gen(values.num, i, tmp);
+                if (rational) row[k] = row[k] / exact_gen(values.den, i, tmp);
+            }
+        });
+    giac::vecteur column;
+    column.reserve(results.size());
+    for (auto& g : results) {
+        giac::vecteur cell;
+        cell.push_back(std::move(g));
+        column.push_back(giac::gen(cell));
+    }
+    return unpack_exact(giac::gen(column), values.rows, 1, "subst_many");
+}
+
+
+// ============================================================================
+// Compiled Numeric Evaluation
+// ============================================================================
+
+namespace {
+    enum TapeOp : uint8_t {
+        OP_CONST, OP_INPUT,
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_NEG, OP_INV, OP_POW, OP_POWI,
+        OP_SQRT, OP_EXP, OP_LN, OP_LOG10,
+        OP_SIN, OP_COS, OP_TAN, OP_ASIN, OP_ACOS, OP_ATAN,
+        OP_SINH, OP_COSH, OP_TANH, OP_ASINH, OP_ACOSH, OP_ATANH,
+        OP_ABS, OP_SIGN, OP_FLOOR, OP_CEIL, OP_MIN, OP_MAX,
+        OP_RE, OP_IM, OP_CONJ, OP_ARG,
+    };
+
+    // One SSA instruction: register i holds the value of code[i]. a and b
+    // are argument registers (OP_INPUT: a is the input index); c is the
+    // constant of OP_CONST and the integer exponent of OP_POWI; ci is the
+    // imaginary part of a complex-mode OP_CONST. An OP_CONST with
+    // b == kRoundedConst was rounded from an exact or symbolic value; in
+    // real mode its a indexes the enclosure that interval evaluation uses
+    // in place of c.
+    struct TapeInstr {
+        TapeOp op;
+        int32_t a;
+        int32_t b;
+        double c;
+        double ci;
+    };
+
+    constexpr int32_t kRoundedConst = 1;
+
+    template <class T>
+    T powi(T x, int64_t n) {
+        uint64_t m = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+        T r(1.0);
+        while (m != 0) {
+            if (m & 1) r *= x;
+            x *= x;
+            m >>= 1;
+        }
+        return n < 0 ? T(1.0) / r : r;
+    }
+
+    void run_tape(const std::vector<TapeInstr>& code, const double* x, double* r) {
+        const size_t n = code.size();
+        for (size_t i = 0; i < n; ++i) {
+            const TapeInstr& in = code[i];
+            switch (in.op) {
+                case OP_CONST: r[i] = in.c; break;
+                case OP_INPUT: r[i] = x[in.a]; break;
+                case OP_ADD:   r[i] = r[in.a] + r[in.b]; break;
+                case OP_SUB:   r[i] = r[in.a] - r[in.b]; break;
+                case OP_MUL:   r[i] = r[in.a] * r[in.b]; break;
+                case OP_DIV:   r[i] = r[in.a] / r[in.b]; break;
+                case OP_NEG:   r[i] = -r[in.a]; break;
+                case OP_INV:   r[i] = 1.0 / r[in.a]; break;
+                case OP_POW:   r[i] = std::pow(r[in.a], r[in.b]); break;
+                case OP_POWI:  r[i] = powi(r[in.a], static_cast<int64_t>(in.c)); break;
+                case OP_SQRT:  r[i] = std::sqrt(r[in.a]); break;
+                case OP_EXP:   r[i] = std::exp(r[in.a]); break;
+                case OP_LN:    r[i] = std::log(r[in.a]); break;
+                case OP_LOG10: r[i] = std::log10(r[in.a]); break;
+                case OP_SIN:   r[i] = std::sin(r[in.a]); break;
+                case OP_COS:   r[i] = std::cos(r[in.a]); break;
+                case OP_TAN:   r[i] = std::tan(r[in.a]); break;
+                case OP_ASIN:  r[i] = std::asin(r[in.a]); break;
+                case OP_ACOS:  r[i] = std::acos(r[in.a]); break;
+                case OP_ATAN:  r[i] = std::atan(r[in.a]); break;
+                case OP_SINH:  r[i] = std::sinh(r[in.a]); break;
+                case OP_COSH:  r[i] = std::cosh(r[in.a]); break;
+                case OP_TANH:  r[i] = std::tanh(r[in.a]); break;
+                case OP_ASINH: r[i] = std::asinh(r[in.a]); break;
+                case OP_ACOSH: r[i] = std::acosh(r[in.a]); break;
+                case OP_ATANH: r[i] = std::atanh(r[in.a]); break;
+                case OP_ABS:   r[i] = std::fabs(r[in.a]); break;
+                case OP_SIGN:  r[i] = (r[in.a] > 0) - (r[in.a] < 0); break;
+                case OP_FLOOR: r[i] = std::floor(r[in.a]); break;
+                case OP_CEIL:  r[i] = std::ceil(r[in.a]); break;
+                case OP_MIN:   r[i] = std::fmin(r[in.a], r[in.b]); break;
+                case OP_MAX:   r[i] = std::fmax(r[in.a], r[in.b]); break;
+                case OP_RE:    r[i] = r[in.a]; break;
+                case OP_IM:    r[i] = 0.0; break;
+                case OP_CONJ:  r[i] = r[in.a]; break;
+                case OP_ARG:
+                    r[i] = std::isnan(r[in.a]) ? r[in.a] : r[in.a] < 0 ? 4.0 * std::atan(1.0) : 0.0;
+                    break;
+            }
+        }
+    }
+
+    using Complex = std::complex<double>;
+
+    // giac puts the cuts of ln and sqrt on the negative real axis, with
+    // values taken from above; a negative zero imaginary part would send
+    // std::log and std::sqrt to the lower side
+    Complex on_cut(const Complex& z) {
+        return z.imag() == 0 ? Complex(z.real(), 0.0) : z;
+    }
+
+    // Same tape in complex arithmetic; x and r are complex registers
+    void run_complex_tape(const std::vector<TapeInstr>& code, const Complex* x, Complex* r) {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        const size_t n = code.size();
+        for (size_t i = 0; i < n; ++i) {
+            const TapeInstr& in = code[i];
+            if (in.op == OP_CONST) {
+                r[i] = Complex(in.c, in.ci);
+                continue;
+            }
+            if (in.op == OP_INPUT) {
+                r[i] = x[in.a];
+                continue;
+            }
+            const Complex& u = r[in.a];
+            switch (in.op) {
+                case OP_CONST:
+                case OP_INPUT:
+                    break;
+                case OP_ADD:   r[i] = u + r[in.b]; break;
+                case OP_SUB:   r[i] = u - r[in.b]; break;
+                case OP_MUL:   r[i] = u * r[in.b]; break;
+                case OP_DIV:   r[i] = u / r[in.b]; break;
+                case OP_NEG:   r[i] = -u; break;
+                case OP_INV:   r[i] = 1.0 / u; break;
+                case OP_POW:
+                    r[i] = u == 0.0 && r[in.b].real() > 0 ? Complex(0.0) : std::pow(on_cut(u), r[in.b]);
+                    break;
+                case OP_POWI:  r[i] = powi(u, static_cast<int64_t>(in.c)); break;
+                case OP_SQRT:  r[i] = std::sqrt(on_cut(u)); break;
+                case OP_EXP:   r[i] = std::exp(u); break;
+                case OP_LN:    r[i] = std::log(on_cut(u)); break;
+                case OP_LOG10: r[i] = std::log10(on_cut(u)); break;
+                case OP_SIN:   r[i] = std::sin(u); break;
+                case OP_COS:   r[i] = std::cos(u); break;
+                case OP_TAN:   r[i] = std::tan(u); break;
+                case OP_ASIN:  r[i] = std::asin(u); break;
+                case OP_ACOS:  r[i] = std::acos(u); break;
+                case OP_ATAN:  r[i] = std::atan(u); break;
+                case OP_SINH:  r[i] = std::sinh(u); break;
+                case OP_COSH:  r[i] = std::cosh(u); break;
+                case OP_TANH:  r[i] = std::tanh(u); break;
+                case OP_ASINH: r[i] = std::asinh(u); break;
+                case OP_ACOSH: r[i] = std::acosh(u); break;
+                case OP_ATANH: r[i] = std::atanh(u); break;
+                case OP_ABS:   r[i] = std::abs(u); break;
+                case OP_SIGN:  r[i] = u == 0.0 ? Complex(0.0) : u / std::abs(u); break;
+                case OP_FLOOR: r[i] = Complex(std::floor(u.real()), std::floor(u.imag())); break;
+                case OP_CEIL:  r[i] = Complex(std::ceil(u.real()), std::ceil(u.imag())); break;
+                case OP_MIN:
+                case OP_MAX: {
+                    // Only defined between reals
+                    const Complex& v = r[in.b];
+                    if (u.imag() != 0 || v.imag() != 0) {
+                        r[i] = nan;
+                    } else {
+                        r[i] = in.op == OP_MIN ? std::fmin(u.real(), v.real()) : std::fmax(u.real(), v.real());
+                    }
+                    break;
+                }
+                case OP_RE:    r[i] = u.real(); break;
+                case OP_IM:    r[i] = u.imag(); break;
+                case OP_CONJ:  r[i] = std::conj(u); break;
+                case OP_ARG:   r[i] = std::arg(on_cut(u)); break;
+            }
+        }
+    }
+
+    // Emits instructions with hash-consing, so an instruction with the
+    // same operator and operands is only ever computed once
+    class TapeBuilder {
+    public:
+        int32_t emit(TapeOp op, int32_t a = -1, int32_t b = -1, double c = 0.0, double ci = 0.0) {
+            if ((op == OP_ADD || op == OP_MUL || op == OP_MIN || op == OP_MAX) && a > b) {
+                std::swap(a, b);
+            }
+            uint64_t bits, ibits;
+            std::memcpy(&bits, &c, sizeof bits);
+            std::memcpy(&ibits, &ci, sizeof ibits);
+            auto key = std::make_tuple(static_cast<int>(op), a, b, bits, ibits);
+            auto it = seen_.find(key);
+            if (it != seen_.end()) return it->second;
+            code.push_back(TapeInstr{op, a, b, c, ci});
+            int32_t reg = static_cast<int32_t>(code.size() - 1);
+            seen_.emplace(key, reg);
+            return reg;
+        }
+
+        bool is_const(int32_t reg) const {
+            return code[reg].op == OP_CONST;
+        }
+
+        // Index of an enclosure in bounds, shared between equal ones
+        int32_t bound(const std::pair<double, double>& b) {
+            uint64_t lo, hi;
+            std::memcpy(&lo, &b.first, sizeof lo);
+            std::memcpy(&hi, &b.second, sizeof hi);
+            auto it = bound_index_.find({lo, hi});
+            if (it != bound_index_.end()) return it->second;
+            bounds.push_back(b);
+            int32_t index = static_cast<int32_t>(bounds.size() - 1);
+            bound_index_.emplace(std::make_pair(lo, hi), index);
+            return index;
+        }
+
+        std::vector<TapeInstr> code;
+        // Enclosures [lo, hi] of the rounded real constants
+        std::vector<std::pair<double, double>> bounds;
+        // Constants may be complex
+        bool complex = false;
+        // Fold subtrees without inputs into one constant
+        bool fold = true;
+
+    private:
+        std::map<std::tuple<int, int32_t, int32_t, uint64_t, uint64_t>, int32_t> seen_;
+        std::map<std::pair<uint64_t, uint64_t>, int32_t> bound_index_;
+    };
+
+    double real_constant(const giac::gen& g, giac::context& ctx) {
+        giac::gen d = giac::evalf_double(g, 1, &ctx);
+        if (d.type == giac::_DOUBLE_) return d._DOUBLE_val;
+        if (d.type == giac::_INT_) return d.val;
+        throw std::runtime_error("CompiledFunction: not a real constant: " + g.print(&ctx));
+    }
+
+    // Enclosure of the real constant g, whose double value is value;
+    // defined with the interval evaluator below
+    std::pair<double, double> constant_bounds(const giac::gen& g, double value, giac::context& ctx);
+
+    int32_t emit_constant(TapeBuilder& tb, const giac::gen& g, giac::context& ctx) {
+        bool exact = g.type == giac::_INT_ || g.type == giac::_DOUBLE_;
+        if (tb.complex) {
+            giac::gen d = giac::evalf_double(g, 1, &ctx);
+            if (d.type == giac::_CPLX) {
+                return tb.emit(OP_CONST, -1, kRoundedConst, real_constant(d._CPLXptr[0], ctx),
+                               real_constant(d._CPLXptr[1], ctx));
+            }
+        }
+        double value = real_constant(g, ctx);
+        if (exact) return tb.emit(OP_CONST, -1, -1, value);
+        return tb.emit(OP_CONST, tb.bound(constant_bounds(g, value, ctx)), kRoundedConst, value);
+    }
+
+    // Instructions for operator f applied to argument registers args
+    int32_t emit_call(TapeBuilder& tb, const giac::unary_function_ptr& f,
+                      const std::vector<int32_t>& args, bool seq, giac::context& ctx) {
+        static const std::pair<const giac::unary_function_ptr*, TapeOp> unary_ops[] = {
+            {giac::at_neg, OP_NEG}, {giac::at_inv, OP_INV}, {giac::at_sqrt, OP_SQRT},
+            {giac::at_exp, OP_EXP}, {giac::at_ln, OP_LN}, {giac::at_log10, OP_LOG10},
+            {giac::at_sin, OP_SIN}, {giac::at_cos, OP_COS}, {giac::at_tan, OP_TAN},
+            {giac::at_asin, OP_ASIN}, {giac::at_acos, OP_ACOS}, {giac::at_atan, OP_ATAN},
+            {giac::at_sinh, OP_SINH}, {giac::at_cosh, OP_COSH}, {giac::at_tanh, OP_TANH},
+            {giac::at_asinh, OP_ASINH}, {giac::at_acosh, OP_ACOSH}, {giac::at_atanh, OP_ATANH},
+            {giac::at_abs, OP_ABS}, {giac::at_sign, OP_SIGN}, {giac::at_floor, OP_FLOOR},
+            {giac::at_ceil, OP_CEIL}, {giac::at_re, OP_RE}, {giac::at_im, OP_IM},
+            {giac::at_conj, OP_CONJ}, {giac::at_arg, OP_ARG},
+        };
+        auto fold = [&](TapeOp op) {
+            int32_t acc = args[0];
+            for (size_t k = 1; k < args.size(); ++k) acc = tb.emit(op, acc, args[k]);
+            return acc;
+        };
+
+        if (!seq) {
+            for (const auto& u : unary_ops) {
+                if (f == u.first) return tb.emit(u.second, args[0]);
+            }
+            if (f == giac::at_sq) return tb.emit(OP_POWI, args[0], -1, 2.0);
+            if (f == giac::at_plus || f == giac::at_prod || f == giac::at_max || f == giac::at_min) {
+                return args[0];
+            }
+        } else if (!args.empty()) {
+            if (f == giac::at_plus) return fold(OP_ADD);
+            if (f == giac::at_prod) return fold(OP_MUL);
+            if (f == giac::at_max) return fold(OP_MAX);
+            if (f == giac::at_min) return fold(OP_MIN);
+            if (args.size() == 2) {
+                if (f == giac::at_binary_minus) return tb.emit(OP_SUB, args[0], args[1]);
+                if (f == giac::at_division) return tb.emit(OP_DIV, args[0], args[1]);
+                if (f == giac::at_pow) {
+                    if (tb.is_const(args[1]) && tb.code[args[1]].ci == 0) {
+                        double e = tb.code[args[1]].c;
+                        if (e == 0.5) return tb.emit(OP_SQRT, args[0]);
+                        if (e == std::floor(e) && std::fabs(e) <= 1024) {
+                            return tb.emit(OP_POWI, args[0], -1, e);
+                        }
+                    }
+                    return tb.emit(OP_POW, args[0], args[1]);
+                }
+            }
+        }
+        throw std::runtime_error(std::string("CompiledFunction: unsupported operator ") +
+                                 f.ptr()->print(&ctx));
+    }
+
+    // Lower g onto the tape; returns its register. Explicit-stack
+    // post-order walk; shared _SYMB nodes are lowered once and subtrees
+    // without inputs are folded by giac's evalf.
+    int32_t lower_expr(TapeBuilder& tb, const giac::gen& root,
+                       const std::unordered_map<const char*, int32_t>& input_of,
+                       std::unordered_map<const void*, int32_t>& shared, giac::context& ctx) {
+        struct Frame { const giac::gen* node; bool open; };
+        std::vector<Frame> stack{{&root, false}};
+        std::vector<int32_t> regs;
+
+        auto arguments = [](const giac::gen& g, const giac::gen*& first, size_t& n) {
+            const giac::gen& f = g._SYMBptr->feuille;
+            if (f.type == giac::_VECT && f.subtype == giac::_SEQ__VECT) {
+                first = f._VECTptr->empty() ? nullptr : &(*f._VECTptr)[0];
+                n = f._VECTptr->size();
+                return true;
+            }
+            first = &f;
+            n = 1;
+            return false;
+        };
+
+        while (!stack.empty()) {
+            Frame frame = stack.back();
+            stack.pop_back();
+            const giac::gen& g = *frame.node;
+
+            if (!frame.open) {
+                if (g.type == giac::_IDNT) {
+                    auto it = input_of.find(g._IDNTptr->id_name);
+                    regs.push_back(it != input_of.end() ? tb.emit(OP_INPUT, it->second)
+                                                        : emit_constant(tb, g, ctx));
+                } else if (g.type == giac::_SYMB) {
+                    auto it = shared.find(g._SYMBptr);
+                    if (it != shared.end()) {
+                        regs.push_back(it->second);
+                        continue;
+                    }
+                    stack.push_back({frame.node, true});
+                    const giac::gen* first;
+                    size_t n;
+                    arguments(g, first, n);
+                    for (size_t k = n; k-- > 0;) stack.push_back({first + k, false});
+                } else if (g.type == giac::_VECT) {
+                    throw std::runtime_error("CompiledFunction: vectors are not supported inside expressions");
+                } else {
+                    regs.push_back(emit_constant(tb, g, ctx));
+                }
+                continue;
+            }
+
+            const giac::gen* first;
+            size_t n;
+            bool seq = arguments(g, first, n);
+            std::vector<int32_t> args(regs.end() - n, regs.end());
+            regs.resize(regs.size() - n);
+            bool constant = tb.fold;
+            for (int32_t a : args) constant = constant && tb.is_const(a);
+            int32_t reg = constant ? emit_constant(tb, g, ctx)
+                                   : emit_call(tb, g._SYMBptr->sommet, args, seq, ctx);
+            shared.emplace(g._SYMBptr, reg);
+            regs.push_back(reg);
+        }
+        return regs.back();
+    }
+
+    // Keep only the instructions the outputs depend on
+    void prune_tape(std::vector<TapeInstr>& code, std::vector<int32_t>& outputs) {
+        std::vector<char> live(code.size(), 0);
+        for (int32_t o : outputs) live[o] = 1;
+        for (size_t k = code.size(); k-- > 0;) {
+            if (!live[k] || code[k].op == OP_CONST || code[k].op == OP_INPUT) continue;
+            live[code[k].a] = 1;
+            if (code[k].b >= 0) live[code[k].b] = 1;
+        }
+        std::vector<int32_t> remap(code.size(), -1);
+        size_t w = 0;
+        for (size_t k = 0; k < code.size(); ++k) {
+            if (!live[k]) continue;
+            TapeInstr in = code[k];
+            if (in.op != OP_CONST && in.op != OP_INPUT) {
+                in.a = remap[in.a];
+                if (in.b >= 0) in.b = remap[in.b];
+            }
+            remap[k] = static_cast<int32_t>(w);
+            code[w++] = in;
+        }
+        code.resize(w);
+        for (int32_t& o : outputs) o = remap[o];
+    }
+
+    // Points per task in eval_batch
+    constexpr size_t kEvalPointsPerTask = 256;
+}
+
+struct CompiledFunctionImpl {
+    std::vector<TapeInstr> code;
+    std::vector<std::pair<double, double>> bounds;  // rounded constants, for intervals
+    std::vector<int32_t> outputs;     // register of each output
+    std::vector<std::string> vars;
+    giac::vecteur exprs;              // sources, for jacobian()
+    bool complex = false;
+};
+
+CompiledFunction::CompiledFunction(const std::vector<Gen>& exprs, const std::vector<std::string>& vars)
+    : CompiledFunction(exprs, vars, false) {}
+
+CompiledFunction::CompiledFunction(const std::vector<Gen>& exprs, const std::vector<std::string>& vars,
+                                   bool complex)
+    : impl_(std::make_unique<CompiledFunctionImpl>()) {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    impl_->vars = vars;
+    impl_->complex = complex;
+    std::unordered_map<const char*, int32_t> input_of;
+    for (size_t k = 0; k < vars.size(); ++k) {
+        giac::gen id(giac::identificateur(vars[k]));
+        input_of.emplace(id._IDNTptr->id_name, static_cast<int32_t>(k));
+    }
+    TapeBuilder tb;
+    tb.complex = complex;
+    std::unordered_map<const void*, int32_t> shared;
+    for (const Gen& e : exprs) {
+        impl_->exprs.push_back(e.impl_->g);
+        impl_->outputs.push_back(lower_expr(tb, e.impl_->g, input_of, shared, ctx));
+    }
+    impl_->code = std::move(tb.code);
+    impl_->bounds = std::move(tb.bounds);
+    prune_tape(impl_->code, impl_->outputs);
+}
+
+CompiledFunction::CompiledFunction(std::unique_ptr<CompiledFunctionImpl> impl) : impl_(std::move(impl)) {}
+
+CompiledFunction::~CompiledFunction() = default;
+
+CompiledFunction::CompiledFunction(const CompiledFunction& other)
+    : impl_(std::make_unique<CompiledFunctionImpl>(*other.impl_)) {}
+
+CompiledFunction& CompiledFunction::operator=(const CompiledFunction& other) {
+    if (this != &other) {
+        impl_ = std::make_unique<CompiledFunctionImpl>(*other.impl_);
+    }
+    return *this;
+}
+
+CompiledFunction::CompiledFunction(CompiledFunction&& other) noexcept = default;
+CompiledFunction& CompiledFunction::operator=(CompiledFunction&& other) noexcept = default;
+
+int32_t CompiledFunction::num_inputs() const {
+    return static_cast<int32_t>(impl_->vars.size());
+}
+
+int32_t CompiledFunction::num_outputs() const {
+    return static_cast<int32_t>(impl_->outputs.size());
+}
+
+int64_t CompiledFunction::num_instructions() const {
+    return static_cast<int64_t>(impl_->code.size());
+}
+
+std::vector<std::string> CompiledFunction::variables() const {
+    return impl_->vars;
+}
+
+bool CompiledFunction::is_complex() const {
+    return impl_->complex;
+}
+
+void CompiledFunction::eval(const double* x, double* y) const {
+    if (impl_->complex) {
+        throw std::runtime_error("CompiledFunction: compiled in complex mode, use eval_complex");
+    }
+    thread_local std::vector<double> regs;
+    regs.resize(impl_->code.size());
+    run_tape(impl_->code, x, regs.data());
+    for (size_t k = 0; k < impl_->outputs.size(); ++k) {
+        y[k] = regs[impl_->outputs[k]];
+    }
+}
+
+std::vector<double> CompiledFunction::eval(const std::vector<double>& x) const {
+    if (x.size() != impl_->vars.size()) {
+        throw std::runtime_error("CompiledFunction: expected " + std::to_string(impl_->vars.size()) +
+                                 " inputs, got " + std::to_string(x.size()));
+    }
+    std::vector<double> y(impl_->outputs.size());
+    eval(x.data(), y.data());
+    return y;
+}
+
+std::vector<double> CompiledFunction::eval_batch(const std::vector<double>& points,
+                                                 int32_t num_threads) const {
+    if (impl_->complex) {
+        throw std::runtime_error("CompiledFunction: compiled in complex mode, use eval_complex_batch");
+    }
+    size_t nin = impl_->vars.size();
+    size_t nout = impl_->outputs.size();
+    if (nin == 0 ? !points.empty() : points.size() % nin != 0) {
+        throw std::runtime_error("CompiledFunction: points must have npoints * num_inputs entries");
+    }
+    size_t npoints = nin == 0 ? 0 : points.size() / nin;
+    std::vector<double> out(npoints * nout);
+    size_t tasks = (npoints + kEvalPointsPerTask - 1) / kEvalPointsPerTask;
+    WorkerPool::instance().run(tasks, num_threads, [&](size_t t) {
+        size_t end = std::min(npoints, (t + 1) * kEvalPointsPerTask);
+        for (size_t p = t * kEvalPointsPerTask; p < end; ++p) {
+            eval(points.data() + p * nin, out.data() + p * nout);
+        }
+    });
+    return out;
+}
+
+void CompiledFunction::eval_complex(const double* z, double* w) const {
+    thread_local std::vector<Complex> regs;
+    regs.resize(impl_->code.size());
+    // std::complex<double> is layout-compatible with double[2]
+    run_complex_tape(impl_->code, reinterpret_cast<const Complex*>(z), regs.data());
+    for (size_t k = 0; k < impl_->outputs.size(); ++k) {
+        const Complex& v = regs[impl_->outputs[k]];
+        w[2 * k] = v.real();
+        w[2 * k + 1] = v.imag();
+    }
+}
+
+std::vector<double> CompiledFunction::eval_complex(const std::vector<double>& z) const {
+    if (z.size() != 2 * impl_->vars.size()) {
+        throw std::runtime_error("CompiledFunction: expected " + std::to_string(impl_->vars.size()) +
+                                 " complex inputs (" + std::to_string(2 * impl_->vars.size()) +
+                                 " doubles), got " + std::to_string(z.size()) + " doubles");
+    }
+    std::vector<double> w(2 * impl_->outputs.size());
+    eval_complex(z.data(), w.data());
+    return w;
+}
+
+std::vector<double> CompiledFunction::eval_complex_batch(const std::vector<double>& points,
+                                                         int32_t num_threads) const {
+    size_t nin = 2 * impl_->vars.size();
+    size_t nout = 2 * impl_->outputs.size();
+    if (nin == 0 ? !points.empty() : points.size() % nin != 0) {
+        throw std::runtime_error("CompiledFunction: points must have npoints * 2 * num_inputs entries");
+    }
+    size_t npoints = nin == 0 ? 0 : points.size() / nin;
+    std::vector<double> out(npoints * nout);
+    size_t tasks = (npoints + kEvalPointsPerTask - 1) / kEvalPointsPerTask;
+    WorkerPool::instance().run(tasks, num_threads, [&](size_t t) {
+        size_t end = std::min(npoints, (t + 1) * kEvalPointsPerTask);
+        for (size_t p = t * kEvalPointsPerTask; p < end; ++p) {
+            eval_complex(points.data() + p * nin, out.data() + p * nout);
+        }
+    });
+    return out;
+}
+
+CompiledFunction CompiledFunction::jacobian() const {
+    initialize_giac_library();
+    giac::context& ctx = get_thread_local_context();
+    std::vector<Gen> partials;
+    partials.reserve(impl_->exprs.size() * impl_->vars.size());
+    for (const giac::gen& e : impl_->exprs) {
+        for (const std::string& v : impl_->vars) {
+            giac::gen d = giac::derive(e, giac::gen(giac::identificateur(v)), &ctx);
+            partials.push_back(Gen(std::make_unique<GenImpl>(d)));
+        }
+    }
+    return CompiledFunction(partials, impl_->vars, impl_->complex);
+}
+
+void compiled_function_call(const double* x, double* y, void* data) {
+    const auto* f = static_cast<const CompiledFunction*>(data);
+    try {
+        f->eval(x, y);
+    } catch (...) {
+        std::fill(y, y + f->num_outputs(), std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+void compiled_ode_rhs(double* du, const double* u, void* data, double t) {
+    const auto* f = static_cast<const CompiledFunction*>(data);
+    try {
+        if (f->num_inputs() < 1) throw std::runtime_error("compiled_ode_rhs: no time input");
+        thread_local std::vector<double> x;
+        x.resize(static_cast<size_t>(f->num_inputs()));
+        x[0] = t;
+        std::copy(u, u + x.size() - 1, x.begin() + 1);
+        f->eval(x.data(), du);
+    } catch (...) {
+        std::fill(du, du + f->num_outputs(), std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+void* compiled_function_call_ptr() {
+    return reinterpret_cast<void*>(&compiled_function_call);
+}
+
+void* compiled_ode_rhs_ptr() {
+    return reinterpret_cast<void*>(&compiled_ode_rhs);
+}
+
+
+// ============================================================================
+// ODE Integration
+// ============================================================================
+
+namespace {
+    bool all_finite(const std::vector<double>& v) {
+        for (double x : v) {
+            if (!std::isfinite(x)) return false;
+        }
+        return true;
+    }
+
+    // RMS of err scaled by atol + rtol * max(|y|, |ynew|)
+    double error_norm(const std::vector<double>& err, const double* y, const double* ynew,
+                      double rtol, double atol) {
+        if (err.empty()) return 0.0;
+        double sum = 0.0;
+        for (size_t i = 0; i < err.size(); ++i) {
+            double sc = atol + rtol * std::max(std::fabs(y[i]), std::fabs(ynew[i]));
+            double e = err[i] / sc;
+            sum += e * e;
+        }
+        return std::sqrt(sum / static_cast<double>(err.size()));
+    }
+
+    // In-place LU with partial pivoting of the n x n row-major a
+    bool lu_factor(std::vector<double>& a, std::vector<size_t>& piv, size_t n) {
+        piv.resize(n);
+        for (size_t c = 0; c < n; ++c) {
+            size_t p = c;
+            for (size_t r = c + 1; r < n; ++r) {
+                if (std::fabs(a[r * n + c]) > std::fabs(a[p * n + c])) p = r;
+            }
+            piv[c] = p;
+            if (a[p * n + c] == 0.0 || !std::isfinite(a[p * n + c])) return false;
+            if (p != c) {
+                for (size_t j = 0; j < n; ++j) std::swap(a[c * n + j], a[p * n + j]);
+            }
+            double inv = 1.0 / a[c * n + c];
+            for (size_t r = c + 1; r < n; ++r) {
+                double m = a[r * n + c] *= inv;
+                if (m == 0.0) continue;
+                for (size_t j = c + 1; j < n; ++j) a[r * n + j] -= m * a[c * n + j];
+            }
+        }
+        return true;
+    }
+
+    void lu_solve(const std::vector<double>& lu, const std::vector<size_t>& piv, size_t n,
+                  double* b) {
+        for (size_t c = 0; c < n; ++c) {
+            std::swap(b[c], b[piv[c]]);
+            for (size_t r = c + 1; r < n; ++r) b[r] -= lu[r * n + c] * b[c];
+        }
+        for (size_t c = n; c-- > 0;) {
+            for (size_t j = c + 1; j < n; ++j) b[c] -= lu[c * n + j] * b[j];
+            b[c] /= lu[c * n + c];
+        }
+    }
+
+    // Dormand-Prince 5(4) with FSAL and Hairer's 4th order dense output.
+    // rhs(t, y, f) writes f = dy/dt.
+    template <class Rhs>
+    class DormandPrince {
+    public:
+        static constexpr double kOrder = 5.0;
+
+        DormandPrince(Rhs rhs, size_t n, double rtol, double atol)
+            : rhs_(rhs), n_(n), rtol_(rtol), atol_(atol),
+              k_(7, std::vector<double>(n)), tmp_(n), err_(n), rc_(5, std::vector<double>(n)) {}
+
+        void eval(double t, const double* y, double* f) {
+            rhs_(t, y, f);
+            ++rhs_evals;
+        }
+
+        void start(double t, const double* y) {
+            eval(t, y, k_[0].data());
+        }
+
+        const std::vector<double>& derivative() const { return k_[0]; }
+
+        bool step(double t, const double* y, double h, double* ynew, double& err) {
+            static const double c[7] = {0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1, 1};
+            static const double a[6][6] = {
+                {1.0 / 5},
+                {3.0 / 40, 9.0 / 40},
+                {44.0 / 45, -56.0 / 15, 32.0 / 9},
+                {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+                {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+                {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84},
+            };
+            static const double e[7] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920,
+                                        -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+            for (int s = 1; s <= 6; ++s) {
+                double* out = s == 6 ? ynew : tmp_.data();
+                for (size_t i = 0; i < n_; ++i) {
+                    double acc = 0.0;
+                    for (int j = 0; j < s; ++j) acc += a[s - 1][j] * k_[j][i];
+                    out[i] = y[i] + h * acc;
+                }
+                eval(t + c[s] * h, out, k_[s].data());
+            }
+            for (size_t i = 0; i < n_; ++i) {
+                double acc = 0.0;
+                for (int j = 0; j < 7; ++j) acc += e[j] * k_[j][i];
+                err_[i] = h * acc;
+            }
+            if (!all_finite(k_[6]) || !all_finite(err_)) return false;
+            err = error_norm(err_, y, ynew, rtol_, atol_);
+            return std::isfinite(err);
+        }
+
+        void accept(double, const double* y, const double* ynew, double h) {
+            static const double d[7] = {-12715105075.0 / 11282082432.0, 0,
+                                        87487479700.0 / 32700410799.0, -10690763975.0 / 1880347072.0,
+                                        701980252875.0 / 199316789632.0, -1453857185.0 / 822651844.0,
+                                        69997945.0 / 29380423.0};
+            for (size_t i = 0; i < n_; ++i) {
+                double dy = ynew[i] - y[i];
+                double bspl = h * k_[0][i] - dy;
+                rc_[0][i] = y[i];
+                rc_[1][i] = dy;
+                rc_[2][i] = bspl;
+                rc_[3][i] = dy - h * k_[6][i] - bspl;
+                double acc = 0.0;
+                for (int j = 0; j < 7; ++j) acc += d[j] * k_[j][i];
+                rc_[4][i] = h * acc;
+            }
+            std::swap(k_[0], k_[6]);
+        }
+
+        // State at t + theta * h of the last accepted step
+        void interpolate(double theta, double* out) const {
+            double theta1 = 1.0 - theta;
+            for (size_t i = 0; i < n_; ++i) {
+                out[i] = rc_[0][i] + theta * (rc_[1][i] + theta1 * (rc_[2][i] +
+                         theta * (rc_[3][i] + theta1 * rc_[4][i])));
+            }
+        }
+
+        int64_t rhs_evals = 0;
+        int64_t jacobian_evals = 0;
+
+    private:
+        Rhs rhs_;
+        size_t n_;
+        double rtol_, atol_;
+        std::vector<std::vector<double>> k_;
+        std::vector<double> tmp_, err_;
+        std::vector<std::vector<double>> rc_;
+    };
+
+    // Shampine and Reichelt's modified Rosenbrock 2(3) (MATLAB's ode23s):
+    // L-stable, one Jacobian and one LU per step. jac(t, y, J, T) writes
+    // the n x n row-major J = df/dy and T = df/dt.
+    template <class Rhs, class Jac>
+    class Rosenbrock23 {
+    public:
+        static constexpr double kOrder = 3.0;
+
+        Rosenbrock23(Rhs rhs, Jac jac, size_t n, double rtol, double atol)
+            : rhs_(rhs), jac_(jac), n_(n), rtol_(rtol), atol_(atol),
+              f0_(n), f1_(n), f2_(n), k1_(n), k2_(n), k3_(n), tmp_(n), err_(n),
+              J_(n * n), T_(n), W_(n * n), y0_(n) {}
+
+        void eval(double t, const double* y, double* f) {
+            rhs_(t, y, f);
+            ++rhs_evals;
+        }
+
+        void start(double t, const double* y) {
+            eval(t, y, f0_.data());
+            jac_(t, y, J_.data(), T_.data());
+            ++jacobian_evals;
+        }
+
+        const std::vector<double>& derivative() const { return f0_; }
+
+        bool step(double t, const double* y, double h, double* ynew, double& err) {
+            const double d = 1.0 / (2.0 + std::sqrt(2.0));
+            const double e32 = 6.0 + std::sqrt(2.0);
+            const double hd = h * d;
+            for (size_t i = 0; i < n_ * n_; ++i) W_[i] = -hd * J_[i];
+            for (size_t i = 0; i < n_; ++i) W_[i * n_ + i] += 1.0;
+            if (!lu_factor(W_, piv_, n_)) return false;
+
+            for (size_t i = 0; i < n_; ++i) k1_[i] = f0_[i] + hd * T_[i];
+            lu_solve(W_, piv_, n_, k1_.data());
+            for (size_t i = 0; i < n_; ++i) tmp_[i] = y[i] + 0.5 * h * k1_[i];
+            eval(t + 0.5 * h, tmp_.data(), f1_.data());
+            for (size_t i = 0; i < n_; ++i) k2_[i] = f1_[i] - k1_[i];
+            lu_solve(W_, piv_, n_, k2_.data());
+            for (size_t i = 0; i < n_; ++i) {
+                k2_[i] += k1_[i];
+                ynew[i] = y[i] + h * k2_[i];
+            }
+            eval(t + h, ynew, f2_.data());
+            for (size_t i = 0; i < n_; ++i) {
+                k3_[i] = f2_[i] - e32 * (k2_[i] - f1_[i]) - 2.0 * (k1_[i] - f0_[i]) + hd * T_[i];
+            }
+            lu_solve(W_, piv_, n_, k3_.data());
+            for (size_t i = 0; i < n_; ++i) {
+                err_[i] = h / 6.0 * (k1_[i] - 2.0 * k2_[i] + k3_[i]);
+            }
+            if (!all_finite(f2_) || !all_finite(err_)) return false;
+            err = error_norm(err_, y, ynew, rtol_, atol_);
+            return std::isfinite(err);
+        }
+
+        void accept(double t_new, const double* y, const double* ynew, double h) {
+            std::copy(y, y + n_, y0_.begin());
+            h_ = h;
+            std::swap(f0_, f2_);
+            jac_(t_new, ynew, J_.data(), T_.data());
+            ++jacobian_evals;
+        }
+
+        void interpolate(double theta, double* out) const {
+            const double d = 1.0 / (2.0 + std::sqrt(2.0));
+            double w1 = theta * (1.0 - theta) / (1.0 - 2.0 * d);
+            double w2 = theta * (theta - 2.0 * d) / (1.0 - 2.0 * d);
+            for (size_t i = 0; i < n_; ++i) {
+                out[i] = y0_[i] + h_ * (w1 * k1_[i] + w2 * k2_[i]);
+            }
+        }
+
+        int64_t rhs_evals = 0;
+        int64_t jacobian_evals = 0;
+
+    private:
+        Rhs rhs_;
+        Jac jac_;
+        size_t n_;
+        double rtol_, atol_;
+        std::vector<double> f0_, f1_, f2_, k1_, k2_, k3_, tmp_, err_;
+        std::vector<double> J_, T_, W_, y0_;
+        std::vector<size_t> piv_;
+        double h_ = 0.0;
+    };
+
+    // Hairer's starting step guess from f(t0, y0) and one Euler probe
+    template <class Stepper>
+    double initial_step(Stepper& stepper, double t0, const std::vector<double>& y0, double dir,
+                        double rtol, double atol) {
+        size_t n = y0.size();
+        if (n == 0) return 1.0;
+        const std::vector<double>& f0 = stepper.derivative();
+        double d0 = 0.0, d1 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double sc = atol + rtol * std::fabs(y0[i]);
+            d0 += (y0[i] / sc) * (y0[i] / sc);
+            d1 += (f0[i] / sc) * (f0[i] / sc);
+        }
+        d0 = std::sqrt(d0 / n);
+        d1 = std::sqrt(d1 / n);
+        double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+
+        std::vector<double> y1(n), f1(n);
+        for (size_t i = 0; i < n; ++i) y1[i] = y0[i] + dir * h0 * f0[i];
+        stepper.eval(t0 + dir * h0, y1.data(), f1.data());
+        double d2 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double sc = atol + rtol * std::fabs(y0[i]);
+            double df = (f1[i] - f0[i]) / sc;
+            d2 += df * df;
+        }
+        d2 = std::sqrt(d2 / n) / h0;
+        double dmax = std::max(d1, d2);
+        double h1 = dmax <= 1e-15 ? std::max(1e-6, h0 * 1e-3)
+                                  : std::pow(0.01 / dmax, 1.0 / Stepper::kOrder);
+        double h = std::min(100.0 * h0, h1);
+        return std::isfinite(h) && h > 0 ? h : 1e-6;
+    }
+
+    // Adaptive step loop shared by the integrators; y_out row k receives
+    // the dense output at t_out[k]
+    template <class Stepper>
+    OdeStats integrate(Stepper& stepper, const std::vector<double>& y0,
+                       const std::vector<double>& t_out, double* y_out, const OdeOptions& options) {
+        const size_t n = y0.size();
+        const size_t nout = t_out.size();
+        OdeStats stats;
+        std::copy(y0.begin(), y0.end(), y_out);
+        stats.outputs = 1;
+        stats.t_reached = t_out[0];
+        if (nout == 1) return stats;
+
+        const double t_end = t_out.back();
+        const double dir = t_end > t_out[0] ? 1.0 : -1.0;
+        std::vector<double> y(y0), ynew(n);
+        double t = t_out[0];
+        stepper.start(t, y.data());
+        if (!all_finite(stepper.derivative())) {
+            stats.status = ODE_NOT_FINITE;
+            stats.rhs_evals = stepper.rhs_evals;
+            return stats;
+        }
+
+        double h = options.initial_step > 0
+                       ? options.initial_step
+                       : initial_step(stepper, t, y, dir, options.rtol, options.atol);
+        if (options.max_step > 0) h = std::min(h, options.max_step);
+        const double exponent = 1.0 / Stepper::kOrder;
+        size_t k = 1;
+        int64_t attempts = 0;
+        bool rejected_last = false;
+        bool non_finite = false;
+
+        while (k < nout) {
+            if (attempts >= options.max_steps) {
+                stats.status = ODE_MAX_STEPS;
+                break;
+            }
+            double hmin = 16.0 * std::numeric_limits<double>::epsilon() * std::max(std::fabs(t), 1e-300);
+            if (h < hmin) {
+                stats.status = non_finite ? ODE_NOT_FINITE : ODE_STEP_TOO_SMALL;
+                break;
+            }
+            ++attempts;
+            double remaining = std::fabs(t_end - t);
+            bool final_step = h >= remaining;
+            double hs = dir * (final_step ? remaining : h);
+            double err = 0.0;
+            if (!stepper.step(t, y.data(), hs, ynew.data(), err)) {
+                ++stats.rejected;
+                non_finite = true;
+                rejected_last = true;
+                h = std::fabs(hs) * 0.25;
+                continue;
+            }
+            non_finite = false;
+            if (err > 1.0) {
+                ++stats.rejected;
+                rejected_last = true;
+                h = std::fabs(hs) * std::max(0.2, 0.9 * std::pow(err, -exponent));
+                continue;
+            }
+
+            double t_new = final_step ? t_end : t + hs;
+            stepper.accept(t_new, y.data(), ynew.data(), hs);
+            while (k < nout && dir * (t_out[k] - t_new) <= 0) {
+                stepper.interpolate((t_out[k] - t) / hs, y_out + k * n);
+                ++k;
+            }
+            t = t_new;
+            y.swap(ynew);
+            ++stats.steps;
+
+            double factor = err == 0.0 ? 5.0 : std::min(5.0, 0.9 * std::pow(err, -exponent));
+            if (rejected_last) factor = std::min(1.0, factor);
+            rejected_last = false;
+            h = std::fabs(hs) * factor;
+            if (options.max_step > 0) h = std::min(h, options.max_step);
+        }
+
+        stats.outputs = static_cast<int64_t>(k);
+        stats.t_reached = t;
+        stats.rhs_evals = stepper.rhs_evals;
+        stats.jacobian_evals = stepper.jacobian_evals;
+        return stats;
+    }
+
+    void check_ode_problem(const CompiledFunction& rhs, const std::vector<double>& y0,
+                           const std::vector<double>& t_out, const OdeOptions& options) {
+        if (rhs.num_inputs() != static_cast<int32_t>(y0.size()) + 1 ||
+            rhs.num_outputs() != static_cast<int32_t>(y0.size())) {
+            throw std::runtime_error("ode_solve: rhs must map (t, y1..yn) to n derivatives");
+        }
+        if (rhs.is_complex()) {
+            throw std::runtime_error("ode_solve: rhs was compiled in complex mode");
+        }
+        if (t_out.empty()) {
+            throw std::runtime_error("ode_solve: t_out must contain the initial time");
+        }
+        double dir = t_out.size() > 1 && t_out.back() < t_out[0] ? -1.0 : 1.0;
+        for (size_t k = 1; k < t_out.size(); ++k) {
+            if (!(dir * (t_out[k] - t_out[k - 1]) > 0)) {
+                throw std::runtime_error("ode_solve: t_out must be strictly monotone");
+            }
+        }
+        if (!(options.rtol >= 0) || !(options.atol >= 0) || options.rtol + options.atol <= 0) {
+            throw std::runtime_error("ode_solve: tolerances must be non-negative and not both zero");
+        }
+        if (options.method != ODE_RK45 && options.method != ODE_ROSENBROCK23) {
+            throw std::runtime_error("ode_solve: unknown method " + std::to_string(options.method));
+        }
+    }
+}
+
+OdeOptions make_ode_options(int32_t method, double rtol, double atol, int64_t max_steps) {
+    OdeOptions options;
+    options.method = method;
+    options.rtol = rtol;
+    options.atol = atol;
+    options.max_steps = max_steps;
+    return options;
+}
+
+OdeStats ode_solve(const CompiledFunction& rhs, const std::vector<double>& y0,
+                   const std::vector<double>& t_out, double* y_out, const OdeOptions& options) {
+    check_ode_problem(rhs, y0, t_out, options);
+    const size_t n = y0.size();
+    std::vector<double> x(n + 1);
+    auto f = [&rhs, &x, n](double t, const double* y, double* dy) {
+        x[0] = t;
+        std::copy(y, y + n, x.begin() + 1);
+        rhs.eval(x.data(), dy);
+    };
+
+    if (options.method == ODE_RK45) {
+        DormandPrince<decltype(f)> stepper(f, n, options.rtol, options.atol);
+        return integrate(stepper, y0, t_out, y_out, options);
+    }
+
+    CompiledFunction jacobian = rhs.jacobian();
+    std::vector<double> xj(n + 1), dfdx(n * (n + 1));
+    auto jac = [&jacobian, &xj, &dfdx, n](double t, const double* y, double* J, double* T) {
+        xj[0] = t;
+        std::copy(y, y + n, xj.begin() + 1);
+        jacobian.eval(xj.data(), dfdx.data());
+        for (size_t i = 0; i < n; ++i) {
+            T[i] = dfdx[i * (n + 1)];
+            std::copy(dfdx.begin() + i * (n + 1) + 1, dfdx.begin() + (i + 1) * (n + 1), J + i * n);
+        }
+    };
+    Rosenbrock23<decltype(f), decltype(jac)> stepper(f, jac, n, options.rtol, options.atol);
+    return integrate(stepper, y0, t_out, y_out, options);
+}
+
+OdeSolution ode_solve(const CompiledFunction& rhs, const std::vector<double>& y0,
+                      const std::vector<double>& t_out, const OdeOptions& options) {
+    OdeSolution out;
+    out.y.assign(t_out.size() * y0.size(), std::numeric_limits<double>::quiet_NaN());
+    check_ode_problem(rhs, y0, t_out, options);
+    out.stats = ode_solve(rhs, y0, t_out, out.y.data(), options);
+    return out;
+}
+
+
+// ============================================================================
+// Adaptive Sampling for Plotting
+// ============================================================================
+
+namespace {
+    // Initial uniform intervals before adaptive refinement
+    constexpr int64_t kSampleInitialIntervals = 32;
+
+    struct SampleInterval {
+        double xl, yl, xr, yr, xm, ym;
+        double err;
+        bool operator<(const SampleInterval& other) const { return err < other.err; }
+    };
+
+    void check_unary(const CompiledFunction& f, int32_t inputs, const char* what) {
+        if (f.num_inputs() != inputs || f.num_outputs() != 1) {
+            throw std::runtime_error(std::string(what) + ": function must have " +
+                                     std::to_string(inputs) + " input(s) and one output");
+        }
+        if (f.is_complex()) {
+            throw std::runtime_error(std::string(what) + ": function was compiled in complex mode");
+        }
+    }
+
+    // Deviation of the midpoint from the chord, relative to the y-range;
+    // infinite where the function is defined on only part of the interval
+    double chord_error(double yl, double ym, double yr, double scale) {
+        int finite = std::isfinite(yl) + std::isfinite(ym) + std::isfinite(yr);
+        if (finite == 0) return 0.0;
+        if (finite < 3) return std::numeric_limits<double>::infinity();
+        return std::fabs(ym - 0.5 * (yl + yr)) / scale;
+    }
+}
+
+SampledCurve sample(const CompiledFunction& f, double a, double b, int64_t max_points, double tol) {
+    check_unary(f, 1, "sample");
+    if (!(a < b) || !std::isfinite(a) || !std::isfinite(b)) {
+        throw std::runtime_error("sample: need finite a < b");
+    }
+    if (max_points < 3) {
+        throw std::runtime_error("sample: max_points must be at least 3");
+    }
+    SampledCurve out;
+    auto eval = [&f, &out](double x) {
+        double y;
+        f.eval(&x, &y);
+        ++out.evaluations;
+        return y;
+    };
+
+    // Uniform start: the endpoints of n intervals plus their midpoints
+    int64_t n = std::min<int64_t>(kSampleInitialIntervals, (max_points - 1) / 2);
+    std::vector<double> xs(2 * n + 1), ys(2 * n + 1);
+    for (int64_t k = 0; k <= 2 * n; ++k) {
+        xs[k] = k == 2 * n ? b : a + (b - a) * static_cast<double>(k) / (2 * n);
+        ys[k] = eval(xs[k]);
+    }
+    double lo = std::numeric_limits<double>::infinity(), hi = -lo;
+    for (double y : ys) {
+        if (std::isfinite(y)) {
+            lo = std::min(lo, y);
+            hi = std::max(hi, y);
+        }
+    }
+    double scale = hi > lo ? hi - lo : (std::isfinite(lo) ? std::max(std::fabs(lo), 1.0) : 1.0);
+
+    std::priority_queue<SampleInterval> queue;
+    for (int64_t k = 0; k < n; ++k) {
+        SampleInterval s{xs[2 * k], ys[2 * k], xs[2 * k + 2], ys[2 * k + 2], xs[2 * k + 1], ys[2 * k + 1], 0.0};
+        s.err = chord_error(s.yl, s.ym, s.yr, scale);
+        queue.push(s);
+    }
+    std::vector<std::pair<double, double>> points;
+    points.reserve(static_cast<size_t>(max_points) + 16);
+    for (int64_t k = 0; k <= 2 * n; ++k) points.emplace_back(xs[k], ys[k]);
+
+    // Split the worst interval until all are within tol or the budget is
+    // spent; each split adds its two new midpoints to the output, and each
+    // break one NaN point
+    const double min_width = (b - a) * 1e-9;
+    std::vector<double> breaks;
+    while (!queue.empty() && queue.top().err > tol &&
+           static_cast<int64_t>(points.size() + breaks.size()) + 2 <= max_points) {
+        SampleInterval s = queue.top();
+        queue.pop();
+        if (s.xr - s.xl < min_width) {
+            // Still failing at this width: a jump or an edge of the domain
+            if (std::isfinite(s.yl) && std::isfinite(s.yr)) breaks.push_back(s.xm);
+            continue;
+        }
+        double x1 = 0.5 * (s.xl + s.xm), x2 = 0.5 * (s.xm + s.xr);
+        double y1 = eval(x1), y2 = eval(x2);
+        points.emplace_back(x1, y1);
+        points.emplace_back(x2, y2);
+        SampleInterval left{s.xl, s.yl, s.xm, s.ym, x1, y1, 0.0};
+        SampleInterval right{s.xm, s.ym, s.xr, s.yr, x2, y2, 0.0};
+        left.err = chord_error(left.yl, left.ym, left.yr, scale);
+        right.err = chord_error(right.yl, right.ym, right.yr, scale);
+        queue.push(left);
+        queue.push(right);
+    }
+    for (double x : breaks) points.emplace_back(x, std::numeric_limits<double>::quiet_NaN());
+
+    std::sort(points.begin(), points.end(),
+              [](const std::pair<double, double>& p, const std::pair<double, double>& q) {
+                  return p.first < q.first;
+              });
+    out.x.reserve(points.size());
+    out.y.reserve(points.size());
+    for (const auto& p : points) {
+        out.x.push_back(p.first);
+        out.y.push_back(p.second);
+    }
+    return out;
+}
+
+SampledCurve sample(const Gen& expr, const std::string& var, double a, double b,
+                    int64_t max_points, double tol) {
+    return sample(CompiledFunction({expr}, {var}), a, b, max_points, tol);
+}
+
+SampledGrid sample_grid(const CompiledFunction& f, double x0, double x1, int64_t nx,
+                        double y0, double y1, int64_t ny, int32_t num_threads) {
+    check_unary(f, 2, "sample_grid");
+    if (nx < 2 || ny < 2) {
+        throw std::runtime_error("sample_grid: need at least 2 points per axis");
+    }
+    SampledGrid out;
+    out.nx = nx;
+    out.ny = ny;
+    out.x.resize(static_cast<size_t>(nx));
+    out.y.resize(static_cast<size_t>(ny));
+    for (int64_t i = 0; i < nx; ++i) {
+        out.x[i] = i == nx - 1 ? x1 : x0 + (x1 - x0) * static_cast<double>(i) / (nx - 1);
+    }
+    for (int64_t j = 0; j < ny; ++j) {
+        out.y[j] = j == ny - 1 ? y1 : y0 + (y1 - y0) * static_cast<double>(j) / (ny - 1);
+    }
+    out.z.resize(static_cast<size_t>(nx * ny));
+    // One task per grid row
+    WorkerPool::instance().run(static_cast<size_t>(ny), num_threads, [&](size_t j) {
+        double xy[2] = {0.0, out.y[j]};
+        for (int64_t i = 0; i < nx; ++i) {
+            xy[0] = out.x[i];
+            f.eval(xy, &out.z[j * nx + i]);
+        }
+    });
+    return out;
+}
+
+SampledGrid sample_grid(const Gen& expr, const std::string& xvar, const std::string& yvar,
+                        double x0, double x1, int64_t nx, double y0, double y1, int64_t ny,
+                        int32_t num_threads) {
+    return sample_grid(CompiledFunction({expr}, {xvar, yvar}), x0, x1, nx, y0, y1, ny, num_threads);
+}
+
+
+// ============================================================================
+// Numerical Quadrature
+// ============================================================================
+
+namespace {
+    // Nodes evaluated per task
+    constexpr size_t kQuadPointsPerTask = 256;
+    // Last tanh-sinh level, h = 2^-12
+    constexpr int kTanhSinhMaxLevel = 12;
+
+    // 7-point Gauss / 15-point Kronrod pair (QUADPACK qk15); the Gauss
+    // nodes are kKronrodX[1], [3], [5] and the centre
+    const double kKronrodX[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.0};
+    const double kKronrodW[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+    const double kGaussW[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+    // f(x, params) over a list of nodes, in parallel chunks
+    class QuadIntegrand {
+    public:
+        QuadIntegrand(const CompiledFunction& f, const double* params, int32_t num_threads)
+            : f_(f), params_(params), num_threads_(num_threads) {}
+
+        void eval(const std::vector<double>& xs, std::vector<double>& ys) {
+            ys.resize(xs.size());
+            evaluations += static_cast<int64_t>(xs.size());
+            const size_t nin = static_cast<size_t>(f_.num_inputs());
+            size_t tasks = (xs.size() + kQuadPointsPerTask - 1) / kQuadPointsPerTask;
+            WorkerPool::instance().run(tasks, num_threads_, [&](size_t t) {
+                std::vector<double> in(nin);
+                std::copy(params_, params_ + (nin - 1), in.begin() + 1);
+                size_t end = std::min(xs.size(), (t + 1) * kQuadPointsPerTask);
+                for (size_t k = t * kQuadPointsPerTask; k < end; ++k) {
+                    in[0] = xs[k];
+                    f_.eval(in.data(), &ys[k]);
+                }
+            });
+        }
+
+        int64_t evaluations = 0;
+
+    private:
+        const CompiledFunction& f_;
+        const double* params_;
+        int32_t num_threads_;
+    };
+
+    struct GkInterval {
+        double a, b, value, error;
+    };
+
+    void gk_nodes(double a, double b, double* x) {
+        double c = 0.5 * (a + b), h = 0.5 * (b - a);
+        x[0] = c;
+        for (int j = 0; j < 7; ++j) {
+            x[1 + 2 * j] = c - h * kKronrodX[j];
+            x[2 + 2 * j] = c + h * kKronrodX[j];
+        }
+    }
+
+    // Kronrod estimate, with |K15 - G7| as its error
+    void gk_combine(GkInterval& iv, const double* y) {
+        double k = kKronrodW[7] * y[0], g = kGaussW[3] * y[0];
+        for (int j = 0; j < 7; ++j) {
+            double s = y[1 + 2 * j] + y[2 + 2 * j];
+            k += kKronrodW[j] * s;
+            if (j % 2 == 1) g += kGaussW[j / 2] * s;
+        }
+        double h = 0.5 * (iv.b - iv.a);
+        iv.value = k * h;
+        iv.error = std::fabs(k - g) * h;
+    }
+
+    QuadResult gauss_kronrod(QuadIntegrand& f, double a, double b, const QuadOptions& options) {
+        QuadResult r;
+        std::vector<GkInterval> intervals{{a, b, 0.0, 0.0}};
+        std::vector<size_t> fresh{0};
+        std::vector<double> xs, ys;
+        const double width = b - a;
+        while (true) {
+            // Evaluate the intervals created by the last round in one batch
+            xs.resize(15 * fresh.size());
+            for (size_t k = 0; k < fresh.size(); ++k) {
+                gk_nodes(intervals[fresh[k]].a, intervals[fresh[k]].b, &xs[15 * k]);
+            }
+            f.eval(xs, ys);
+            if (!all_finite(ys)) {
+                r.status = QUAD_NOT_FINITE;
+                r.value = r.error = std::numeric_limits<double>::quiet_NaN();
+                break;
+            }
+            for (size_t k = 0; k < fresh.size(); ++k) gk_combine(intervals[fresh[k]], &ys[15 * k]);
+
+            r.value = r.error = 0.0;
+            for (const GkInterval& iv : intervals) {
+                r.value += iv.value;
+                r.error += iv.error;
+            }
+            double tol = std::max(options.atol, options.rtol * std::fabs(r.value));
+            if (r.error <= tol) break;
+
+            // Bisect every interval over its share of the tolerance, worst
+            // first, while the budget lasts
+            std::vector<size_t> split;
+            for (size_t k = 0; k < intervals.size(); ++k) {
+                const GkInterval& iv = intervals[k];
+                double mid = 0.5 * (iv.a + iv.b);
+                if (iv.error > tol * (iv.b - iv.a) / width && mid > iv.a && mid < iv.b) {
+                    split.push_back(k);
+                }
+            }
+            std::stable_sort(split.begin(), split.end(), [&intervals](size_t p, size_t q) {
+                return intervals[p].error > intervals[q].error;
+            });
+            size_t room = options.max_intervals > static_cast<int64_t>(intervals.size())
+                              ? static_cast<size_t>(options.max_intervals) - intervals.size() : 0;
+            if (split.size() > room) split.resize(room);
+            if (split.empty()) {
+                r.status = QUAD_NOT_CONVERGED;
+                break;
+            }
+            std::sort(split.begin(), split.end());
+            fresh.clear();
+            for (size_t k : split) {
+                double mid = 0.5 * (intervals[k].a + intervals[k].b);
+                intervals.push_back({mid, intervals[k].b, 0.0, 0.0});
+                intervals[k].b = mid;
+                fresh.push_back(k);
+                fresh.push_back(intervals.size() - 1);
+            }
+        }
+        r.subdivisions = static_cast<int64_t>(intervals.size());
+        return r;
+    }
+
+    // x = c + d tanh(pi/2 sinh t). Nodes are placed by their distance to
+    // the nearer endpoint, so they approach a singular end without
+    // cancellation and never land on it.
+    QuadResult tanh_sinh(QuadIntegrand& f, double a, double b, const QuadOptions& options) {
+        QuadResult r;
+        const double d = 0.5 * (b - a), half_pi = 2.0 * std::atan(1.0);
+        std::vector<double> xs, ws, ys;
+        // Weighted sum over all nodes so far, in units of h
+        double sum = 0.0, previous = 0.0;
+        for (int level = 0; level <= kTanhSinhMaxLevel; ++level) {
+            double h = std::ldexp(1.0, -level);
+            xs.clear();
+            ws.clear();
+            if (level == 0) {
+                xs.push_back(a + d);
+                ws.push_back(d * half_pi);
+            }
+            // Level 0 takes t = 1, 2, ...; later levels the odd multiples of h
+            for (int64_t j = 1;; j += level == 0 ? 1 : 2) {
+                double t = static_cast<double>(j) * h;
+                double u = half_pi * std::sinh(t);
+                double gap = 2.0 * d / (std::exp(2.0 * u) + 1.0);
+                double cu = std::cosh(u);
+                double w = d * half_pi * std::cosh(t) / (cu * cu);
+                bool left = a + gap > a, right = b - gap < b;
+                if ((!left && !right) || !(w > 0)) break;
+                if (left) {
+                    xs.push_back(a + gap);
+                    ws.push_back(w);
+                }
+                if (right) {
+                    xs.push_back(b - gap);
+                    ws.push_back(w);
+                }
+            }
+            f.eval(xs, ys);
+            if (!all_finite(ys)) {
+                r.status = QUAD_NOT_FINITE;
+                r.value = r.error = std::numeric_limits<double>::quiet_NaN();
+                r.subdivisions = level + 1;
+                return r;
+            }
+            for (size_t k = 0; k < xs.size(); ++k) sum += ws[k] * ys[k];
+            r.value = h * sum;
+            r.subdivisions = level + 1;
+            if (level >= 2) {
+                r.error = std::fabs(r.value - previous);
+                if (r.error <= std::max(options.atol, options.rtol * std::fabs(r.value))) return r;
+            }
+            previous = r.value;
+        }
+        r.status = QUAD_NOT_CONVERGED;
+        return r;
+    }
+
+    void check_quad_problem(double a, double b, const QuadOptions& options, const char* what) {
+        if (!std::isfinite(a) || !std::isfinite(b)) {
+            throw std::runtime_error(std::string(what) + ": bounds must be finite");
+        }
+        if (!(options.rtol >= 0) || !(options.atol >= 0) || options.rtol + options.atol <= 0) {
+            throw std::runtime_error(std::string(what) + ": tolerances must be non-negative and not both zero");
+        }
+        if (options.method != QUAD_GAUSS_KRONROD && options.method != QUAD_TANH_SINH) {
+            throw std::runtime_error(std::string(what) + ": unknown method " + std::to_string(options.method));
+        }
+    }
+
+    QuadResult quad_one(const CompiledFunction& f, const double* params, double a, double b,
+                        const QuadOptions& options, int32_t num_threads) {
+        if (a == b) return QuadResult();
+        QuadIntegrand integrand(f, params, num_threads);
+        double lo = std::min(a, b), hi = std::max(a, b);
+        QuadResult r = options.method == QUAD_TANH_SINH ? tanh_sinh(integrand, lo, hi, options)
+                                                         : gauss_kronrod(integrand, lo, hi, options);
+        if (b < a) r.value = -r.value;
+        r.evaluations = integrand.evaluations;
+        return r;
+    }
+}
+
+QuadOptions make_quad_options(int32_t method, double rtol, double atol, int32_t num_threads) {
+    QuadOptions options;
+    options.method = method;
+    options.rtol = rtol;
+    options.atol = atol;
+    options.num_threads = num_threads;
+    return options;
+}
+
+QuadResult quad(const CompiledFunction& f, double a, double b, const QuadOptions& options) {
+    check_unary(f, 1, "quad");
+    check_quad_problem(a, b, options, "quad");
+    return quad_one(f, nullptr, a, b, options, options.num_threads);
+}
+
+QuadResult quad(const Gen& expr, const std::string& var, double a, double b,
+                const QuadOptions& options) {
+    return quad(CompiledFunction({expr}, {var}), a, b, options);
+}
+
+std::vector<QuadResult> quad_batch(const CompiledFunction& f, double a, double b,
+                                   const std::vector<double>& params, const QuadOptions& options) {
+    if (f.num_inputs() < 2 || f.num_outputs() != 1) {
+        throw std::runtime_error("quad_batch: function must map (x, p1..pk) to one output");
+    }
+    if (f.is_complex()) {
+        throw std::runtime_error("quad_batch: function was compiled in complex mode");
+    }
+    check_quad_problem(a, b, options, "quad_batch");
+    const size_t k = static_cast<size_t>(f.num_inputs()) - 1;
+    if (params.size() % k != 0) {
+        throw std::runtime_error("quad_batch: params must hold a multiple of " + std::to_string(k) + " values");
+    }
+    std::vector<QuadResult> out(params.size() / k);
+    WorkerPool::instance().run(out.size(), options.num_threads, [&](size_t p) {
+        out[p] = quad_one(f, params.data() + p * k, a, b, options, 1);
+    });
+    return out;
+}
+
+
+// ============================================================================
+// Interval Evaluation
+// ============================================================================
+
+namespace {
+    // Outward rounding: one ulp for the correctly rounded IEEE operations,
+    // two for libm functions (glibc documents at most 2 ulp for these)
+    constexpr int kLibmUlps = 2;
+    // Beyond this magnitude periodic functions are bounded by [-1, 1]
+    constexpr double kMaxReducible = 1e15;
+
+    // [lo, hi]; NaN bounds mean empty (no point of the box in the domain)
+    struct Interval {
+        double lo, hi;
+    };
+
+    const Interval kEmpty{std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+    const Interval kEntire{-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+
+    bool empty(const Interval& x) {
+        return std::isnan(x.lo);
+    }
+
+    double down(double x, int ulps = 1) {
+        for (int k = 0; k < ulps; ++k) x = std::nextafter(x, -std::numeric_limits<double>::infinity());
+        return x;
+    }
+
+    double up(double x, int ulps = 1) {
+        for (int k = 0; k < ulps; ++k) x = std::nextafter(x, std::numeric_limits<double>::infinity());
+        return x;
+    }
+
+    // Enclosure of a nondecreasing libm function over x
+    template <class F>
+    Interval increasing(F f, const Interval& x) {
+        return {down(f(x.lo), kLibmUlps), up(f(x.hi), kLibmUlps)};
+    }
+
+    // 0 * inf counts as 0: the zero is exact, the infinity only a bound
+    double mul_bound(double a, double b) {
+        return a == 0 || b == 0 ? 0.0 : a * b;
+    }
+
+    Interval mul(const Interval& x, const Interval& y) {
+        double p[4] = {mul_bound(x.lo, y.lo), mul_bound(x.lo, y.hi), mul_bound(x.hi, y.lo), mul_bound(x.hi, y.hi)};
+        return {down(*std::min_element(p, p + 4)), up(*std::max_element(p, p + 4))};
+    }
+
+    Interval inv(const Interval& y) {
+        if (y.lo <= 0 && y.hi >= 0) return y.lo == 0 && y.hi == 0 ? kEmpty : kEntire;
+        return {down(1.0 / y.hi), up(1.0 / y.lo)};
+    }
+
+    // [lo, hi] intersected with [min, max]; empty when they do not meet
+    Interval clamp(const Interval& x, double min, double max) {
+        if (x.hi < min || x.lo > max) return kEmpty;
+        return {std::max(x.lo, min), std::min(x.hi, max)};
+    }
+
+    // Does x contain phase + k * period for some integer k? Errs towards
+    // yes, which only widens the enclosure.
+    bool contains_phase(const Interval& x, double phase, double period) {
+        double a = (x.lo - phase) / period, b = (x.hi - phase) / period;
+        double slack = 1e-12 * std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+        return std::floor(b + slack) >= std::ceil(a - slack);
+    }
+
+    // sin or cos over x; max_phase and min_phase locate the extrema
+    template <class F>
+    Interval periodic(F f, const Interval& x, double max_phase, double min_phase) {
+        const double two_pi = 8.0 * std::atan(1.0);
+        if (!(x.hi - x.lo < two_pi) || std::fabs(x.lo) > kMaxReducible || std::fabs(x.hi) > kMaxReducible) {
+            return {-1.0, 1.0};
+        }
+        double flo = f(x.lo), fhi = f(x.hi);
+        Interval r{down(std::min(flo, fhi), kLibmUlps), up(std::max(flo, fhi), kLibmUlps)};
+        if (contains_phase(x, max_phase, two_pi)) r.hi = 1.0;
+        if (contains_phase(x, min_phase, two_pi)) r.lo = -1.0;
+        return {std::max(r.lo, -1.0), std::min(r.hi, 1.0)};
+    }
+
+    // v^n for v >= 0, n >= 0, by squaring with outward rounding
+    Interval powi_nonnegative(const Interval& v, uint64_t n) {
+        Interval r{1.0, 1.0}, base = v;
+        while (n != 0) {
+            if (n & 1) r = mul(r, base);
+            base = mul(base, base);
+            n >>= 1;
+        }
+        return {std::max(r.lo, 0.0), r.hi};
+    }
+
+    Interval powi(const Interval& x, int64_t n) {
+        if (n == 0) return {1.0, 1.0};
+        uint64_t m = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+        Interval r;
+        if (m % 2 == 0 || x.lo >= 0) {
+            // Even powers of |x|, or odd powers of a nonnegative x
+            Interval a = x.lo >= 0 ? x : x.hi <= 0 ? Interval{-x.hi, -x.lo}
+                                                   : Interval{0.0, std::max(-x.lo, x.hi)};
+            r = {powi_nonnegative({a.lo, a.lo}, m).lo, powi_nonnegative({a.hi, a.hi}, m).hi};
+        } else {
+            // Odd power: monotone, so bound each endpoint through |endpoint|
+            auto bound = [m](double v, bool lower) {
+                Interval p = powi_nonnegative({std::fabs(v), std::fabs(v)}, m);
+                return v < 0 ? -(lower ? p.hi : p.lo) : (lower ? p.lo : p.hi);
+            };
+            r = {bound(x.lo, true), bound(x.hi, false)};
+        }
+        return n < 0 ? inv(r) : r;
+    }
+
+    // exp(y ln x) over the part of x with x >= 0
+    Interval pow_nonnegative(const Interval& x, const Interval& y) {
+        Interval base = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+        if (empty(base)) return kEmpty;
+        Interval l = base.lo == 0 ? Interval{-std::numeric_limits<double>::infinity(), up(std::log(base.hi), kLibmUlps)}
+                                  : increasing([](double v) { return std::log(v); }, base);
+        Interval e = mul(y, l);
+        return {std::max(0.0, down(std::exp(e.lo), kLibmUlps)), up(std::exp(e.hi), kLibmUlps)};
+    }
+
+    Interval hull(const Interval& x, const Interval& y) {
+        if (empty(x)) return y;
+        if (empty(y)) return x;
+        return {std::min(x.lo, y.lo), std::max(x.hi, y.hi)};
+    }
+
+    // Real pow as the point tape computes it: a negative base is in the
+    // domain only at integer exponents, where the sign depends on parity
+    Interval interval_pow(const Interval& x, const Interval& y) {
+        if (y.lo == y.hi && y.lo == std::floor(y.lo) && std::fabs(y.lo) < 0x1p62) {
+            return powi(x, static_cast<int64_t>(y.lo));
+        }
+        Interval r = pow_nonnegative(x, y);
+        if (x.lo < 0 && std::floor(y.hi) >= std::ceil(y.lo)) {
+            // Some integer exponent meets the negative part; bound it by
+            // its magnitude with either sign
+            Interval m = pow_nonnegative({x.hi < 0 ? -x.hi : 0.0, -x.lo}, y);
+            if (!empty(m)) r = hull(r, {-m.hi, m.hi});
+        }
+        return r;
+    }
+
+    Interval eval_interval_op(const TapeInstr& in, const Interval* r) {
+        const double pi = 4.0 * std::atan(1.0), inf = std::numeric_limits<double>::infinity();
+        const Interval& x = r[in.a];
+        const Interval& y = in.b >= 0 ? r[in.b] : x;
+        if (empty(x) || empty(y)) return kEmpty;
+        switch (in.op) {
+            case OP_ADD:   return {down(x.lo + y.lo), up(x.hi + y.hi)};
+            case OP_SUB:   return {down(x.lo - y.hi), up(x.hi - y.lo)};
+            case OP_MUL:   return mul(x, y);
+            case OP_DIV:   return mul(x, inv(y));
+            case OP_NEG:   return {-x.hi, -x.lo};
+            case OP_INV:   return inv(x);
+            case OP_POW:   return interval_pow(x, y);
+            case OP_POWI:  return powi(x, static_cast<int64_t>(in.c));
+            case OP_SQRT: {
+                Interval d = clamp(x, 0.0, inf);
+                if (empty(d)) return kEmpty;
+                return {std::max(0.0, down(std::sqrt(d.lo))), up(std::sqrt(d.hi))};
+            }
+            case OP_EXP: {
+                Interval e = increasing([](double v) { return std::exp(v); }, x);
+                return {std::max(0.0, e.lo), e.hi};
+            }
+            case OP_LN:
+            case OP_LOG10: {
+                Interval d = clamp(x, 0.0, inf);
+                if (empty(d)) return kEmpty;
+                auto f = [&in](double v) { return in.op == OP_LN ? std::log(v) : std::log10(v); };
+                return {d.lo == 0 ? -inf : down(f(d.lo), kLibmUlps), up(f(d.hi), kLibmUlps)};
+            }
+            case OP_SIN:   return periodic([](double v) { return std::sin(v); }, x, pi / 2, -pi / 2);
+            case OP_COS:   return periodic([](double v) { return std::cos(v); }, x, 0.0, pi);
+            case OP_TAN:
+                if (!(x.hi - x.lo < pi) || std::fabs(x.lo) > kMaxReducible || std::fabs(x.hi) > kMaxReducible ||
+                    contains_phase(x, pi / 2, pi)) {
+                    return kEntire;
+                }
+                return increasing([](double v) { return std::tan(v); }, x);
+            case OP_ASIN:
+            case OP_ACOS: {
+                Interval d = clamp(x, -1.0, 1.0);
+                if (empty(d)) return kEmpty;
+                if (in.op == OP_ASIN) return increasing([](double v) { return std::asin(v); }, d);
+                return {std::max(0.0, down(std::acos(d.hi), kLibmUlps)), up(std::acos(d.lo), kLibmUlps)};
+            }
+            case OP_ATAN:  return increasing([](double v) { return std::atan(v); }, x);
+            case OP_SINH:  return increasing([](double v) { return std::sinh(v); }, x);
+            case OP_COSH: {
+                double m = x.lo > 0 ? x.lo : x.hi < 0 ? -x.hi : 0.0;
+                double a = std::max(std::fabs(x.lo), std::fabs(x.hi));
+                return {std::max(1.0, down(std::cosh(m), kLibmUlps)), up(std::cosh(a), kLibmUlps)};
+            }
+            case OP_TANH: {
+                Interval t = increasing([](double v) { return std::tanh(v); }, x);
+                return {std::max(-1.0, t.lo), std::min(1.0, t.hi)};
+            }
+            case OP_ASINH: return increasing([](double v) { return std::asinh(v); }, x);
+            case OP_ACOSH: {
+                Interval d = clamp(x, 1.0, inf);
+                if (empty(d)) return kEmpty;
+                Interval a = increasing([](double v) { return std::acosh(v); }, d);
+                return {std::max(0.0, a.lo), a.hi};
+            }
+            case OP_ATANH: {
+                Interval d = clamp(x, -1.0, 1.0);
+                if (empty(d)) return kEmpty;
+                return {d.lo == -1 ? -inf : down(std::atanh(d.lo), kLibmUlps),
+                        d.hi == 1 ? inf : up(std::atanh(d.hi), kLibmUlps)};
+            }
+            case OP_ABS:
+                if (x.lo >= 0) return x;
+                if (x.hi <= 0) return {-x.hi, -x.lo};
+                return {0.0, std::max(-x.lo, x.hi)};
+            case OP_SIGN:  return {static_cast<double>((x.lo > 0) - (x.lo < 0)),
+                                   static_cast<double>((x.hi > 0) - (x.hi < 0))};
+            case OP_FLOOR: return {std::floor(x.lo), std::floor(x.hi)};
+            case OP_CEIL:  return {std::ceil(x.lo), std::ceil(x.hi)};
+            case OP_MIN:   return {std::min(x.lo, y.lo), std::min(x.hi, y.hi)};
+            case OP_MAX:   return {std::max(x.lo, y.lo), std::max(x.hi, y.hi)};
+            case OP_RE:
+            case OP_CONJ:  return x;
+            case OP_IM:    return {0.0, 0.0};
+            case OP_ARG:
+                if (x.lo >= 0) return {0.0, 0.0};
+                return {x.hi < 0 ? down(pi) : 0.0, up(pi)};
+            case OP_CONST:
+            case OP_INPUT:
+                break;
+        }
+        return kEmpty;
+    }
+
+    void run_interval_tape(const std::vector<TapeInstr>& code,
+                           const std::vector<std::pair<double, double>>& bounds,
+                           const double* lo, const double* hi, Interval* r) {
+        const size_t n = code.size();
+        for (size_t i = 0; i < n; ++i) {
+            const TapeInstr& in = code[i];
+            if (in.op == OP_CONST) {
+                r[i] = in.b == kRoundedConst ? Interval{bounds[in.a].first, bounds[in.a].second}
+                                             : Interval{in.c, in.c};
+            } else if (in.op == OP_INPUT) {
+                r[i] = lo[in.a] <= hi[in.a] ? Interval{lo[in.a], hi[in.a]} : kEmpty;
+            } else {
+                r[i] = eval_interval_op(in, r);
+            }
+        }
+    }
+
+    // A leaf is rounded once. A folded subtree is lowered again without
+    // folding and evaluated in interval arithmetic, so the error of every
+    // operation in it is accounted for. Operators the tape cannot run fall
+    // back to a widening that grows with the number of folded operations.
+    std::pair<double, double> constant_bounds(const giac::gen& g, double value, giac::context& ctx) {
+        if (g.type != giac::_SYMB) return {down(value), up(value)};
+        try {
+            TapeBuilder sub;
+            sub.fold = false;
+            std::unordered_map<const char*, int32_t> no_inputs;
+            std::unordered_map<const void*, int32_t> shared;
+            int32_t reg = lower_expr(sub, g, no_inputs, shared, ctx);
+            std::vector<Interval> r(sub.code.size());
+            run_interval_tape(sub.code, sub.bounds, nullptr, nullptr, r.data());
+            if (!empty(r[reg])) {
+                // giac's value is kept inside even where it disagrees
+                return {std::min(r[reg].lo, down(value)), std::max(r[reg].hi, up(value))};
+            }
+        } catch (const std::exception&) {
+        }
+        int ops = 0;
+        walk_tree(g, [&ops](const giac::gen& node, int32_t) {
+            ops += node.type == giac::_SYMB;
+            return true;
+        });
+        int ulps = (ops + 1) * (kLibmUlps + 1);
+        return {down(value, ulps), up(value, ulps)};
+    }
+}
+
+void CompiledFunction::eval_interval(const double* lo, const double* hi, double* out_lo, double* out_hi) const {
+    if (impl_->complex) {
+        throw std::runtime_error("CompiledFunction: interval evaluation needs a real-mode function");
+    }
+    thread_local std::vector<Interval> regs;
+    regs.resize(impl_->code.size());
+    run_interval_tape(impl_->code, impl_->bounds, lo, hi, regs.data());
+    for (size_t k = 0; k < impl_->outputs.size(); ++k) {
+        out_lo[k] = regs[impl_->outputs[k]].lo;
+        out_hi[k] = regs[impl_->outputs[k]].hi;
+    }
+}
+
+IntervalBounds CompiledFunction::eval_interval_batch(const std::vector<double>& lo, const std::vector<double>& hi,
+                                                     int32_t num_threads) const {
+    if (impl_->complex) {
+        throw std::runtime_error("CompiledFunction: interval evaluation needs a real-mode function");
+    }
+    size_t nin = impl_->vars.size();
+    size_t nout = impl_->outputs.size();
+    if (lo.size() != hi.size() || (nin == 0 ? !lo.empty() : lo.size() % nin != 0)) {
+        throw std::runtime_error("CompiledFunction: lo and hi must both have nboxes * num_inputs entries");
+    }
+    size_t nboxes = nin == 0 ? 0 : lo.size() / nin;
+    IntervalBounds out;
+    out.lo.resize(nboxes * nout);
+    out.hi.resize(nboxes * nout);
+    size_t tasks = (nboxes + kEvalPointsPerTask - 1) / kEvalPointsPerTask;
+    WorkerPool::instance().run(tasks, num_threads, [&](size_t t) {
+        size_t end = std::min(nboxes, (t + 1) * kEvalPointsPerTask);
+        for (size_t p = t * kEvalPointsPerTask; p < end; ++p) {
+            eval_interval(lo.data() + p * nin, hi.data() + p * nin, out.lo.data() + p * nout,
+                          out.hi.data() + p * nout);
+        }
+    });
+    return out;
+}
+
 } // namespace giac_julia
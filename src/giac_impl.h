@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <exception>
 #include <functional>
 #include <vector>
 
@@ -20,8 +21,20 @@ namespace giac_julia {
 // Forward declaration of opaque types
 struct GiacContextImpl;
 struct GenImpl;
+struct ExpressionReaderImpl;
+struct PolyImpl;
+struct CompiledFunctionImpl;
 class Gen;           // Forward declaration for free functions
 class GiacContext;   // Forward declaration for free functions taking a context
+class TryResult;     // Forward declaration for friends of Gen / GiacContext
+struct CscMatrix;    // Forward declaration for friends of Gen
+class Poly;          // Forward declaration for friends of Gen
+struct PolyFactorization;
+struct SparsePoly;
+struct ExactMatrix;   // Forward declaration for friends of Gen
+struct ExactInts;
+struct RootBatch;
+class CompiledFunction;  // Forward declaration for friends of Gen
 
 // ============================================================================
 // Version Functions
@@ -266,6 +279,244 @@ int gen_ptr_type(void* ptr);
  */
 Gen gen_from_heap_ptr(void* ptr);
 
+// ============================================================================
+// Vector Reductions
+// ============================================================================
+
+/**
+ * @brief Sum a list of terms by balanced pairwise reduction
+ * @param terms Terms to add
+ * @param num_threads 1 = calling thread only, 0 = all hardware threads,
+ *                    n > 1 = at most n threads (small inputs stay serial)
+ * @return Sum of the terms, evaluated once at the end; 0 for an empty list
+ * @note A left fold re-normalizes an ever-growing sum at every step, which
+ *       is quadratic in the number of terms; the pairwise tree is O(n log n).
+ */
+Gen vect_sum(const std::vector<Gen>& terms, int32_t num_threads);
+
+/**
+ * @brief Sum the elements of a _VECT Gen by balanced pairwise reduction
+ * @throws std::runtime_error if v is not a vector
+ */
+Gen vect_sum(const Gen& v, int32_t num_threads);
+
+/**
+ * @brief Multiply a list of factors by balanced pairwise reduction
+ * @return Product of the factors, evaluated once at the end; 1 for an empty list
+ */
+Gen vect_prod(const std::vector<Gen>& factors, int32_t num_threads);
+
+/**
+ * @brief Multiply the elements of a _VECT Gen by balanced pairwise reduction
+ * @throws std::runtime_error if v is not a vector
+ */
+Gen vect_prod(const Gen& v, int32_t num_threads);
+
+// ============================================================================
+// Vector Shape Census
+// ============================================================================
+
+/**
+ * @brief Shape and element-type summary of a (possibly nested) vector
+ *
+ * Filled by describe() in one native traversal so callers can pick a target
+ * element type and container shape without probing every element.
+ */
+struct GenDescription {
+    std::vector<int64_t> type_counts;   // leaf count indexed by gen type code (GENTYPE_*)
+    int32_t depth = 0;                  // vector nesting depth, 0 for a scalar
+    std::vector<int64_t> dims;          // size per nesting level, empty unless rectangular
+    bool rectangular = false;           // every leaf at the same depth, equal sizes per level
+    bool all_immediate_numeric = false; // every leaf is _INT_ or _DOUBLE_
+    int64_t node_count = 0;             // vectors plus leaves visited
+};
+
+/**
+ * @brief Census of a Gen's nested _VECT structure
+ * @param g Any Gen; non-vectors are reported as a single leaf of depth 0
+ * @return Type histogram, nesting depth, rectangular dims and node count
+ * @note Only _VECT nodes are descended into; symbolic leaves are not expanded.
+ */
+GenDescription describe(const Gen& g);
+
+/**
+ * @brief Flatten the leaves of a nested vector into doubles
+ * @return Leaves in traversal (row-major) order
+ * @throws std::runtime_error if a leaf is not _INT_ or _DOUBLE_
+ */
+std::vector<double> flatten_doubles(const Gen& g);
+
+/**
+ * @brief Flatten the leaves of a nested vector into 64-bit integers
+ * @return Leaves in traversal (row-major) order
+ * @throws std::runtime_error if a leaf is not _INT_
+ */
+std::vector<int64_t> flatten_int64s(const Gen& g);
+
+// ============================================================================
+// Expression Tree Folds
+// ============================================================================
+
+/**
+ * @brief Reducers selectable in fold_tree() (bit flags, combine with |)
+ */
+enum TreeReducer : int32_t {
+    TREE_NODE_COUNT    = 1 << 0,
+    TREE_DEPTH         = 1 << 1,
+    TREE_IDENTIFIERS   = 1 << 2,
+    TREE_OPERATORS     = 1 << 3,
+    TREE_NUMERIC_RANGE = 1 << 4,
+    TREE_ALL           = (1 << 5) - 1,
+};
+
+/**
+ * @brief Result of fold_tree(); fields of unselected reducers stay empty/zero
+ */
+struct TreeSummary {
+    int64_t node_count = 0;                   // TREE_NODE_COUNT
+    int32_t depth = 0;                        // TREE_DEPTH (a leaf has depth 1)
+    std::vector<std::string> identifiers;     // TREE_IDENTIFIERS, sorted and unique
+    std::vector<std::string> operator_names;  // TREE_OPERATORS, sorted
+    std::vector<int64_t> operator_counts;     // parallel to operator_names
+    int64_t numeric_leaf_count = 0;           // TREE_NUMERIC_RANGE
+    double numeric_min = 0.0;                 // valid when numeric_leaf_count > 0
+    double numeric_max = 0.0;
+};
+
+/**
+ * @brief Run the selected reducers over an expression tree in one pass
+ * @param g Expression to walk
+ * @param reducers Bitwise OR of TreeReducer flags
+ * @return Summary with the selected fields filled
+ * @note Walks _SYMB arguments, _VECT elements, _CPLX parts, non-numeric
+ *       _FRAC parts and _MAP entries with an explicit stack, so arbitrarily
+ *       deep trees do not overflow. Integer fractions count as numeric leaves.
+ */
+TreeSummary fold_tree(const Gen& g, int32_t reducers);
+
+/**
+ * @brief Check whether a function/operator appears anywhere in a tree
+ * @param name Operator name as reported by symb_sommet_name() (e.g. "sin", "+")
+ * @note Stops at the first match.
+ */
+bool contains_function(const Gen& g, const std::string& name);
+
+// ============================================================================
+// Interned Names
+// ============================================================================
+
+/**
+ * @brief Intern a name in the process-wide symbol table
+ * @return Stable id; the same name always maps to the same id in this process
+ * @note Ids are dense and start at 0; they are shared by Gen::symb_sommet_id()
+ *       and Gen::idnt_id(), so callers can resolve e.g. "+" once up front.
+ */
+uint32_t intern_name(const std::string& name);
+
+/**
+ * @brief Name registered under an interned id
+ * @throws std::runtime_error if id has not been assigned
+ */
+std::string id_to_name(uint32_t id);
+
+/**
+ * @brief All interned names, indexed by id
+ * @note Fetch once and extend incrementally: ids only ever get appended, so
+ *       a table of size n stays a valid prefix of every later snapshot.
+ */
+std::vector<std::string> id_to_name_table();
+
+// ============================================================================
+// Native Printers
+// ============================================================================
+
+/**
+ * @brief Print a Gen directly in Julia syntax
+ * @param g Expression to print
+ * @param broadcast Emit dotted operators and calls (`.+`, `.*`, `.^`,
+ *                  `sin.(x)`) so the result evaluates elementwise when
+ *                  variables are bound to arrays
+ * @return Julia source text, e.g. "x ^ 2 + 3 * y", "(1//2)", "1 + 2 * im"
+ * @note Rationals print as `//`, the imaginary unit as `im`, matrices as
+ *       `[a b; c d]` with non-atomic entries parenthesized. giac function
+ *       names are mapped to their Julia equivalents (ln -> log,
+ *       re -> real, ...). Text is written into a reused per-thread buffer
+ *       without per-node string temporaries.
+ */
+std::string to_julia_syntax(const Gen& g, bool broadcast);
+
+/**
+ * @brief Render a Gen as LaTeX math (no surrounding `$` delimiters)
+ * @param g Expression to render
+ * @param max_bytes Byte budget for the output (<= 0 for unlimited)
+ * @return LaTeX text; when the budget is hit, rendering stops and
+ *         `\ldots` marks the elided part
+ * @note The budget is checked between nodes, so cost is proportional to
+ *       the budget rather than the expression size. Delimiters of nodes
+ *       already open are still closed, which may add a few bytes past
+ *       max_bytes.
+ */
+std::string to_latex(const Gen& g, int64_t max_bytes);
+
+/**
+ * @brief Render a Gen as a presentation MathML `<math>` element
+ * @param g Expression to render
+ * @param max_bytes Byte budget for the output (<= 0 for unlimited)
+ * @return MathML text; when the budget is hit, rendering stops and
+ *         `<mi>&#x2026;</mi>` marks the elided part. Open elements are
+ *         closed so the document stays well formed, and child slots
+ *         after the marker (a denominator, an exponent) hold `<mrow/>` so
+ *         `<mfrac>` and `<msup>` keep two children.
+ */
+std::string to_mathml(const Gen& g, int64_t max_bytes);
+
+/**
+ * @brief Result of Gen::to_string_limited
+ */
+struct LimitedString {
+    std::string text;   ///< Printed text, with "..." where parts were cut
+    bool truncated;     ///< True if any budget cut the output
+};
+
+// ============================================================================
+// Streaming Serialization
+// ============================================================================
+
+/**
+ * @brief Encodings for write_gen / read_gen
+ */
+enum GenFormat : int32_t {
+    GEN_FORMAT_TEXT = 0,    ///< giac source text, read back by parsing only
+    GEN_FORMAT_BINARY = 1,  ///< Tagged preorder tree, structure-exact
+};
+
+/**
+ * @brief Stream a Gen to an open file descriptor
+ * @param g Value to write
+ * @param fd Writable descriptor; not closed
+ * @param format GEN_FORMAT_TEXT or GEN_FORMAT_BINARY
+ * @throws std::runtime_error on write failure, unknown format, or an
+ *         operator whose name does not resolve back to the same function;
+ *         text also rejects non-finite doubles and vector subtypes other
+ *         than list, seq, set, poly1 and matrix
+ * @note Output goes through a fixed 64 KiB buffer that is flushed as it
+ *       fills, so peak memory does not grow with the expression size (a
+ *       single huge integer or string leaf is buffered whole).
+ */
+void write_gen(const Gen& g, int32_t fd, int32_t format);
+
+/**
+ * @brief Read a Gen written by write_gen from a file descriptor
+ * @param fd Readable descriptor positioned at the start of the data
+ * @param format The format used when writing
+ * @throws std::runtime_error on truncated or corrupt input
+ * @note Text is parsed, never evaluated, so unevaluated expressions come
+ *       back unchanged. The binary reader keeps its own stack, so nesting
+ *       depth is limited only by memory; text depth is limited by giac's
+ *       recursive parser.
+ */
+Gen read_gen(int32_t fd, int32_t format);
+
 // ============================================================================
 // GiacContext - Opaque wrapper around giac::context
 // ============================================================================
@@ -305,8 +556,9 @@ public:
 private:
     std::unique_ptr<GiacContextImpl> impl_;
 
-    // Free function that needs access to the underlying giac::context*.
+    // Free functions that need access to the underlying giac::context*.
     friend Gen giac_eval(const std::string& expr, GiacContext& ctx);
+    friend TryResult try_eval(const std::string& expr, GiacContext& ctx);
 };
 
 // ============================================================================
@@ -331,6 +583,14 @@ public:
 
     // String conversion
     std::string to_string() const;
+    // Budgeted printing for display: stops at max_chars, prints "..." for
+    // subtrees below max_depth and for vector elements past max_elems.
+    // Each limit <= 0 disables it. Cost is bounded by the budget, not the
+    // expression size; small subtrees print exactly as to_string() does.
+    // Tables are walked entry by entry; objects that cannot be sized
+    // (polynomials, user types) print as "..." under a char budget.
+    LimitedString to_string_limited(int64_t max_chars, int32_t max_depth,
+                                    int64_t max_elems) const;
 
     // Type information
     int type() const;
@@ -364,10 +624,12 @@ public:
 
     // _SYMB type
     std::string symb_sommet_name() const;
+    uint32_t symb_sommet_id() const;   // interned id of symb_sommet_name()
     Gen symb_feuille() const;
 
     // _IDNT type
     std::string idnt_name() const;
+    uint32_t idnt_id() const;          // interned id of the identifier name
 
     // _STRNG type
     std::string strng_value() const;
@@ -471,8 +733,1122 @@ private:
 
     // Gen pointer reconstruction (Feature 052: direct to_symbolics)
     friend Gen gen_from_heap_ptr(void* ptr);
+
+    // Vector reductions
+    friend Gen vect_sum(const std::vector<Gen>& terms, int32_t num_threads);
+    friend Gen vect_sum(const Gen& v, int32_t num_threads);
+    friend Gen vect_prod(const std::vector<Gen>& factors, int32_t num_threads);
+    friend Gen vect_prod(const Gen& v, int32_t num_threads);
+
+    // Vector shape census
+    friend GenDescription describe(const Gen& g);
+    friend std::vector<double> flatten_doubles(const Gen& g);
+    friend std::vector<int64_t> flatten_int64s(const Gen& g);
+
+    // Expression tree folds
+    friend TreeSummary fold_tree(const Gen& g, int32_t reducers);
+    friend bool contains_function(const Gen& g, const std::string& name);
+
+    // Native printers
+    friend std::string to_julia_syntax(const Gen& g, bool broadcast);
+    friend std::string to_latex(const Gen& g, int64_t max_bytes);
+    friend std::string to_mathml(const Gen& g, int64_t max_bytes);
+
+    // Streaming serialization
+    friend void write_gen(const Gen& g, int32_t fd, int32_t format);
+    friend Gen read_gen(int32_t fd, int32_t format);
+
+    // Batch parser builds Gens directly
+    friend class ExpressionReader;
+
+    // No-throw variants
+    friend TryResult try_eval(const std::string& expr);
+    friend TryResult try_eval(const std::string& expr, GiacContext& ctx);
+
+    // Sparse matrices
+    friend Gen csc_to_gen(const CscMatrix& m);
+    friend CscMatrix gen_to_csc(const Gen& m, int64_t rows, int64_t cols);
+    // Polynomial handle converts from / to Gen
+    friend class Poly;
+    // Multipoint substitution
+    friend std::vector<Gen> subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                                       const std::vector<Gen>& values, int32_t num_threads);
+    friend ExactMatrix subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                                  const ExactMatrix& values, int32_t num_threads);
+    // Compiled numeric evaluation reads the expression trees
+    friend class CompiledFunction;
+    // Batch root finding returns multiprecision roots
+    friend RootBatch proot_batch(const std::vector<double>& coeffs,
+                                 const std::vector<int64_t>& offsets,
+                                 int32_t digits, int32_t num_threads);
+    friend RootBatch proot_batch(const ExactInts& coeffs, const std::vector<int64_t>& offsets,
+                                 int32_t digits, int32_t num_threads);
+};
+
+// ============================================================================
+// ExpressionReader - Streaming batch parser for expression files
+// ============================================================================
+
+/**
+ * @brief Per-line outcome codes
+ */
+enum GiacStatus : int32_t {
+    GIAC_STATUS_OK = 0,
+    GIAC_STATUS_PARSE_ERROR = 1,
+    GIAC_STATUS_EVAL_ERROR = 2,
+    GIAC_STATUS_EMPTY = 3,          ///< Blank line, nothing parsed
+    GIAC_STATUS_INVALID_ARGUMENT = 5,  ///< Input rejected before evaluation
+};
+
+/**
+ * @brief One batch of lines from an ExpressionReader
+ */
+struct ExpressionBatch {
+    std::vector<Gen> values;          ///< One per line; 0 where status != OK
+    std::vector<int32_t> status;      ///< GiacStatus per line
+    std::vector<std::string> errors;  ///< Message per line, empty when OK
+    int64_t first_line;               ///< 1-based line number of values[0]
+    int64_t error_count;              ///< Lines with a parse or eval error
+};
+
+/**
+ * @brief Reads a file of one-expression-per-line in batches
+ *
+ * The file is streamed through a fixed read buffer, so memory is bounded
+ * by the batch size rather than the file size. A malformed line only sets
+ * its own status; the rest of the batch is unaffected.
+ */
+class ExpressionReader {
+public:
+    /**
+     * @param path File to read
+     * @param evaluate false to parse only (no eval). Lines are evaluated
+     *        in file order in a context owned by the reader, so `:=`
+     *        bindings made by one line are seen by the lines after it and
+     *        by no other context.
+     * @param num_threads Threads used to parse each batch (1 = serial,
+     *        0 = all hardware threads); evaluation is always sequential
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    ExpressionReader(const std::string& path, bool evaluate, int32_t num_threads);
+    ~ExpressionReader();
+
+    // Non-copyable
+    ExpressionReader(const ExpressionReader&) = delete;
+    ExpressionReader& operator=(const ExpressionReader&) = delete;
+
+    /**
+     * @brief Parse up to max_lines further lines
+     * @return The batch; fewer than max_lines entries only at end of file
+     * @throws std::runtime_error if reading the file fails
+     */
+    ExpressionBatch next_batch(int64_t max_lines);
+
+    /**
+     * @brief True once every line has been returned
+     * @throws std::runtime_error if reading the file fails
+     */
+    bool at_end();
+    int64_t lines_read() const;
+
+private:
+    std::unique_ptr<ExpressionReaderImpl> impl_;
+};
+
+// ============================================================================
+// No-throw Variants (status code instead of exception)
+// ============================================================================
+
+/**
+ * @brief Outcome of a try_* call: a value or a status code
+ *
+ * Failures are captured, not thrown, so nothing unwinds across the FFI
+ * boundary. The error message is only built when message() is called.
+ */
+class TryResult {
+public:
+    TryResult(Gen value, int32_t status, std::exception_ptr error, std::string detail);
+
+    bool ok() const { return status_ == GIAC_STATUS_OK; }
+    int32_t status() const { return status_; }  ///< GiacStatus code
+    const Gen& value() const { return value_; }  ///< 0 unless ok()
+    std::string message() const;                 ///< Empty when ok()
+
+private:
+    Gen value_;
+    int32_t status_;
+    std::exception_ptr error_;
+    std::string detail_;  // offending token for parse errors
+};
+
+/**
+ * @brief No-throw giac_eval: parse errors give GIAC_STATUS_PARSE_ERROR,
+ *        evaluation failures GIAC_STATUS_EVAL_ERROR
+ */
+TryResult try_eval(const std::string& expr);
+TryResult try_eval(const std::string& expr, GiacContext& ctx);
+
+// No-throw generic dispatch (failures give GIAC_STATUS_EVAL_ERROR)
+TryResult try_apply_func0(const std::string& name);
+TryResult try_apply_func1(const std::string& name, const Gen& arg);
+TryResult try_apply_func2(const std::string& name, const Gen& arg1, const Gen& arg2);
+TryResult try_apply_func3(const std::string& name, const Gen& arg1, const Gen& arg2, const Gen& arg3);
+TryResult try_apply_funcN(const std::string& name, const std::vector<Gen>& args);
+
+// No-throw Tier 1 wrappers
+// Trigonometry
+TryResult try_giac_sin(const Gen& arg);
+TryResult try_giac_cos(const Gen& arg);
+TryResult try_giac_tan(const Gen& arg);
+TryResult try_giac_asin(const Gen& arg);
+TryResult try_giac_acos(const Gen& arg);
+TryResult try_giac_atan(const Gen& arg);
+
+// Exponential / Logarithm
+TryResult try_giac_exp(const Gen& arg);
+TryResult try_giac_ln(const Gen& arg);
+TryResult try_giac_log10(const Gen& arg);
+TryResult try_giac_sqrt(const Gen& arg);
+
+// Arithmetic
+TryResult try_giac_abs(const Gen& arg);
+TryResult try_giac_sign(const Gen& arg);
+TryResult try_giac_floor(const Gen& arg);
+TryResult try_giac_ceil(const Gen& arg);
+
+// Complex
+TryResult try_giac_re(const Gen& arg);
+TryResult try_giac_im(const Gen& arg);
+TryResult try_giac_conj(const Gen& arg);
+
+// Algebra
+TryResult try_giac_normal(const Gen& arg);
+TryResult try_giac_evalf(const Gen& arg);
+
+// Calculus (multi-argument)
+TryResult try_giac_diff(const Gen& expr, const Gen& var);
+TryResult try_giac_integrate(const Gen& expr, const Gen& var);
+TryResult try_giac_subst(const Gen& expr, const Gen& var, const Gen& val);
+TryResult try_giac_solve(const Gen& expr, const Gen& var);
+TryResult try_giac_limit(const Gen& expr, const Gen& var, const Gen& val);
+TryResult try_giac_series(const Gen& expr, const Gen& var, const Gen& order);
+
+// Arithmetic (multi-argument)
+TryResult try_giac_gcd(const Gen& a, const Gen& b);
+TryResult try_giac_lcm(const Gen& a, const Gen& b);
+
+// Power
+TryResult try_giac_pow(const Gen& base, const Gen& exp);
+
+// ============================================================================
+// Exact Linear Algebra on Flat Buffers
+// ============================================================================
+
+/**
+ * @brief A flat array of exact integers
+ *
+ * Two forms. When limb_offset is empty the values are the int64 entries of
+ * `values`. Otherwise value i is sign[i] * |limbs[limb_offset[i] ..
+ * limb_offset[i+1])|, with 64-bit limbs least significant first (GMP and
+ * Julia BigInt order); limb_offset has one more entry than sign.
+ * Results use the int64 form whenever every value fits.
+ */
+struct ExactInts {
+    std::vector<int64_t> values;
+    std::vector<int32_t> sign;
+    std::vector<int64_t> limb_offset;
+    std::vector<uint64_t> limbs;
+};
+
+/**
+ * @brief Row-major integer or rational matrix
+ *
+ * Entry (i, j) is num[i*cols + j] / den[i*cols + j]. An empty den means an
+ * integer matrix; results leave den empty when every entry is an integer.
+ */
+struct ExactMatrix {
+    int64_t rows = 0;
+    int64_t cols = 0;
+    ExactInts num;
+    ExactInts den;   // positive, or empty for an integer matrix
+};
+
+/**
+ * @brief Wrap int64 values as ExactInts
+ */
+ExactInts make_exact_ints(const std::vector<int64_t>& values);
+
+/**
+ * @brief Wrap sign / limb buffers as ExactInts
+ * @throws std::runtime_error if the offsets do not describe sign.size() values
+ */
+ExactInts make_exact_ints_limbs(const std::vector<int32_t>& sign,
+                                const std::vector<int64_t>& limb_offset,
+                                const std::vector<uint64_t>& limbs);
+
+/**
+ * @brief Assemble an ExactMatrix
+ * @param den Denominators, or an empty ExactInts for an integer matrix
+ * @throws std::runtime_error if the buffer sizes do not match rows * cols
+ */
+ExactMatrix make_exact_matrix(int64_t rows, int64_t cols, const ExactInts& num,
+                              const ExactInts& den);
+
+/**
+ * @brief Determinant, as a 1x1 ExactMatrix
+ *
+ * Rational rows are scaled to integers first, so giac runs its integer
+ * (fraction-free or multimodular) determinant.
+ * @throws std::runtime_error if the matrix is not square
+ */
+ExactMatrix exact_det(const ExactMatrix& a);
+
+/**
+ * @brief Reduced row echelon form
+ */
+ExactMatrix exact_rref(const ExactMatrix& a);
+
+/**
+ * @brief Inverse of a square matrix
+ * @throws std::runtime_error if the matrix is singular or not square
+ */
+ExactMatrix exact_inverse(const ExactMatrix& a);
+
+/**
+ * @brief Solve A X = B
+ * @param b Right-hand sides, one column each (a.rows rows)
+ * @return X with a.cols rows and b.cols columns
+ * @throws std::runtime_error if the system has no unique solution
+ */
+ExactMatrix exact_linsolve(const ExactMatrix& a, const ExactMatrix& b);
+
+/**
+ * @brief Kernel basis
+ * @return One basis vector per row (a.cols columns); zero rows when the
+ *         kernel is trivial
+ */
+ExactMatrix exact_ker(const ExactMatrix& a);
+
+// ============================================================================
+// Modular (Z/pZ) Dense Linear Algebra and Polynomials
+// ============================================================================
+//
+// Matrices are row-major buffers and polynomials are coefficient buffers in
+// ascending degree (coefficient i multiplies x^i). Inputs may hold any
+// values and are reduced mod p; outputs lie in [0, p) and polynomials come
+// back without trailing zeros (the zero polynomial is empty). p must be a
+// prime with 2 <= p, and p <= 2^31 - 1 for int32 buffers. Every overload
+// exists for int32_t and int64_t buffers and never builds a Gen.
+
+/**
+ * @brief Quotient and remainder of a modular polynomial division
+ */
+template <class T>
+struct ModDivRem {
+    std::vector<T> quotient;
+    std::vector<T> remainder;
+};
+
+/**
+ * @brief Rank of a rows x cols matrix mod p
+ */
+int64_t mod_rank(const std::vector<int32_t>& a, int64_t rows, int64_t cols, int64_t p);
+int64_t mod_rank(const std::vector<int64_t>& a, int64_t rows, int64_t cols, int64_t p);
+
+/**
+ * @brief Determinant of an n x n matrix mod p, in [0, p)
+ */
+int64_t mod_det(const std::vector<int32_t>& a, int64_t n, int64_t p);
+int64_t mod_det(const std::vector<int64_t>& a, int64_t n, int64_t p);
+
+/**
+ * @brief Reduced row echelon form of a rows x cols matrix mod p
+ */
+std::vector<int32_t> mod_rref(const std::vector<int32_t>& a, int64_t rows, int64_t cols, int64_t p);
+std::vector<int64_t> mod_rref(const std::vector<int64_t>& a, int64_t rows, int64_t cols, int64_t p);
+
+/**
+ * @brief Inverse of an n x n matrix mod p
+ * @throws std::runtime_error if the matrix is singular mod p
+ */
+std::vector<int32_t> mod_inverse(const std::vector<int32_t>& a, int64_t n, int64_t p);
+std::vector<int64_t> mod_inverse(const std::vector<int64_t>& a, int64_t n, int64_t p);
+
+/**
+ * @brief Product of an m x k and a k x n matrix mod p
+ * @param num_threads 1 = serial, 0 = all hardware threads, n = at most n
+ *
+ * Products are summed in a double-width accumulator and only reduced when
+ * it could overflow, so small moduli pay one division per output entry.
+ */
+std::vector<int32_t> mod_matmul(const std::vector<int32_t>& a, const std::vector<int32_t>& b,
+                                int64_t m, int64_t k, int64_t n, int64_t p, int32_t num_threads);
+std::vector<int64_t> mod_matmul(const std::vector<int64_t>& a, const std::vector<int64_t>& b,
+                                int64_t m, int64_t k, int64_t n, int64_t p, int32_t num_threads);
+
+/**
+ * @brief Product of two polynomials mod p
+ */
+std::vector<int32_t> mod_poly_mul(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p);
+std::vector<int64_t> mod_poly_mul(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p);
+
+/**
+ * @brief Euclidean division a = q * b + r, deg r < deg b
+ * @throws std::runtime_error if b is zero mod p
+ */
+ModDivRem<int32_t> mod_poly_divrem(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p);
+ModDivRem<int64_t> mod_poly_divrem(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p);
+
+/**
+ * @brief Monic gcd of two polynomials mod p (empty when both are zero)
+ */
+std::vector<int32_t> mod_poly_gcd(const std::vector<int32_t>& a, const std::vector<int32_t>& b, int64_t p);
+std::vector<int64_t> mod_poly_gcd(const std::vector<int64_t>& a, const std::vector<int64_t>& b, int64_t p);
+
+/**
+ * @brief Evaluate a polynomial mod p at every point
+ * @param num_threads 1 = serial, 0 = all hardware threads, n = at most n
+ */
+std::vector<int32_t> mod_poly_eval(const std::vector<int32_t>& a, const std::vector<int32_t>& points,
+                                   int64_t p, int32_t num_threads);
+std::vector<int64_t> mod_poly_eval(const std::vector<int64_t>& a, const std::vector<int64_t>& points,
+                                   int64_t p, int32_t num_threads);
+
+// ============================================================================
+// Sparse Matrices (CSC)
+// ============================================================================
+
+/**
+ * @brief Compressed sparse column matrix (the Julia SparseMatrixCSC layout,
+ * with 0-based indices)
+ *
+ * The nonzeros of column j are rowval / nzval[colptr[j] .. colptr[j+1]).
+ */
+struct CscMatrix {
+    int64_t rows = 0;
+    int64_t cols = 0;
+    std::vector<int64_t> colptr;   // cols + 1 entries, colptr[0] == 0
+    std::vector<int64_t> rowval;   // row of each nonzero
+    std::vector<double> nzval;     // value of each nonzero
 };
 
+/**
+ * @brief Assemble and validate a CscMatrix
+ * @throws std::runtime_error if the buffers are inconsistent or a row index
+ *         is out of range
+ */
+CscMatrix make_csc_matrix(int64_t rows, int64_t cols, const std::vector<int64_t>& colptr,
+                          const std::vector<int64_t>& rowval, const std::vector<double>& nzval);
+
+/**
+ * @brief Convert to giac's sparse matrix form, a _MAP {[i,j]: value}
+ * @note Memory is proportional to the number of nonzeros. Repeated
+ *       (row, col) entries are summed and zero sums are dropped.
+ */
+Gen csc_to_gen(const CscMatrix& m);
+
+/**
+ * @brief Convert a giac sparse (_MAP {[i,j]: value}) or dense matrix to CSC
+ * @param rows, cols Dimensions, or negative to use the largest index + 1
+ * @throws std::runtime_error if an entry has no numeric value
+ */
+CscMatrix gen_to_csc(const Gen& m, int64_t rows, int64_t cols);
+
+/**
+ * @brief Result of sparse_solve
+ */
+struct SparseSolveResult {
+    std::vector<double> x;
+    int64_t iterations = 0;
+    double residual = 0.0;   // ||b - A x|| / ||b||
+    bool converged = false;
+};
+
+/**
+ * @brief Solve A x = b for square sparse A with Jacobi-preconditioned
+ * BiCGSTAB
+ * @param tol Relative residual to reach
+ * @param max_iter Iteration cap (<= 0 means 2 * rows)
+ * @param num_threads 1 = serial, 0 = all hardware threads, n = at most n
+ */
+SparseSolveResult sparse_solve(const CscMatrix& a, const std::vector<double>& b, double tol,
+                               int64_t max_iter, int32_t num_threads);
+
+/**
+ * @brief Rank of a sparse integer matrix over Z/pZ
+ * @param p Prime modulus; 0 uses 2^31 - 1, which gives the rational rank
+ *          unless p divides every maximal nonzero minor
+ * @throws std::runtime_error if a value is not an integer
+ *
+ * Sparse elimination, rows taken sparsest first: memory grows with the
+ * fill-in, never with rows * cols.
+ */
+int64_t sparse_rank(const CscMatrix& a, int64_t p);
+
+// ============================================================================
+// Poly - Polynomial handle in giac's internal representation
+// ============================================================================
+
+/**
+ * @brief Multivariate polynomial kept in giac's sparse distributed form
+ *
+ * Wraps a giac `polynome` with its variable list. Arithmetic, gcd,
+ * derivative and evaluation work on the distributed form; the expression
+ * tree is only rebuilt by to_gen(), so a pipeline converts once on the way
+ * in and once on the way out. Operands of a binary operation must have the
+ * same variable list.
+ */
+class Poly {
+public:
+    /**
+     * @param expr Polynomial expression in vars (rational coefficients allowed)
+     * @param vars Variable names, in exponent order
+     * @throws std::runtime_error if expr is not a polynomial in vars
+     */
+    Poly(const Gen& expr, const std::vector<std::string>& vars);
+    ~Poly();
+
+    Poly(const Poly& other);
+    Poly& operator=(const Poly& other);
+    Poly(Poly&& other) noexcept;
+    Poly& operator=(Poly&& other) noexcept;
+
+    std::vector<std::string> variables() const;
+    int64_t nterms() const;
+    bool is_zero() const;
+
+    /** @brief Degree in variables()[var], -1 for the zero polynomial */
+    int64_t degree(int32_t var) const;
+    int64_t total_degree() const;
+
+    /** @brief Expression tree (the only conversion back to a Gen) */
+    Gen to_gen() const;
+    std::string to_string() const;
+
+    Poly operator+(const Poly& other) const;
+    Poly operator-(const Poly& other) const;
+    Poly operator*(const Poly& other) const;
+    Poly operator-() const;
+
+    /** @throws std::runtime_error if n < 0 */
+    Poly pow(int32_t n) const;
+
+    /** @brief Partial derivative with respect to variables()[var] */
+    Poly derivative(int32_t var) const;
+
+    /**
+     * @brief Value at variables() = values
+     * @param values One Gen per variable
+     */
+    Gen evaluate(const std::vector<Gen>& values) const;
+
+private:
+    explicit Poly(std::unique_ptr<PolyImpl> impl);
+    std::unique_ptr<PolyImpl> impl_;
+
+    friend Poly poly_gcd(const Poly& a, const Poly& b);
+    friend PolyFactorization poly_factor(const Poly& p);
+    friend SparsePoly poly_to_sparse(const Poly& p);
+    friend Poly sparse_to_poly(const SparsePoly& sp, const std::vector<std::string>& vars);
+};
+
+/**
+ * @brief Irreducible factors with multiplicities; numeric content comes
+ * back as constant factors
+ */
+struct PolyFactorization {
+    std::vector<Poly> factors;
+    std::vector<int32_t> multiplicities;
+};
+
+/**
+ * @brief gcd computed by giac on the distributed form
+ */
+Poly poly_gcd(const Poly& a, const Poly& b);
+
+/**
+ * @brief Factor over the rationals
+ */
+PolyFactorization poly_factor(const Poly& p);
+
+// ============================================================================
+// Sparse Polynomial Exchange (exponent matrix + coefficients)
+// ============================================================================
+
+/**
+ * @brief Polynomial as an exponent matrix plus coefficient buffers
+ *
+ * Term t is num[t] / den[t] * prod(vars[k] ^ exponents[t*nvars + k]).
+ * Coefficients use the ExactInts forms; den is empty when every
+ * coefficient is an integer, and otherwise holds positive entries.
+ */
+struct SparsePoly {
+    int64_t nvars = 0;
+    int64_t nterms = 0;
+    std::vector<int32_t> exponents;   // nterms x nvars, row-major
+    ExactInts num;
+    ExactInts den;
+};
+
+/**
+ * @brief Assemble and validate a SparsePoly
+ * @throws std::runtime_error if the buffer sizes do not match
+ */
+SparsePoly make_sparse_poly(int64_t nvars, const std::vector<int32_t>& exponents,
+                            const ExactInts& num, const ExactInts& den);
+
+/**
+ * @brief Export a polynomial in vars, terms in giac's monomial order
+ * @throws std::runtime_error if expr is not a polynomial in vars or a
+ *         coefficient is not rational
+ */
+SparsePoly poly_to_sparse(const Gen& expr, const std::vector<std::string>& vars);
+SparsePoly poly_to_sparse(const Poly& p);
+
+/**
+ * @brief Build a polynomial from its terms (any order; repeated exponent
+ * rows are summed)
+ * @throws std::runtime_error if an exponent is negative or exceeds giac's
+ *         degree range
+ */
+Gen poly_from_sparse(const SparsePoly& sp, const std::vector<std::string>& vars);
+
+/**
+ * @brief As poly_from_sparse, kept as a Poly handle
+ */
+Poly sparse_to_poly(const SparsePoly& sp, const std::vector<std::string>& vars);
+
+
+// ============================================================================
+// Groebner Bases
+// ============================================================================
+
+/**
+ * @brief Monomial orders accepted by groebner
+ */
+enum GroebnerOrder : int32_t {
+    GROEBNER_REVLEX = 0,  ///< Degree reverse lexicographic (fastest)
+    GROEBNER_PLEX = 1,    ///< Pure lexicographic, for elimination
+    GROEBNER_TDEG = 2,    ///< Degree lexicographic
+};
+
+/**
+ * @brief Stages reported to a groebner progress callback
+ */
+enum GroebnerStage : int32_t {
+    GROEBNER_STAGE_INPUT = 0,    ///< Building giac polynomials, done/total over inputs
+    GROEBNER_STAGE_COMPUTE = 1,  ///< Basis computation started (0 of 1) and finished (1 of 1)
+    GROEBNER_STAGE_OUTPUT = 2,   ///< Exporting the basis, done/total over outputs
+};
+
+/**
+ * @brief Progress callback: stage, items done, items in the stage, user data
+ *
+ * giac's basis computation has no progress hook, so nothing is reported
+ * between the two GROEBNER_STAGE_COMPUTE calls.
+ */
+typedef void (*GroebnerProgress)(int32_t stage, int64_t done, int64_t total, void* data);
+
+/**
+ * @brief Tuning knobs for groebner
+ *
+ * modulus == 0 computes over Q with giac's multimodular algorithm and
+ * rational reconstruction; certify replaces its probabilistic final check
+ * with a full verification. A prime modulus computes over Z/pZ directly
+ * and returns coefficients in [0, p); composite moduli are rejected.
+ */
+struct GroebnerOptions {
+    int32_t num_threads = 1;       // giac's internal threads; 0 = all hardware threads
+    int64_t modulus = 0;
+    bool certify = false;
+    GroebnerProgress progress = nullptr;
+    void* progress_data = nullptr;
+};
+
+/**
+ * @brief Assemble GroebnerOptions (progress is set separately)
+ */
+GroebnerOptions make_groebner_options(int32_t num_threads, int64_t modulus, bool certify);
+
+/**
+ * @brief Reduced Groebner basis of the ideal generated by polys
+ * @param polys Generators, each with vars.size() variables
+ * @param vars Variable order, first variable largest
+ * @param order GROEBNER_REVLEX, GROEBNER_PLEX or GROEBNER_TDEG
+ * @param options Threading, coefficient field and progress callback
+ * @throws std::runtime_error on bad input, unknown order or giac failure
+ * @note giac::threads is process-wide; concurrent groebner calls are
+ *       serialized so that each runs with its own thread count. While a
+ *       call with a different num_threads runs, other giac work in the
+ *       process sees that count too. Generators are sorted in the requested
+ *       order before the computation; the basis is returned in lex term order.
+ */
+std::vector<SparsePoly> groebner(const std::vector<SparsePoly>& polys,
+                                 const std::vector<std::string>& vars,
+                                 int32_t order, const GroebnerOptions& options);
+
+
+// ============================================================================
+// Batch Polynomial Roots
+// ============================================================================
+
+/**
+ * @brief Numeric roots of a batch of univariate polynomials
+ *
+ * The roots of polynomial k are the pairs k_root = offsets[k] ..
+ * offsets[k+1]-1, stored as roots[2*k_root] (real part) and
+ * roots[2*k_root + 1] (imaginary part). With digits > 15, mp_roots[k_root]
+ * holds the same root as a giac value at the full working precision.
+ */
+struct RootBatch {
+    std::vector<double> roots;      ///< Interleaved (re, im)
+    std::vector<Gen> mp_roots;      ///< One per root when digits > 15, else empty
+    std::vector<int64_t> offsets;   ///< npolys + 1 entries, counted in roots
+    std::vector<int32_t> status;    ///< GiacStatus per polynomial
+    int64_t error_count = 0;        ///< Polynomials whose status != OK
+};
+
+/**
+ * @brief Roots of many polynomials via giac's proot, spread over threads
+ * @param coeffs Coefficients of every polynomial, highest degree first;
+ *        polynomial k is coeffs[offsets[k] .. offsets[k+1])
+ * @param offsets npolys + 1 nondecreasing entries, offsets[0] == 0 and
+ *        offsets[npolys] == coeffs.size()
+ * @param digits Working precision; <= 15 uses doubles, more uses giac's
+ *        multiprecision root finder and also fills mp_roots
+ * @param num_threads 1 = serial, 0 = all hardware threads
+ * @throws std::runtime_error if offsets are malformed; a failing
+ *         polynomial only sets its own status: GIAC_STATUS_INVALID_ARGUMENT
+ *         for the zero polynomial or a non-finite coefficient,
+ *         GIAC_STATUS_EVAL_ERROR when giac fails
+ * @note Leading zero coefficients are ignored; nonzero constant
+ *       polynomials have no roots.
+ */
+RootBatch proot_batch(const std::vector<double>& coeffs, const std::vector<int64_t>& offsets,
+                      int32_t digits, int32_t num_threads);
+
+/**
+ * @brief As above with exact integer coefficients (int64 or limb form)
+ */
+RootBatch proot_batch(const ExactInts& coeffs, const std::vector<int64_t>& offsets,
+                      int32_t digits, int32_t num_threads);
+
+
+// ============================================================================
+// Multipoint Substitution
+// ============================================================================
+
+/**
+ * @brief Evaluate expr exactly at many points
+ *
+ * The expression is compiled once into a post-order tape: subtrees that do
+ * not depend on vars are evaluated up front, shared subtrees are computed
+ * once per point, and each point then only runs the operators on the
+ * path from the variables to the root. The result for a row matches
+ * eval(subst(expr, vars, row)); integers and rationals stay exact.
+ *
+ * @param expr Expression to evaluate
+ * @param vars Variable names, one per column of values
+ * @param values npoints x vars.size() row-major values
+ * @param num_threads 1 = serial, 0 = all hardware threads
+ * @return One result per row
+ * @throws std::runtime_error if values.size() is not a multiple of
+ *         vars.size() or an evaluation fails
+ */
+std::vector<Gen> subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                            const std::vector<Gen>& values, int32_t num_threads);
+
+/**
+ * @brief As above on an npoints x vars.size() integer/rational matrix
+ * @return npoints x 1 ExactMatrix
+ * @throws std::runtime_error if a result is not rational
+ */
+ExactMatrix subst_many(const Gen& expr, const std::vector<std::string>& vars,
+                       const ExactMatrix& values, int32_t num_threads);
+
+
+// ============================================================================
+// Compiled Numeric Evaluation
+// ============================================================================
+
+/**
+ * @brief Real-valued expressions compiled to a flat instruction tape
+ *
+ * Each expression is lowered once into SSA form: every instruction writes
+ * its own register and reads earlier ones. Subtrees that do not depend on
+ * the inputs are folded to constants by giac's evalf, and repeated
+ * subexpressions share one register across all outputs. Evaluation then
+ * runs the tape over doubles without touching giac.
+ *
+ * Supported operators: + - * / ^, neg, inv, sqrt, exp, ln, log10, the
+ * circular and hyperbolic functions and their inverses, abs, sign,
+ * floor, ceil, min, max, sq, re, im, conj, arg. Outside the real domain
+ * (ln(-1), sqrt(-1)) the result is NaN rather than giac's complex value.
+ *
+ * Compiled with complex = true, constants may be complex (i, exp(i*pi/3)),
+ * and the eval_complex entry points follow giac's evalf: ln, sqrt, arg and
+ * non-integer powers take their principal values with the cut on the
+ * negative real axis, approached from above. On the cuts of the inverse
+ * circular and hyperbolic functions the C99 <complex> conventions apply.
+ */
+/**
+ * @brief Interval enclosures, nboxes x num_outputs row-major
+ */
+struct IntervalBounds {
+    std::vector<double> lo;
+    std::vector<double> hi;
+};
+
+class CompiledFunction {
+public:
+    /**
+     * @param exprs One expression per output
+     * @param vars Input names, in argument order
+     * @throws std::runtime_error on an unsupported operator or a free
+     *         identifier that is not in vars
+     */
+    CompiledFunction(const std::vector<Gen>& exprs, const std::vector<std::string>& vars);
+
+    /**
+     * @brief As above; complex = true accepts complex constants, which
+     *        limits evaluation to the eval_complex entry points
+     */
+    CompiledFunction(const std::vector<Gen>& exprs, const std::vector<std::string>& vars, bool complex);
+    ~CompiledFunction();
+
+    CompiledFunction(const CompiledFunction& other);
+    CompiledFunction& operator=(const CompiledFunction& other);
+    CompiledFunction(CompiledFunction&& other) noexcept;
+    CompiledFunction& operator=(CompiledFunction&& other) noexcept;
+
+    int32_t num_inputs() const;
+    int32_t num_outputs() const;
+    int64_t num_instructions() const;
+    std::vector<std::string> variables() const;
+    bool is_complex() const;
+
+    /**
+     * @brief Evaluate at one point
+     * @throws std::runtime_error if x.size() != num_inputs() or the
+     *         function was compiled in complex mode
+     */
+    std::vector<double> eval(const std::vector<double>& x) const;
+
+    /**
+     * @brief Evaluate x[0..num_inputs) into y[0..num_outputs); no size
+     *        checks, no allocation after the first call on a thread
+     * @throws std::runtime_error if the function was compiled in complex mode
+     */
+    void eval(const double* x, double* y) const;
+
+    /**
+     * @brief Evaluate npoints x num_inputs row-major points
+     * @param num_threads 1 = serial, 0 = all hardware threads
+     * @return npoints x num_outputs row-major values
+     */
+    std::vector<double> eval_batch(const std::vector<double>& points, int32_t num_threads) const;
+
+    /**
+     * @brief Evaluate in complex arithmetic at one point
+     *
+     * Buffers are interleaved (re, im) pairs, the layout of ComplexF64
+     * arrays: z holds 2 * num_inputs doubles, w receives 2 * num_outputs.
+     * Works in either mode; a real-mode tape is continued to the complex
+     * plane. No checks, no allocation after the first call on a thread.
+     */
+    void eval_complex(const double* z, double* w) const;
+
+    /**
+     * @brief As above with size checks
+     * @throws std::runtime_error if z.size() != 2 * num_inputs()
+     */
+    std::vector<double> eval_complex(const std::vector<double>& z) const;
+
+    /**
+     * @brief Evaluate npoints interleaved complex points
+     * @param num_threads 1 = serial, 0 = all hardware threads
+     * @return npoints x num_outputs interleaved complex values
+     */
+    std::vector<double> eval_complex_batch(const std::vector<double>& points, int32_t num_threads) const;
+
+    /**
+     * @brief Compiled Jacobian, num_outputs x num_inputs row-major
+     *        (derivatives taken symbolically by giac)
+     */
+    CompiledFunction jacobian() const;
+
+    /**
+     * @brief Enclose each output over the box [lo, hi] (num_inputs bounds each)
+     *
+     * Interval arithmetic with outward rounding: every result is widened
+     * by one ulp (two for libm functions), and constants rounded from
+     * exact or symbolic values are widened too. The enclosures therefore
+     * hold for every real point of the box. Parts of a box outside an
+     * operator's real domain are ignored (sqrt over [-1, 4] gives [0, 2]).
+     * A box entirely outside the domain gives NaN bounds, and so does an
+     * input with lo > hi. pow with a non-constant exponent is taken over
+     * base >= 0.
+     *
+     * @throws std::runtime_error if the function was compiled in complex mode
+     */
+    void eval_interval(const double* lo, const double* hi, double* out_lo, double* out_hi) const;
+
+    /**
+     * @brief Enclose over nboxes row-major boxes
+     * @param num_threads 1 = serial, 0 = all hardware threads
+     * @throws std::runtime_error if the sizes do not match or the function
+     *         was compiled in complex mode
+     */
+    IntervalBounds eval_interval_batch(const std::vector<double>& lo, const std::vector<double>& hi,
+                                       int32_t num_threads) const;
+
+private:
+    explicit CompiledFunction(std::unique_ptr<CompiledFunctionImpl> impl);
+
+    std::unique_ptr<CompiledFunctionImpl> impl_;
+};
+
+/**
+ * @brief C-callable evaluation for foreign solvers
+ *
+ * Evaluates the CompiledFunction pointed to by data at x into y. Never
+ * throws; y is filled with NaN if evaluation fails, as it does for a
+ * function compiled in complex mode.
+ */
+void compiled_function_call(const double* x, double* y, void* data);
+
+/**
+ * @brief C-callable in-place ODE right-hand side, du = f(t, u)
+ *
+ * data points to a CompiledFunction with inputs (t, u...) and one output
+ * per state, as built for ode_solve. The argument order matches an
+ * in-place f!(du, u, p, t) with p carrying the pointer. Like
+ * compiled_function_call it never throws and fills du with NaN on failure.
+ */
+void compiled_ode_rhs(double* du, const double* u, void* data, double t);
+
+/** @brief Address of compiled_function_call, for ccall from Julia */
+void* compiled_function_call_ptr();
+
+/** @brief Address of compiled_ode_rhs, for ccall from Julia */
+void* compiled_ode_rhs_ptr();
+
+// ============================================================================
+// ODE Integration
+// ============================================================================
+
+/**
+ * @brief Integrators for ode_solve
+ */
+enum OdeMethod : int32_t {
+    ODE_RK45 = 0,          ///< Dormand-Prince 5(4), explicit, dense output
+    ODE_ROSENBROCK23 = 1,  ///< Modified Rosenbrock 2(3), L-stable, for stiff systems
+};
+
+/**
+ * @brief Outcome of ode_solve
+ */
+enum OdeStatus : int32_t {
+    ODE_SUCCESS = 0,
+    ODE_MAX_STEPS = 1,        ///< Step budget exhausted before the last output time
+    ODE_STEP_TOO_SMALL = 2,   ///< Step size underflow (singularity or extreme stiffness)
+    ODE_NOT_FINITE = 3,       ///< The right-hand side produced NaN or Inf
+};
+
+struct OdeOptions {
+    int32_t method = ODE_RK45;
+    double rtol = 1e-6;
+    double atol = 1e-9;
+    double initial_step = 0.0;   // 0 = automatic
+    double max_step = 0.0;       // 0 = unbounded
+    int64_t max_steps = 100000;
+};
+
+struct OdeStats {
+    int32_t status = ODE_SUCCESS;
+    int64_t steps = 0;           // accepted steps
+    int64_t rejected = 0;
+    int64_t rhs_evals = 0;
+    int64_t jacobian_evals = 0;
+    int64_t outputs = 0;         // rows of the trajectory written
+    double t_reached = 0.0;
+};
+
+/**
+ * @brief Assemble OdeOptions
+ */
+OdeOptions make_ode_options(int32_t method, double rtol, double atol, int64_t max_steps);
+
+/**
+ * @brief Integrate dy/dt = rhs(t, y) and sample the trajectory
+ * @param rhs CompiledFunction with inputs (t, y1..yn) and n outputs
+ * @param y0 State at t_out[0]
+ * @param t_out Output times, strictly monotone (increasing or decreasing);
+ *        t_out[0] is the initial time
+ * @param y_out Caller buffer of t_out.size() x n doubles, row-major;
+ *        row k receives y(t_out[k]) from the integrator's dense output
+ * @param options Method, tolerances and step budget
+ * @return Statistics; on failure rows up to stats.outputs are valid
+ * @throws std::runtime_error if the sizes do not match or t_out is not
+ *         strictly monotone
+ */
+OdeStats ode_solve(const CompiledFunction& rhs, const std::vector<double>& y0,
+                   const std::vector<double>& t_out, double* y_out, const OdeOptions& options);
+
+/**
+ * @brief Trajectory and statistics returned by the allocating ode_solve
+ */
+struct OdeSolution {
+    std::vector<double> y;   // t_out.size() x n, row-major
+    OdeStats stats;
+};
+
+/**
+ * @brief As above, allocating the trajectory
+ */
+OdeSolution ode_solve(const CompiledFunction& rhs, const std::vector<double>& y0,
+                      const std::vector<double>& t_out, const OdeOptions& options);
+
+// ============================================================================
+// Adaptive Sampling for Plotting
+// ============================================================================
+
+/**
+ * @brief Points of a sampled curve, sorted by x
+ *
+ * A NaN y marks a break: either the function is undefined there or a
+ * jump was isolated between its neighbours, so plotting libraries do not
+ * draw a vertical line across a discontinuity.
+ */
+struct SampledCurve {
+    std::vector<double> x;
+    std::vector<double> y;
+    int64_t evaluations = 0;
+};
+
+/**
+ * @brief Sample f on [a, b], refining where the curve bends or jumps
+ *
+ * Starts from a uniform grid, then repeatedly splits the interval whose
+ * midpoint strays furthest from the chord, measured as a fraction of the
+ * curve's y-range, until every interval is within tol or max_points is
+ * reached. Intervals narrowed to (b - a) * 1e-9 that still fail are
+ * treated as discontinuities.
+ *
+ * @param f CompiledFunction with one input and one output
+ * @param max_points Output budget, NaN breaks included (at least 3)
+ * @param tol Allowed chord deviation relative to the y-range, e.g. 1e-3
+ * @throws std::runtime_error on a bad interval, budget or function arity
+ */
+SampledCurve sample(const CompiledFunction& f, double a, double b, int64_t max_points, double tol);
+
+/**
+ * @brief As above, compiling expr in var first
+ */
+SampledCurve sample(const Gen& expr, const std::string& var, double a, double b,
+                    int64_t max_points, double tol);
+
+/**
+ * @brief Values on a regular grid for contour and surface plots
+ *
+ * z is row-major ny x nx: z[j*nx + i] = f(x[i], y[j]), NaN where f is
+ * undefined.
+ */
+struct SampledGrid {
+    int64_t nx = 0;
+    int64_t ny = 0;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+};
+
+/**
+ * @brief Evaluate a two-input CompiledFunction on an nx x ny grid
+ * @param num_threads 1 = serial, 0 = all hardware threads
+ * @throws std::runtime_error if nx or ny < 2 or f is not 2 -> 1
+ */
+SampledGrid sample_grid(const CompiledFunction& f, double x0, double x1, int64_t nx,
+                        double y0, double y1, int64_t ny, int32_t num_threads);
+
+/**
+ * @brief As above, compiling expr in (xvar, yvar) first
+ */
+SampledGrid sample_grid(const Gen& expr, const std::string& xvar, const std::string& yvar,
+                        double x0, double x1, int64_t nx, double y0, double y1, int64_t ny,
+                        int32_t num_threads);
+
+
+// ============================================================================
+// Numerical Quadrature
+// ============================================================================
+
+/**
+ * @brief Rules for quad
+ */
+enum QuadMethod : int32_t {
+    QUAD_GAUSS_KRONROD = 0,  ///< Adaptive 15-point Gauss-Kronrod, for smooth or piecewise smooth integrands
+    QUAD_TANH_SINH = 1,      ///< Double-exponential rule, for integrable endpoint singularities
+};
+
+/**
+ * @brief Outcome of quad
+ */
+enum QuadStatus : int32_t {
+    QUAD_SUCCESS = 0,
+    QUAD_NOT_CONVERGED = 1,   ///< Subdivision budget or round-off limit reached before the tolerance
+    QUAD_NOT_FINITE = 2,      ///< The integrand produced NaN or Inf at a node
+};
+
+struct QuadOptions {
+    int32_t method = QUAD_GAUSS_KRONROD;
+    double rtol = 1e-10;
+    double atol = 1e-12;
+    int64_t max_intervals = 2000;   // Gauss-Kronrod only; tanh-sinh stops after 12 halvings
+    int32_t num_threads = 1;        // 1 = serial, 0 = all hardware threads
+};
+
+struct QuadResult {
+    double value = 0.0;
+    double error = 0.0;          // estimated absolute error
+    int32_t status = QUAD_SUCCESS;
+    int64_t evaluations = 0;
+    int64_t subdivisions = 0;    // intervals (Gauss-Kronrod) or levels (tanh-sinh)
+};
+
+/**
+ * @brief Assemble QuadOptions
+ */
+QuadOptions make_quad_options(int32_t method, double rtol, double atol, int32_t num_threads);
+
+/**
+ * @brief Integrate f over [a, b] on the compiled tape
+ *
+ * Gauss-Kronrod bisects every interval whose error exceeds its share of
+ * the tolerance, one round at a time; the nodes of a round (or of a
+ * tanh-sinh level) are evaluated across options.num_threads. Results do
+ * not depend on the thread count. b < a integrates backwards.
+ *
+ * @param f CompiledFunction with one input and one output
+ * @throws std::runtime_error on infinite bounds, bad options or arity
+ */
+QuadResult quad(const CompiledFunction& f, double a, double b, const QuadOptions& options);
+
+/**
+ * @brief As above, compiling expr in var first
+ */
+QuadResult quad(const Gen& expr, const std::string& var, double a, double b,
+                const QuadOptions& options);
+
+/**
+ * @brief Integrate f(x, p) over [a, b] for many parameter vectors p
+ * @param f CompiledFunction with inputs (x, p1..pk), k >= 1, and one output
+ * @param params Parameter sets, n x k row-major
+ * @return One result per parameter set; the sets are spread across
+ *         options.num_threads and each integral runs serially
+ */
+std::vector<QuadResult> quad_batch(const CompiledFunction& f, double a, double b,
+                                   const std::vector<double>& params, const QuadOptions& options);
+
 } // namespace giac_julia
 
 #endif // GIAC_IMPL_H
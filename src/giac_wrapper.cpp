@@ -9,6 +9,7 @@
 
 #include <jlcxx/jlcxx.hpp>
 #include <jlcxx/stl.hpp>
+#include <stdexcept>
 
 #include "giac_impl.h"
 
@@ -90,6 +91,11 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
         .method("is_complex_mode", &GiacContext::is_complex_mode)
         .method("set_complex_mode", &GiacContext::set_complex_mode);
 
+    // Register LimitedString (returned by Gen::to_string_limited)
+    mod.add_type<LimitedString>("LimitedString")
+        .method("text", [](const LimitedString& r) { return r.text; })
+        .method("truncated", [](const LimitedString& r) { return r.truncated; });
+
     // Register Gen type
     mod.add_type<Gen>("Gen")
         .constructor<>()
@@ -98,6 +104,7 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
         .constructor<double>()
         // String conversion
         .method("to_string", &Gen::to_string)
+        .method("to_string_limited", &Gen::to_string_limited)
         // Type information
         .method("type", &Gen::type)
         .method("subtype", &Gen::subtype)
@@ -116,8 +123,10 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
         .method("vect_size", &Gen::vect_size)
         .method("vect_at", &Gen::vect_at)
         .method("symb_sommet_name", &Gen::symb_sommet_name)
+        .method("symb_sommet_id", &Gen::symb_sommet_id)
         .method("symb_feuille", &Gen::symb_feuille)
         .method("idnt_name", &Gen::idnt_name)
+        .method("idnt_id", &Gen::idnt_id)
         .method("strng_value", &Gen::strng_value)
         .method("map_size", &Gen::map_size)
         .method("map_keys", &Gen::map_keys)
@@ -229,6 +238,465 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
     // ========================================================================
     mod.method("gen_from_heap_ptr", &gen_from_heap_ptr);
 
+    // ========================================================================
+    // Vector Reductions
+    // ========================================================================
+    mod.method("vect_sum",
+        static_cast<Gen(*)(const std::vector<Gen>&, int32_t)>(&vect_sum));
+    mod.method("vect_sum",
+        static_cast<Gen(*)(const Gen&, int32_t)>(&vect_sum));
+    mod.method("vect_prod",
+        static_cast<Gen(*)(const std::vector<Gen>&, int32_t)>(&vect_prod));
+    mod.method("vect_prod",
+        static_cast<Gen(*)(const Gen&, int32_t)>(&vect_prod));
+
+    // ========================================================================
+    // Vector Shape Census
+    // ========================================================================
+    mod.add_type<GenDescription>("GenDescription")
+        .method("type_counts", [](const GenDescription& d) { return d.type_counts; })
+        .method("depth", [](const GenDescription& d) { return d.depth; })
+        .method("dims", [](const GenDescription& d) { return d.dims; })
+        .method("is_rectangular", [](const GenDescription& d) { return d.rectangular; })
+        .method("all_immediate_numeric", [](const GenDescription& d) { return d.all_immediate_numeric; })
+        .method("node_count", [](const GenDescription& d) { return d.node_count; });
+    mod.method("describe", &describe);
+    mod.method("flatten_doubles", &flatten_doubles);
+    mod.method("flatten_int64s", &flatten_int64s);
+
+    // ========================================================================
+    // Expression Tree Folds
+    // ========================================================================
+    mod.set_const("TREE_NODE_COUNT", static_cast<int32_t>(TREE_NODE_COUNT));
+    mod.set_const("TREE_DEPTH", static_cast<int32_t>(TREE_DEPTH));
+    mod.set_const("TREE_IDENTIFIERS", static_cast<int32_t>(TREE_IDENTIFIERS));
+    mod.set_const("TREE_OPERATORS", static_cast<int32_t>(TREE_OPERATORS));
+    mod.set_const("TREE_NUMERIC_RANGE", static_cast<int32_t>(TREE_NUMERIC_RANGE));
+    mod.set_const("TREE_ALL", static_cast<int32_t>(TREE_ALL));
+    mod.add_type<TreeSummary>("TreeSummary")
+        .method("node_count", [](const TreeSummary& t) { return t.node_count; })
+        .method("depth", [](const TreeSummary& t) { return t.depth; })
+        .method("identifiers", [](const TreeSummary& t) { return t.identifiers; })
+        .method("operator_names", [](const TreeSummary& t) { return t.operator_names; })
+        .method("operator_counts", [](const TreeSummary& t) { return t.operator_counts; })
+        .method("numeric_leaf_count", [](const TreeSummary& t) { return t.numeric_leaf_count; })
+        .method("numeric_min", [](const TreeSummary& t) { return t.numeric_min; })
+        .method("numeric_max", [](const TreeSummary& t) { return t.numeric_max; });
+    mod.method("fold_tree", &fold_tree);
+    mod.method("contains_function", &contains_function);
+
+    // ========================================================================
+    // Interned Names
+    // ========================================================================
+    mod.method("intern_name", &intern_name);
+    mod.method("id_to_name", &id_to_name);
+    mod.method("id_to_name_table", &id_to_name_table);
+
+    // ========================================================================
+    // Native Printers
+    // ========================================================================
+    mod.method("to_julia_syntax", &to_julia_syntax);
+    mod.method("to_latex", &to_latex);
+    mod.method("to_mathml", &to_mathml);
+
+    // ========================================================================
+    // Streaming Serialization
+    // ========================================================================
+    mod.set_const("GEN_FORMAT_TEXT", static_cast<int32_t>(GEN_FORMAT_TEXT));
+    mod.set_const("GEN_FORMAT_BINARY", static_cast<int32_t>(GEN_FORMAT_BINARY));
+    mod.method("write_gen", &write_gen);
+    mod.method("read_gen", &read_gen);
+
+    // ========================================================================
+    // ExpressionReader - Streaming batch parser
+    // ========================================================================
+    mod.set_const("GIAC_STATUS_OK", static_cast<int32_t>(GIAC_STATUS_OK));
+    mod.set_const("GIAC_STATUS_PARSE_ERROR", static_cast<int32_t>(GIAC_STATUS_PARSE_ERROR));
+    mod.set_const("GIAC_STATUS_EVAL_ERROR", static_cast<int32_t>(GIAC_STATUS_EVAL_ERROR));
+    mod.set_const("GIAC_STATUS_EMPTY", static_cast<int32_t>(GIAC_STATUS_EMPTY));
+    mod.set_const("GIAC_STATUS_INVALID_ARGUMENT", static_cast<int32_t>(GIAC_STATUS_INVALID_ARGUMENT));
+    mod.add_type<ExpressionBatch>("ExpressionBatch")
+        .method("values", [](const ExpressionBatch& b) { return b.values; })
+        .method("status", [](const ExpressionBatch& b) { return b.status; })
+        .method("errors", [](const ExpressionBatch& b) { return b.errors; })
+        .method("first_line", [](const ExpressionBatch& b) { return b.first_line; })
+        .method("error_count", [](const ExpressionBatch& b) { return b.error_count; });
+    mod.add_type<ExpressionReader>("ExpressionReader")
+        .constructor<const std::string&, bool, int32_t>()
+        .method("next_batch", &ExpressionReader::next_batch)
+        .method("at_end", &ExpressionReader::at_end)
+        .method("lines_read", &ExpressionReader::lines_read);
+
+    // ========================================================================
+    // No-throw Variants
+    // ========================================================================
+    mod.add_type<TryResult>("TryResult")
+        .method("ok", &TryResult::ok)
+        .method("status", &TryResult::status)
+        .method("value", [](const TryResult& r) { return r.value(); })
+        .method("message", &TryResult::message);
+    mod.method("try_eval",
+        static_cast<TryResult(*)(const std::string&)>(&try_eval));
+    mod.method("try_eval",
+        static_cast<TryResult(*)(const std::string&, GiacContext&)>(&try_eval));
+    mod.method("try_apply_func0", &try_apply_func0);
+    mod.method("try_apply_func1", &try_apply_func1);
+    mod.method("try_apply_func2", &try_apply_func2);
+    mod.method("try_apply_func3", &try_apply_func3);
+    mod.method("try_apply_funcN", &try_apply_funcN);
+
+    // Trigonometry
+    mod.method("try_giac_sin", &try_giac_sin);
+    mod.method("try_giac_cos", &try_giac_cos);
+    mod.method("try_giac_tan", &try_giac_tan);
+    mod.method("try_giac_asin", &try_giac_asin);
+    mod.method("try_giac_acos", &try_giac_acos);
+    mod.method("try_giac_atan", &try_giac_atan);
+
+    // Exponential / Logarithm
+    mod.method("try_giac_exp", &try_giac_exp);
+    mod.method("try_giac_ln", &try_giac_ln);
+    mod.method("try_giac_log10", &try_giac_log10);
+    mod.method("try_giac_sqrt", &try_giac_sqrt);
+
+    // Arithmetic
+    mod.method("try_giac_abs", &try_giac_abs);
+    mod.method("try_giac_sign", &try_giac_sign);
+    mod.method("try_giac_floor", &try_giac_floor);
+    mod.method("try_giac_ceil", &try_giac_ceil);
+
+    // Complex
+    mod.method("try_giac_re", &try_giac_re);
+    mod.method("try_giac_im", &try_giac_im);
+    mod.method("try_giac_conj", &try_giac_conj);
+
+    // Algebra
+    mod.method("try_giac_normal", &try_giac_normal);
+    mod.method("try_giac_evalf", &try_giac_evalf);
+
+    // Calculus (multi-argument)
+    mod.method("try_giac_diff", &try_giac_diff);
+    mod.method("try_giac_integrate", &try_giac_integrate);
+    mod.method("try_giac_subst", &try_giac_subst);
+    mod.method("try_giac_solve", &try_giac_solve);
+    mod.method("try_giac_limit", &try_giac_limit);
+    mod.method("try_giac_series", &try_giac_series);
+
+    // Arithmetic (multi-argument)
+    mod.method("try_giac_gcd", &try_giac_gcd);
+    mod.method("try_giac_lcm", &try_giac_lcm);
+
+    // Power
+    mod.method("try_giac_pow", &try_giac_pow);
+
+    // ========================================================================
+    // Exact Linear Algebra on Flat Buffers
+    // ========================================================================
+    mod.add_type<ExactInts>("ExactInts")
+        .method("values", [](const ExactInts& v) { return v.values; })
+        .method("sign", [](const ExactInts& v) { return v.sign; })
+        .method("limb_offset", [](const ExactInts& v) { return v.limb_offset; })
+        .method("limbs", [](const ExactInts& v) { return v.limbs; });
+    mod.add_type<ExactMatrix>("ExactMatrix")
+        .method("rows", [](const ExactMatrix& m) { return m.rows; })
+        .method("cols", [](const ExactMatrix& m) { return m.cols; })
+        .method("num", [](const ExactMatrix& m) { return m.num; })
+        .method("den", [](const ExactMatrix& m) { return m.den; });
+    mod.method("make_exact_ints", &make_exact_ints);
+    mod.method("make_exact_ints_limbs", &make_exact_ints_limbs);
+    mod.method("make_exact_matrix", &make_exact_matrix);
+    mod.method("exact_det", &exact_det);
+    mod.method("exact_rref", &exact_rref);
+    mod.method("exact_inverse", &exact_inverse);
+    mod.method("exact_linsolve", &exact_linsolve);
+    mod.method("exact_ker", &exact_ker);
+
+    // ========================================================================
+    // Modular (Z/pZ) Dense Linear Algebra and Polynomials
+    // ========================================================================
+    using V32 = std::vector<int32_t>;
+    using V64 = std::vector<int64_t>;
+    mod.add_type<ModDivRem<int32_t>>("ModDivRem32")
+        .method("quotient", [](const ModDivRem<int32_t>& d) { return d.quotient; })
+        .method("remainder", [](const ModDivRem<int32_t>& d) { return d.remainder; });
+    mod.add_type<ModDivRem<int64_t>>("ModDivRem64")
+        .method("quotient", [](const ModDivRem<int64_t>& d) { return d.quotient; })
+        .method("remainder", [](const ModDivRem<int64_t>& d) { return d.remainder; });
+    mod.method("mod_rank", static_cast<int64_t(*)(const V32&, int64_t, int64_t, int64_t)>(&mod_rank));
+    mod.method("mod_rank", static_cast<int64_t(*)(const V64&, int64_t, int64_t, int64_t)>(&mod_rank));
+    mod.method("mod_det", static_cast<int64_t(*)(const V32&, int64_t, int64_t)>(&mod_det));
+    mod.method("mod_det", static_cast<int64_t(*)(const V64&, int64_t, int64_t)>(&mod_det));
+    mod.method("mod_rref", static_cast<V32(*)(const V32&, int64_t, int64_t, int64_t)>(&mod_rref));
+    mod.method("mod_rref", static_cast<V64(*)(const V64&, int64_t, int64_t, int64_t)>(&mod_rref));
+    mod.method("mod_inverse", static_cast<V32(*)(const V32&, int64_t, int64_t)>(&mod_inverse));
+    mod.method("mod_inverse", static_cast<V64(*)(const V64&, int64_t, int64_t)>(&mod_inverse));
+    mod.method("mod_matmul", static_cast<V32(*)(const V32&, const V32&, int64_t, int64_t, int64_t, int64_t, int32_t)>(&mod_matmul));
+    mod.method("mod_matmul", static_cast<V64(*)(const V64&, const V64&, int64_t, int64_t, int64_t, int64_t, int32_t)>(&mod_matmul));
+    mod.method("mod_poly_mul", static_cast<V32(*)(const V32&, const V32&, int64_t)>(&mod_poly_mul));
+    mod.method("mod_poly_mul", static_cast<V64(*)(const V64&, const V64&, int64_t)>(&mod_poly_mul));
+    mod.method("mod_poly_divrem", static_cast<ModDivRem<int32_t>(*)(const V32&, const V32&, int64_t)>(&mod_poly_divrem));
+    mod.method("mod_poly_divrem", static_cast<ModDivRem<int64_t>(*)(const V64&, const V64&, int64_t)>(&mod_poly_divrem));
+    mod.method("mod_poly_gcd", static_cast<V32(*)(const V32&, const V32&, int64_t)>(&mod_poly_gcd));
+    mod.method("mod_poly_gcd", static_cast<V64(*)(const V64&, const V64&, int64_t)>(&mod_poly_gcd));
+    mod.method("mod_poly_eval", static_cast<V32(*)(const V32&, const V32&, int64_t, int32_t)>(&mod_poly_eval));
+    mod.method("mod_poly_eval", static_cast<V64(*)(const V64&, const V64&, int64_t, int32_t)>(&mod_poly_eval));
+
+    // ========================================================================
+    // Sparse Matrices (CSC)
+    // ========================================================================
+    mod.add_type<CscMatrix>("CscMatrix")
+        .method("rows", [](const CscMatrix& m) { return m.rows; })
+        .method("cols", [](const CscMatrix& m) { return m.cols; })
+        .method("colptr", [](const CscMatrix& m) { return m.colptr; })
+        .method("rowval", [](const CscMatrix& m) { return m.rowval; })
+        .method("nzval", [](const CscMatrix& m) { return m.nzval; });
+    mod.add_type<SparseSolveResult>("SparseSolveResult")
+        .method("x", [](const SparseSolveResult& r) { return r.x; })
+        .method("iterations", [](const SparseSolveResult& r) { return r.iterations; })
+        .method("residual", [](const SparseSolveResult& r) { return r.residual; })
+        .method("converged", [](const SparseSolveResult& r) { return r.converged; });
+    mod.method("make_csc_matrix", &make_csc_matrix);
+    mod.method("csc_to_gen", &csc_to_gen);
+    mod.method("gen_to_csc", &gen_to_csc);
+    mod.method("sparse_solve", &sparse_solve);
+    mod.method("sparse_rank", &sparse_rank);
+
+    // ========================================================================
+    // Poly - Polynomial handle in giac's internal representation
+    // ========================================================================
+    mod.add_type<Poly>("Poly")
+        .constructor<const Gen&, const std::vector<std::string>&>()
+        .method("variables", &Poly::variables)
+        .method("nterms", &Poly::nterms)
+        .method("is_zero", &Poly::is_zero)
+        .method("degree", &Poly::degree)
+        .method("total_degree", &Poly::total_degree)
+        .method("to_gen", &Poly::to_gen)
+        .method("to_string", &Poly::to_string)
+        .method("pow", &Poly::pow)
+        .method("derivative", &Poly::derivative)
+        .method("evaluate", &Poly::evaluate);
+    mod.add_type<PolyFactorization>("PolyFactorization")
+        .method("factors", [](const PolyFactorization& f) { return f.factors; })
+        .method("multiplicities", [](const PolyFactorization& f) { return f.multiplicities; });
+    mod.method("poly_gcd", &poly_gcd);
+    mod.method("poly_factor", &poly_factor);
+
+    // ========================================================================
+    // Sparse Polynomial Exchange (exponent matrix + coefficients)
+    // ========================================================================
+    mod.add_type<SparsePoly>("SparsePoly")
+        .method("nvars", [](const SparsePoly& p) { return p.nvars; })
+        .method("nterms", [](const SparsePoly& p) { return p.nterms; })
+        .method("exponents", [](const SparsePoly& p) { return p.exponents; })
+        .method("num", [](const SparsePoly& p) { return p.num; })
+        .method("den", [](const SparsePoly& p) { return p.den; });
+    mod.method("make_sparse_poly", &make_sparse_poly);
+    mod.method("poly_to_sparse",
+        static_cast<SparsePoly(*)(const Gen&, const std::vector<std::string>&)>(&poly_to_sparse));
+    mod.method("poly_to_sparse", static_cast<SparsePoly(*)(const Poly&)>(&poly_to_sparse));
+    mod.method("poly_from_sparse", &poly_from_sparse);
+    mod.method("sparse_to_poly", &sparse_to_poly);
+
+    // ========================================================================
+    // Groebner Bases
+    // ========================================================================
+    mod.set_const("GROEBNER_REVLEX", static_cast<int32_t>(GROEBNER_REVLEX));
+    mod.set_const("GROEBNER_PLEX", static_cast<int32_t>(GROEBNER_PLEX));
+    mod.set_const("GROEBNER_TDEG", static_cast<int32_t>(GROEBNER_TDEG));
+    mod.set_const("GROEBNER_STAGE_INPUT", static_cast<int32_t>(GROEBNER_STAGE_INPUT));
+    mod.set_const("GROEBNER_STAGE_COMPUTE", static_cast<int32_t>(GROEBNER_STAGE_COMPUTE));
+    mod.set_const("GROEBNER_STAGE_OUTPUT", static_cast<int32_t>(GROEBNER_STAGE_OUTPUT));
+    mod.add_type<GroebnerOptions>("GroebnerOptions")
+        .method("num_threads", [](const GroebnerOptions& o) { return o.num_threads; })
+        .method("modulus", [](const GroebnerOptions& o) { return o.modulus; })
+        .method("certify", [](const GroebnerOptions& o) { return o.certify; });
+    mod.method("make_groebner_options", &make_groebner_options);
+    // progress: a @cfunction(stage::Int32, done::Int64, total::Int64, data::Ptr{Cvoid})
+    mod.method("set_groebner_progress", [](GroebnerOptions& o, void* progress, void* data) {
+        o.progress = reinterpret_cast<GroebnerProgress>(progress);
+        o.progress_data = data;
+    });
+    mod.method("groebner", &groebner);
+
+    // ========================================================================
+    // Batch Polynomial Roots
+    // ========================================================================
+    mod.add_type<RootBatch>("RootBatch")
+        .method("roots", [](const RootBatch& b) { return b.roots; })
+        .method("mp_roots", [](const RootBatch& b) { return b.mp_roots; })
+        .method("offsets", [](const RootBatch& b) { return b.offsets; })
+        .method("status", [](const RootBatch& b) { return b.status; })
+        .method("error_count", [](const RootBatch& b) { return b.error_count; });
+    mod.method("proot_batch",
+        static_cast<RootBatch(*)(const std::vector<double>&, const std::vector<int64_t>&, int32_t, int32_t)>(&proot_batch));
+    mod.method("proot_batch",
+        static_cast<RootBatch(*)(const ExactInts&, const std::vector<int64_t>&, int32_t, int32_t)>(&proot_batch));
+
+    // ========================================================================
+    // Multipoint Substitution
+    // ========================================================================
+    mod.method("subst_many",
+        static_cast<std::vector<Gen>(*)(const Gen&, const std::vector<std::string>&,
+                                        const std::vector<Gen>&, int32_t)>(&subst_many));
+    mod.method("subst_many",
+        static_cast<ExactMatrix(*)(const Gen&, const std::vector<std::string>&,
+                                   const ExactMatrix&, int32_t)>(&subst_many));
+
+    // ========================================================================
+    // Compiled Numeric Evaluation
+    // ========================================================================
+    mod.add_type<IntervalBounds>("IntervalBounds")
+        .method("lo", [](const IntervalBounds& b) { return b.lo; })
+        .method("hi", [](const IntervalBounds& b) { return b.hi; });
+    mod.add_type<CompiledFunction>("CompiledFunction")
+        .constructor<const std::vector<Gen>&, const std::vector<std::string>&>()
+        .constructor<const std::vector<Gen>&, const std::vector<std::string>&, bool>()
+        .method("num_inputs", &CompiledFunction::num_inputs)
+        .method("num_outputs", &CompiledFunction::num_outputs)
+        .method("num_instructions", &CompiledFunction::num_instructions)
+        .method("variables", &CompiledFunction::variables)
+        .method("eval", static_cast<std::vector<double>(CompiledFunction::*)(const std::vector<double>&) const>(
+            &CompiledFunction::eval))
+        .method("eval_batch", &CompiledFunction::eval_batch)
+        .method("is_complex", &CompiledFunction::is_complex)
+        .method("eval_complex", static_cast<std::vector<double>(CompiledFunction::*)(const std::vector<double>&) const>(
+            &CompiledFunction::eval_complex))
+        .method("eval_complex_batch", &CompiledFunction::eval_complex_batch)
+        .method("jacobian", &CompiledFunction::jacobian)
+        .method("eval_interval_batch", &CompiledFunction::eval_interval_batch);
+    // In-place evaluation into caller-owned arrays
+    mod.method("eval!", [](const CompiledFunction& f, jlcxx::ArrayRef<double> x,
+                           jlcxx::ArrayRef<double> y) {
+        if (f.is_complex()) {
+            throw std::runtime_error("eval!: function was compiled in complex mode, use eval_complex!");
+        }
+        if (x.size() != static_cast<size_t>(f.num_inputs()) ||
+            y.size() != static_cast<size_t>(f.num_outputs())) {
+            throw std::runtime_error("eval!: array sizes do not match the CompiledFunction");
+        }
+        f.eval(x.data(), y.data());
+    });
+    // In-place complex evaluation; z and w are reinterpreted ComplexF64 arrays
+    mod.method("eval_complex!", [](const CompiledFunction& f, jlcxx::ArrayRef<double> z,
+                                   jlcxx::ArrayRef<double> w) {
+        if (z.size() != 2 * static_cast<size_t>(f.num_inputs()) ||
+            w.size() != 2 * static_cast<size_t>(f.num_outputs())) {
+            throw std::runtime_error("eval_complex!: array sizes do not match the CompiledFunction");
+        }
+        f.eval_complex(z.data(), w.data());
+    });
+    // In-place enclosure of one box into caller-owned arrays
+    mod.method("eval_interval!", [](const CompiledFunction& f, jlcxx::ArrayRef<double> lo,
+                                    jlcxx::ArrayRef<double> hi, jlcxx::ArrayRef<double> out_lo,
+                                    jlcxx::ArrayRef<double> out_hi) {
+        if (f.is_complex()) {
+            throw std::runtime_error("eval_interval!: function was compiled in complex mode");
+        }
+        size_t nin = static_cast<size_t>(f.num_inputs()), nout = static_cast<size_t>(f.num_outputs());
+        if (lo.size() != nin || hi.size() != nin || out_lo.size() != nout || out_hi.size() != nout) {
+            throw std::runtime_error("eval_interval!: array sizes do not match the CompiledFunction");
+        }
+        f.eval_interval(lo.data(), hi.data(), out_lo.data(), out_hi.data());
+    });
+    mod.method("compiled_function_call_ptr", &compiled_function_call_ptr);
+    mod.method("compiled_ode_rhs_ptr", &compiled_ode_rhs_ptr);
+
+    // ========================================================================
+    // ODE Integration
+    // ========================================================================
+    mod.set_const("ODE_RK45", static_cast<int32_t>(ODE_RK45));
+    mod.set_const("ODE_ROSENBROCK23", static_cast<int32_t>(ODE_ROSENBROCK23));
+    mod.set_const("ODE_SUCCESS", static_cast<int32_t>(ODE_SUCCESS));
+    mod.set_const("ODE_MAX_STEPS", static_cast<int32_t>(ODE_MAX_STEPS));
+    mod.set_const("ODE_STEP_TOO_SMALL", static_cast<int32_t>(ODE_STEP_TOO_SMALL));
+    mod.set_const("ODE_NOT_FINITE", static_cast<int32_t>(ODE_NOT_FINITE));
+    mod.add_type<OdeOptions>("OdeOptions")
+        .method("method", [](const OdeOptions& o) { return o.method; })
+        .method("rtol", [](const OdeOptions& o) { return o.rtol; })
+        .method("atol", [](const OdeOptions& o) { return o.atol; })
+        .method("max_steps", [](const OdeOptions& o) { return o.max_steps; });
+    mod.method("make_ode_options", &make_ode_options);
+    mod.method("set_ode_step_bounds", [](OdeOptions& o, double initial_step, double max_step) {
+        o.initial_step = initial_step;
+        o.max_step = max_step;
+    });
+    mod.add_type<OdeStats>("OdeStats")
+        .method("status", [](const OdeStats& s) { return s.status; })
+        .method("steps", [](const OdeStats& s) { return s.steps; })
+        .method("rejected", [](const OdeStats& s) { return s.rejected; })
+        .method("rhs_evals", [](const OdeStats& s) { return s.rhs_evals; })
+        .method("jacobian_evals", [](const OdeStats& s) { return s.jacobian_evals; })
+        .method("outputs", [](const OdeStats& s) { return s.outputs; })
+        .method("t_reached", [](const OdeStats& s) { return s.t_reached; });
+    mod.add_type<OdeSolution>("OdeSolution")
+        .method("y", [](const OdeSolution& s) { return s.y; })
+        .method("stats", [](const OdeSolution& s) { return s.stats; });
+    mod.method("ode_solve",
+        static_cast<OdeSolution(*)(const CompiledFunction&, const std::vector<double>&,
+                                   const std::vector<double>&, const OdeOptions&)>(&ode_solve));
+    // Trajectory written into a preallocated length(t_out) * n array
+    mod.method("ode_solve!", [](const CompiledFunction& rhs, const std::vector<double>& y0,
+                                const std::vector<double>& t_out, jlcxx::ArrayRef<double> y_out,
+                                const OdeOptions& options) {
+        if (y_out.size() != t_out.size() * y0.size()) {
+            throw std::runtime_error("ode_solve!: y_out must hold length(t_out) * length(y0) values");
+        }
+        return ode_solve(rhs, y0, t_out, y_out.data(), options);
+    });
+
+    // ========================================================================
+    // Adaptive Sampling for Plotting
+    // ========================================================================
+    mod.add_type<SampledCurve>("SampledCurve")
+        .method("x", [](const SampledCurve& c) { return c.x; })
+        .method("y", [](const SampledCurve& c) { return c.y; })
+        .method("evaluations", [](const SampledCurve& c) { return c.evaluations; });
+    mod.method("sample",
+        static_cast<SampledCurve(*)(const CompiledFunction&, double, double, int64_t, double)>(&sample));
+    mod.method("sample",
+        static_cast<SampledCurve(*)(const Gen&, const std::string&, double, double, int64_t, double)>(&sample));
+    mod.add_type<SampledGrid>("SampledGrid")
+        .method("nx", [](const SampledGrid& g) { return g.nx; })
+        .method("ny", [](const SampledGrid& g) { return g.ny; })
+        .method("x", [](const SampledGrid& g) { return g.x; })
+        .method("y", [](const SampledGrid& g) { return g.y; })
+        .method("z", [](const SampledGrid& g) { return g.z; });
+    mod.method("sample_grid",
+        static_cast<SampledGrid(*)(const CompiledFunction&, double, double, int64_t,
+                                   double, double, int64_t, int32_t)>(&sample_grid));
+    mod.method("sample_grid",
+        static_cast<SampledGrid(*)(const Gen&, const std::string&, const std::string&,
+                                   double, double, int64_t, double, double, int64_t, int32_t)>(&sample_grid));
+
+    // ========================================================================
+    // Numerical Quadrature
+    // ========================================================================
+    mod.set_const("QUAD_GAUSS_KRONROD", static_cast<int32_t>(QUAD_GAUSS_KRONROD));
+    mod.set_const("QUAD_TANH_SINH", static_cast<int32_t>(QUAD_TANH_SINH));
+    mod.set_const("QUAD_SUCCESS", static_cast<int32_t>(QUAD_SUCCESS));
+    mod.set_const("QUAD_NOT_CONVERGED", static_cast<int32_t>(QUAD_NOT_CONVERGED));
+    mod.set_const("QUAD_NOT_FINITE", static_cast<int32_t>(QUAD_NOT_FINITE));
+    mod.add_type<QuadOptions>("QuadOptions")
+        .method("method", [](const QuadOptions& o) { return o.method; })
+        .method("rtol", [](const QuadOptions& o) { return o.rtol; })
+        .method("atol", [](const QuadOptions& o) { return o.atol; })
+        .method("max_intervals", [](const QuadOptions& o) { return o.max_intervals; })
+        .method("num_threads", [](const QuadOptions& o) { return o.num_threads; });
+    mod.method("make_quad_options", &make_quad_options);
+    mod.method("set_quad_max_intervals", [](QuadOptions& o, int64_t n) { o.max_intervals = n; });
+    mod.add_type<QuadResult>("QuadResult")
+        .method("value", [](const QuadResult& r) { return r.value; })
+        .method("error", [](const QuadResult& r) { return r.error; })
+        .method("status", [](const QuadResult& r) { return r.status; })
+        .method("evaluations", [](const QuadResult& r) { return r.evaluations; })
+        .method("subdivisions", [](const QuadResult& r) { return r.subdivisions; });
+    mod.method("quad",
+        static_cast<QuadResult(*)(const CompiledFunction&, double, double, const QuadOptions&)>(&quad));
+    mod.method("quad",
+        static_cast<QuadResult(*)(const Gen&, const std::string&, double, double, const QuadOptions&)>(&quad));
+    mod.method("quad_batch", &quad_batch);
+
     // Register Gen operators
     mod.set_override_module(jl_base_module);
     mod.method("+", [](const Gen& a, const Gen& b) { return a + b; });
@@ -239,6 +707,12 @@ JLCXX_MODULE define_julia_module(jlcxx::Module& mod)
     mod.method("==", [](const Gen& a, const Gen& b) { return a == b; });
     mod.method("!=", [](const Gen& a, const Gen& b) { return a != b; });
 
+    // Poly operators
+    mod.method("+", [](const Poly& a, const Poly& b) { return a + b; });
+    mod.method("-", [](const Poly& a, const Poly& b) { return a - b; });
+    mod.method("*", [](const Poly& a, const Poly& b) { return a * b; });
+    mod.method("-", [](const Poly& a) { return -a; });
+
     // Mixed-type operators: Gen × int64_t
     mod.method("+", [](const Gen& a, int64_t b) { return a + Gen(b); });
     mod.method("+", [](int64_t a, const Gen& b) { return Gen(a) + b; });
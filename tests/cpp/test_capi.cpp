@@ -0,0 +1,160 @@
+/**
+ * @file test_capi.cpp
+ * @brief Tests for the plain C ABI (libgiac_capi)
+ *
+ * Uses only giac_capi.h, as a C or ctypes caller would.
+ */
+
+#include "giac_capi.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+static std::string text(giac_capi_gen g) {
+    char buf[256];
+    int32_t st = giac_capi_gen_to_string(g, buf, sizeof buf, nullptr);
+    assert(st == GIAC_CAPI_OK);
+    return buf;
+}
+
+static giac_capi_gen eval(const char* expr) {
+    giac_capi_gen g = nullptr;
+    int32_t st = giac_capi_eval(expr, std::strlen(expr), &g);
+    assert(st == GIAC_CAPI_OK && g != nullptr);
+    return g;
+}
+
+TEST(version) {
+    assert(giac_capi_version() != nullptr);
+    assert(std::strlen(giac_capi_version()) > 0);
+}
+
+TEST(eval_and_to_string) {
+    giac_capi_gen g = eval("2+3");
+    assert(giac_capi_gen_type(g) == GIAC_CAPI_TYPE_INT);
+    int64_t v = 0;
+    assert(giac_capi_gen_to_int64(g, &v) == GIAC_CAPI_OK && v == 5);
+    assert(text(g) == "5");
+    giac_capi_gen_free(g);
+}
+
+TEST(expression_not_nul_terminated) {
+    const char expr[] = "1+2garbage";
+    giac_capi_gen g = nullptr;
+    assert(giac_capi_eval(expr, 3, &g) == GIAC_CAPI_OK);
+    assert(text(g) == "3");
+    giac_capi_gen_free(g);
+}
+
+TEST(parse_error_sets_last_error) {
+    giac_capi_gen g = nullptr;
+    int32_t st = giac_capi_eval("2*)", 3, &g);
+    assert(st == GIAC_CAPI_PARSE_ERROR);
+    assert(g == nullptr);
+    size_t needed = 0;
+    assert(giac_capi_last_error(nullptr, 0, &needed) == GIAC_CAPI_BUFFER_TOO_SMALL);
+    assert(needed > 0);
+
+    // A null buffer with a nonzero capacity is rejected, message kept
+    assert(giac_capi_last_error(nullptr, 16, nullptr) == GIAC_CAPI_INVALID_ARGUMENT);
+    size_t again = 0;
+    giac_capi_last_error(nullptr, 0, &again);
+    assert(again == needed);
+}
+
+TEST(string_buffer_too_small) {
+    giac_capi_gen g = eval("x^2+1");
+    char buf[3];
+    size_t needed = 0;
+    assert(giac_capi_gen_to_string(g, buf, sizeof buf, &needed) == GIAC_CAPI_BUFFER_TOO_SMALL);
+    assert(needed == std::strlen("x^2+1"));
+    assert(std::strlen(buf) == 2);
+    giac_capi_gen_free(g);
+}
+
+TEST(arithmetic) {
+    giac_capi_gen a = giac_capi_gen_from_int64(7);
+    giac_capi_gen b = giac_capi_gen_from_int64(2);
+    giac_capi_gen s = nullptr, q = nullptr;
+    assert(giac_capi_add(a, b, &s) == GIAC_CAPI_OK);
+    assert(text(s) == "9");
+    assert(giac_capi_div(a, b, &q) == GIAC_CAPI_OK);
+    assert(text(q) == "7/2");
+    giac_capi_gen_free(a);
+    giac_capi_gen_free(b);
+    giac_capi_gen_free(s);
+    giac_capi_gen_free(q);
+}
+
+TEST(apply_function) {
+    giac_capi_gen x = nullptr;
+    assert(giac_capi_gen_identifier("x", 1, &x) == GIAC_CAPI_OK);
+    giac_capi_gen e = eval("x^3");
+    giac_capi_gen args[2] = {e, x};
+    giac_capi_gen d = nullptr;
+    assert(giac_capi_apply("diff", 4, args, 2, &d) == GIAC_CAPI_OK);
+    assert(text(d) == "3*x^2");
+    giac_capi_gen_free(x);
+    giac_capi_gen_free(e);
+    giac_capi_gen_free(d);
+}
+
+TEST(context_eval) {
+    giac_capi_context ctx = giac_capi_context_new();
+    assert(ctx != nullptr);
+    giac_capi_gen g = nullptr;
+    assert(giac_capi_eval_in(ctx, "a:=4", 4, &g) == GIAC_CAPI_OK);
+    giac_capi_gen_free(g);
+    assert(giac_capi_eval_in(ctx, "a*2", 3, &g) == GIAC_CAPI_OK);
+    assert(text(g) == "8");
+    giac_capi_gen_free(g);
+    giac_capi_context_free(ctx);
+}
+
+TEST(double_and_copy) {
+    giac_capi_gen g = giac_capi_gen_from_double(1.5);
+    giac_capi_gen c = giac_capi_gen_copy(g);
+    giac_capi_gen_free(g);
+    double v = 0;
+    assert(giac_capi_gen_to_double(c, &v) == GIAC_CAPI_OK && v == 1.5);
+    giac_capi_gen_free(c);
+}
+
+TEST(invalid_arguments) {
+    giac_capi_gen out = nullptr;
+    assert(giac_capi_gen_type(nullptr) == -1);
+    assert(giac_capi_add(nullptr, nullptr, &out) == GIAC_CAPI_INVALID_ARGUMENT);
+    giac_capi_gen s = eval("x");
+    int64_t v = 0;
+    assert(giac_capi_gen_to_int64(s, &v) == GIAC_CAPI_INVALID_ARGUMENT);
+    giac_capi_gen_free(s);
+    giac_capi_gen_free(nullptr);
+}
+
+int main() {
+    std::cout << "=== C ABI Tests ===" << std::endl;
+
+    RUN_TEST(version);
+    RUN_TEST(eval_and_to_string);
+    RUN_TEST(expression_not_nul_terminated);
+    RUN_TEST(parse_error_sets_last_error);
+    RUN_TEST(string_buffer_too_small);
+    RUN_TEST(arithmetic);
+    RUN_TEST(apply_function);
+    RUN_TEST(context_eval);
+    RUN_TEST(double_and_copy);
+    RUN_TEST(invalid_arguments);
+
+    std::cout << "\n=== All C ABI tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,480 @@
+/**
+ * @file test_compiled.cpp
+ * @brief Tests for compiled numeric evaluation (CompiledFunction) and the
+ *        native ODE integrators
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+static CompiledFunction compile(const std::vector<std::string>& exprs,
+                                const std::vector<std::string>& vars) {
+    std::vector<Gen> gens;
+    for (const auto& e : exprs) gens.push_back(giac_eval(e));
+    return CompiledFunction(gens, vars);
+}
+
+static bool near(double a, double b, double tol = 1e-12) {
+    return std::fabs(a - b) <= tol * std::max(1.0, std::fabs(b));
+}
+
+TEST(compiled_matches_libm) {
+    CompiledFunction f = compile({"x^2*sin(y) + exp(x)/3 - sqrt(y)", "ln(x)*atan(y)/x^3"}, {"x", "y"});
+    assert(f.num_inputs() == 2 && f.num_outputs() == 2);
+    double x = 1.7, y = 0.4;
+    auto r = f.eval({x, y});
+    assert(near(r[0], x * x * std::sin(y) + std::exp(x) / 3 - std::sqrt(y)));
+    assert(near(r[1], std::log(x) * std::atan(y) / (x * x * x)));
+    std::cout << "f(1.7, 0.4) = " << r[0] << " ";
+}
+
+TEST(compiled_folds_and_shares) {
+    // pi*x: the constant is folded, leaving const, input and one multiply
+    assert(compile({"pi*x"}, {"x"}).num_instructions() == 3);
+    // (x+1) is computed once for both powers
+    CompiledFunction f = compile({"(x+1)^2 + (x+1)^3"}, {"x"});
+    assert(f.num_instructions() == 6);
+    assert(near(f.eval({2.0})[0], 36.0));
+}
+
+TEST(compiled_batch_and_threads) {
+    CompiledFunction f = compile({"cos(x*y) + x", "x*y"}, {"x", "y"});
+    std::vector<double> points;
+    for (int k = 0; k < 2000; ++k) {
+        points.push_back(k * 0.01);
+        points.push_back(1.0 - k * 0.001);
+    }
+    auto serial = f.eval_batch(points, 1);
+    auto threaded = f.eval_batch(points, 0);
+    assert(serial.size() == 4000 && serial == threaded);
+    assert(near(serial[2 * 1500 + 1], 15.0 * (1.0 - 1.5)));
+}
+
+TEST(compiled_jacobian_and_c_pointer) {
+    CompiledFunction f = compile({"x*y", "sin(x)"}, {"x", "y"});
+    auto j = f.jacobian().eval({1.0, 2.0});
+    assert(j.size() == 4);
+    assert(near(j[0], 2.0) && near(j[1], 1.0) && near(j[2], std::cos(1.0)) && near(j[3], 0.0));
+
+    auto call = reinterpret_cast<void (*)(const double*, double*, void*)>(compiled_function_call_ptr());
+    double x[2] = {3.0, 4.0}, y[2];
+    call(x, y, &f);
+    assert(near(y[0], 12.0) && near(y[1], std::sin(3.0)));
+}
+
+TEST(compiled_rejects) {
+    const char* bad[] = {"x + a", "[x, 1]", "int(exp(x^2), x)"};
+    for (const char* e : bad) {
+        bool threw = false;
+        try {
+            compile({e}, {"x"});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+    bool threw = false;
+    try {
+        compile({"x"}, {"x"}).eval({1.0, 2.0});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(ode_rk45) {
+    // y1' = -y1, y2' = cos(t): exp(-t) and sin(t)
+    CompiledFunction rhs = compile({"-y1", "cos(t)"}, {"t", "y1", "y2"});
+    std::vector<double> t_out;
+    for (int k = 0; k <= 20; ++k) t_out.push_back(0.25 * k);
+    OdeSolution sol = ode_solve(rhs, {1.0, 0.0}, t_out, make_ode_options(ODE_RK45, 1e-9, 1e-12, 100000));
+    assert(sol.stats.status == ODE_SUCCESS && sol.stats.outputs == 21);
+    for (size_t k = 0; k < t_out.size(); ++k) {
+        assert(std::fabs(sol.y[2 * k] - std::exp(-t_out[k])) < 1e-7);
+        assert(std::fabs(sol.y[2 * k + 1] - std::sin(t_out[k])) < 1e-7);
+    }
+    std::cout << sol.stats.steps << " steps ";
+
+    // Backwards in time into a caller buffer
+    std::vector<double> back(3 * 2);
+    OdeStats stats = ode_solve(rhs, {std::exp(-5.0), std::sin(5.0)}, {5.0, 2.5, 0.0}, back.data(),
+                               make_ode_options(ODE_RK45, 1e-9, 1e-12, 100000));
+    assert(stats.status == ODE_SUCCESS);
+    assert(std::fabs(back[4] - 1.0) < 1e-6 && std::fabs(back[5]) < 1e-6);
+}
+
+TEST(ode_rosenbrock_stiff) {
+    // y' = -10000 (y - cos(t)); y tracks cos(t) after a fast transient
+    CompiledFunction rhs = compile({"-10000*(y - cos(t))"}, {"t", "y"});
+    OdeOptions options = make_ode_options(ODE_ROSENBROCK23, 1e-4, 1e-8, 100000);
+    OdeSolution stiff = ode_solve(rhs, {0.0}, {0.0, 5.0, 10.0}, options);
+    assert(stiff.stats.status == ODE_SUCCESS && stiff.stats.jacobian_evals > 0);
+    // Quasi-steady state: y ~ cos(t) + sin(t) / 10000
+    assert(std::fabs(stiff.y[2] - (std::cos(10.0) + std::sin(10.0) / 10000)) < 1e-4);
+
+    // The explicit method is stability-bound on the same problem
+    OdeSolution explicit_sol = ode_solve(rhs, {0.0}, {0.0, 5.0, 10.0},
+                                         make_ode_options(ODE_RK45, 1e-4, 1e-8, 100000));
+    assert(explicit_sol.stats.steps > 10 * stiff.stats.steps);
+    std::cout << stiff.stats.steps << " vs " << explicit_sol.stats.steps << " steps ";
+}
+
+TEST(ode_failures) {
+    // y' = y^2 from y(0) = 1 blows up at t = 1
+    CompiledFunction blowup = compile({"y^2"}, {"t", "y"});
+    OdeSolution sol = ode_solve(blowup, {1.0}, {0.0, 0.5, 2.0}, OdeOptions());
+    assert(sol.stats.status != ODE_SUCCESS && sol.stats.outputs == 2);
+    assert(std::fabs(sol.y[1] - 2.0) < 1e-4);
+
+    bool threw = false;
+    try {
+        ode_solve(blowup, {1.0}, {0.0, 1.0, 0.5}, OdeOptions());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(sample_refines_where_curved) {
+    SampledCurve c = sample(giac_eval("sin(1/x)"), "x", 0.05, 1.0, 2000, 1e-3);
+    assert(c.x.size() == c.y.size() && c.x.size() <= 2000);
+    assert(c.x.front() == 0.05 && c.x.back() == 1.0);
+    size_t near_zero = 0;
+    for (size_t k = 0; k < c.x.size(); ++k) {
+        if (k > 0) assert(c.x[k] > c.x[k - 1]);
+        if (std::isfinite(c.y[k])) assert(near(c.y[k], std::sin(1 / c.x[k]), 1e-9));
+        if (c.x[k] < 0.2) ++near_zero;
+    }
+    // Most points go where sin(1/x) oscillates
+    assert(near_zero > c.x.size() / 2);
+
+    // A straight line needs nothing beyond the initial grid
+    SampledCurve line = sample(giac_eval("3*x - 1"), "x", -1.0, 1.0, 1000, 1e-6);
+    assert(line.x.size() == 65 && line.evaluations == 65);
+    std::cout << c.x.size() << " points, " << c.evaluations << " evaluations ";
+}
+
+TEST(sample_breaks_and_domain) {
+    // The jump of floor(x) at 1 is isolated by a NaN break
+    SampledCurve c = sample(giac_eval("floor(x)"), "x", 0.3, 1.7, 500, 1e-3);
+    size_t breaks = 0;
+    for (size_t k = 0; k < c.x.size(); ++k) {
+        if (std::isnan(c.y[k])) {
+            ++breaks;
+            assert(std::fabs(c.x[k] - 1.0) < 1e-8);
+        }
+    }
+    assert(breaks == 1);
+
+    // sqrt is refined towards the edge of its real domain at 0
+    SampledCurve r = sample(giac_eval("sqrt(x)"), "x", -1.0, 1.0, 500, 1e-2);
+    double first_finite = 2.0;
+    for (size_t k = 0; k < r.x.size(); ++k) {
+        if (std::isfinite(r.y[k])) first_finite = std::min(first_finite, r.x[k]);
+    }
+    assert(first_finite >= 0.0 && first_finite < 1e-6);
+
+    // The jump is isolated first, then the wiggle spends the rest of the
+    // budget; the break point counts against it
+    SampledCurve capped = sample(giac_eval("floor(x) + sin(30*x)/10"), "x", 0.3, 1.7, 301, 1e-12);
+    assert(capped.x.size() <= 301 && capped.x.size() >= 299);
+    assert(std::count_if(capped.y.begin(), capped.y.end(),
+                         [](double y) { return std::isnan(y); }) == 1);
+
+    bool threw = false;
+    try {
+        sample(giac_eval("x"), "x", 1.0, 0.0, 100, 1e-3);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(sample_grid_values) {
+    SampledGrid g = sample_grid(giac_eval("x^2 - y"), "x", "y", -1.0, 1.0, 5, 0.0, 3.0, 4, 0);
+    assert(g.nx == 5 && g.ny == 4 && g.z.size() == 20);
+    assert(g.x[0] == -1.0 && g.x[4] == 1.0 && g.y[3] == 3.0);
+    for (int64_t j = 0; j < g.ny; ++j) {
+        for (int64_t i = 0; i < g.nx; ++i) {
+            assert(near(g.z[j * g.nx + i], g.x[i] * g.x[i] - g.y[j]));
+        }
+    }
+}
+
+TEST(quad_gauss_kronrod) {
+    QuadResult r = quad(giac_eval("exp(x)*cos(x)"), "x", 0.0, 2.0, QuadOptions());
+    double exact = (std::exp(2.0) * (std::cos(2.0) + std::sin(2.0)) - 1) / 2;
+    assert(r.status == QUAD_SUCCESS && near(r.value, exact, 1e-10));
+    // A kink is handled by bisection; reversed bounds flip the sign
+    r = quad(giac_eval("abs(x-3/10)"), "x", 1.0, 0.0, QuadOptions());
+    assert(r.status == QUAD_SUCCESS && r.subdivisions > 1 && near(r.value, -0.29, 1e-10));
+
+    // The same subdivision whatever the thread count
+    QuadOptions threaded = make_quad_options(QUAD_GAUSS_KRONROD, 1e-12, 0.0, 0);
+    CompiledFunction f = compile({"sin(1/x)"}, {"x"});
+    QuadResult serial = quad(f, 0.02, 1.0, make_quad_options(QUAD_GAUSS_KRONROD, 1e-12, 0.0, 1));
+    QuadResult parallel = quad(f, 0.02, 1.0, threaded);
+    assert(serial.value == parallel.value && serial.evaluations == parallel.evaluations);
+
+    // integral of x^p over [0, 1] for many p
+    CompiledFunction g = compile({"x^p"}, {"x", "p"});
+    std::vector<double> ps;
+    for (int k = 0; k < 100; ++k) ps.push_back(0.5 + 0.1 * k);
+    std::vector<QuadResult> batch = quad_batch(g, 0.0, 1.0, ps, threaded);
+    assert(batch.size() == ps.size());
+    for (size_t k = 0; k < ps.size(); ++k) {
+        assert(batch[k].status == QUAD_SUCCESS && near(batch[k].value, 1 / (ps[k] + 1), 1e-9));
+    }
+    std::cout << serial.subdivisions << " intervals ";
+}
+
+TEST(quad_tanh_sinh) {
+    QuadOptions ts = make_quad_options(QUAD_TANH_SINH, 1e-12, 0.0, 1);
+    // Endpoint singularities converge in a few levels
+    QuadResult r = quad(giac_eval("1/sqrt(x)"), "x", 0.0, 1.0, ts);
+    assert(r.status == QUAD_SUCCESS && near(r.value, 2.0, 1e-13));
+    QuadResult gk = quad(giac_eval("1/sqrt(x)"), "x", 0.0, 1.0, QuadOptions());
+    assert(r.evaluations * 10 < gk.evaluations);
+    r = quad(giac_eval("ln(x)*x^2"), "x", 0.0, 1.0, ts);
+    assert(r.status == QUAD_SUCCESS && near(r.value, -1.0 / 9, 1e-13));
+    r = quad(giac_eval("sqrt(1-x^2)"), "x", -1.0, 1.0, ts);
+    assert(r.status == QUAD_SUCCESS && near(r.value, std::acos(-1.0) / 2, 1e-13));
+}
+
+TEST(quad_failures) {
+    // Divergent integral: the budget runs out
+    QuadResult r = quad(giac_eval("1/x"), "x", 0.0, 1.0, QuadOptions());
+    assert(r.status == QUAD_NOT_CONVERGED && r.subdivisions == 2000);
+    // Outside the real domain
+    r = quad(giac_eval("sqrt(x-2)"), "x", 0.0, 1.0, QuadOptions());
+    assert(r.status == QUAD_NOT_FINITE && std::isnan(r.value));
+
+    int threw = 0;
+    try {
+        quad(giac_eval("x"), "x", 0.0, std::numeric_limits<double>::infinity(), QuadOptions());
+    } catch (const std::runtime_error&) {
+        ++threw;
+    }
+    try {
+        quad_batch(compile({"x*p"}, {"x", "p"}), 0.0, 1.0, {}, make_quad_options(7, 1e-8, 0.0, 1));
+    } catch (const std::runtime_error&) {
+        ++threw;
+    }
+    assert(threw == 2);
+}
+
+TEST(interval_encloses_points) {
+    CompiledFunction f = compile({"x^2*sin(y) + exp(x)/3 - sqrt(y)", "ln(y)*atan(x)/(x^2+1)", "cosh(x-y)^3"},
+                                 {"x", "y"});
+    std::vector<double> lo, hi;
+    for (int k = 0; k < 500; ++k) {
+        double x = -3.0 + 0.012 * k, y = 0.05 + 0.01 * k;
+        lo.push_back(x);
+        lo.push_back(y);
+        hi.push_back(x + 0.001 * (k % 50));
+        hi.push_back(y + 0.002 * (k % 30));
+    }
+    IntervalBounds b = f.eval_interval_batch(lo, hi, 0);
+    assert(b.lo.size() == 1500 && b.hi.size() == 1500);
+    for (size_t k = 0; k < 500; ++k) {
+        for (int s = 0; s <= 4; ++s) {
+            double x = lo[2 * k] + s * (hi[2 * k] - lo[2 * k]) / 4;
+            double y = hi[2 * k + 1] - s * (hi[2 * k + 1] - lo[2 * k + 1]) / 4;
+            auto v = f.eval({x, y});
+            for (int o = 0; o < 3; ++o) {
+                assert(b.lo[3 * k + o] <= v[o] && v[o] <= b.hi[3 * k + o]);
+            }
+        }
+    }
+    // Degenerate boxes are tight to a few ulp
+    double p[2] = {0.5, 1.5}, ylo[3], yhi[3];
+    f.eval_interval(p, p, ylo, yhi);
+    auto v = f.eval({0.5, 1.5});
+    for (int o = 0; o < 3; ++o) assert(yhi[o] - ylo[o] <= 1e-14 * std::max(1.0, std::fabs(v[o])));
+}
+
+TEST(interval_domains_and_constants) {
+    CompiledFunction f = compile({"sqrt(x)", "ln(x)", "1/x", "sin(x)"}, {"x"});
+    double lo[4], hi[4];
+    double a = -1.0, b = 4.0;
+    f.eval_interval(&a, &b, lo, hi);
+    assert(lo[0] == 0.0 && near(hi[0], 2.0));
+    assert(std::isinf(lo[1]) && lo[1] < 0 && near(hi[1], std::log(4.0)));
+    assert(std::isinf(lo[2]) && std::isinf(hi[2]));
+    assert(lo[3] == -1.0 && hi[3] == 1.0);
+    // Entirely outside the domain of sqrt and ln
+    a = -2.0;
+    b = -1.0;
+    f.eval_interval(&a, &b, lo, hi);
+    assert(std::isnan(lo[0]) && std::isnan(hi[1]) && near(hi[2], -0.5, 1e-15));
+
+    // pi is rounded when compiled, so its enclosure is widened
+    CompiledFunction c = compile({"pi", "3/4"}, {});
+    c.eval_interval(nullptr, nullptr, lo, hi);
+    assert(lo[0] < 3.141592653589793 && hi[0] > 3.141592653589793);
+    assert(lo[1] <= 0.75 && hi[1] >= 0.75);
+
+    // Folded constants are enclosed in interval arithmetic, not widened by an ulp
+    CompiledFunction d = compile({"sqrt(2)+sqrt(3)", "sin(pi/7)^2+cos(pi/7)^2-1"}, {});
+    d.eval_interval(nullptr, nullptr, lo, hi);
+    long double s = std::sqrt(2.0L) + std::sqrt(3.0L);
+    assert(lo[0] <= s && hi[0] >= s && hi[0] - lo[0] < 1e-14);
+    assert(lo[1] <= 0.0 && hi[1] >= 0.0);
+}
+
+TEST(interval_pow_negative_base) {
+    CompiledFunction f = compile({"x^y"}, {"x", "y"});
+    double lo[1], hi[1];
+    double a[2] = {-2.0, 2.0}, b[2] = {-2.0, 2.0};
+    f.eval_interval(a, b, lo, hi);
+    assert(lo[0] == 4.0 && hi[0] == 4.0);
+    a[1] = b[1] = 3.0;
+    f.eval_interval(a, b, lo, hi);
+    assert(lo[0] == -8.0 && hi[0] == -8.0);
+    // A range of exponents that contains integers keeps their signed powers
+    a[1] = 1.5;
+    b[1] = 3.5;
+    f.eval_interval(a, b, lo, hi);
+    assert(lo[0] <= -8.0 && hi[0] >= 4.0);
+}
+
+TEST(complex_mode) {
+    // i is only a constant in complex mode
+    bool threw = false;
+    try {
+        compile({"x + i"}, {"x"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    CompiledFunction f({giac_eval("x*exp(i*y)"), giac_eval("conj(x)*i")}, {"x", "y"}, true);
+    assert(f.is_complex());
+    // Interleaved (re, im) buffers
+    auto w = f.eval_complex({2.0, 1.0, std::acos(-1.0) / 2, 0.0});
+    assert(w.size() == 4);
+    assert(near(w[0], -1.0) && near(w[1], 2.0) && near(w[2], 1.0) && near(w[3], 2.0));
+    threw = false;
+    try {
+        f.eval({1.0, 2.0});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Every real-only entry point rejects a complex-mode function
+    double x[2] = {1.0, 2.0}, y[2] = {0.0, 0.0}, lo[2], hi[2];
+    threw = false;
+    try {
+        f.eval(x, y);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        f.eval_interval(x, x, lo, hi);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        f.eval_interval_batch({1.0, 2.0}, {1.0, 2.0}, 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    // The C callbacks never throw; they report failure as NaN
+    compiled_function_call(x, y, &f);
+    assert(std::isnan(y[0]) && std::isnan(y[1]));
+    CompiledFunction rhs({giac_eval("i*u")}, {"t", "u"}, true);
+    double u = 1.0, du = 0.0;
+    compiled_ode_rhs(&du, &u, &rhs, 0.0);
+    assert(std::isnan(du));
+
+    // A real-mode tape continues into the complex plane
+    CompiledFunction r = compile({"sqrt(x)", "ln(x)"}, {"x"});
+    std::vector<double> points{-4.0, 0.0, -4.0, -0.0, 1.0, 1.0};
+    std::vector<double> batch = r.eval_complex_batch(points, 0);
+    assert(batch.size() == 12);
+    for (int p = 0; p < 2; ++p) {
+        // Both signs of zero land on the upper side of the cut, as in giac
+        assert(near(batch[4 * p], 0.0) && near(batch[4 * p + 1], 2.0));
+        assert(near(batch[4 * p + 2], std::log(4.0)) && near(batch[4 * p + 3], std::acos(-1.0)));
+    }
+}
+
+TEST(complex_matches_giac_evalf) {
+    // Differential test of the compiled complex tape against giac's evalf
+    const char* exprs[] = {
+        "ln(z)", "sqrt(z)", "arg(z)", "exp(i*z) + conj(z)*re(z)", "abs(z) - i*im(z)",
+        "sin(z)*cosh(z)/(z^2+1)", "atan(z) + log10(z)", "(1+2*i)*z^3 - 1/z", "z*sqrt(z^2+1)",
+    };
+    uint64_t seed = 12345;
+    auto uniform = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(seed >> 11) / 9007199254740992.0;
+    };
+    Gen z = make_identifier("z");
+    int checked = 0;
+    for (const char* e : exprs) {
+        Gen g = giac_eval(e);
+        CompiledFunction f({g}, {"z"}, true);
+        for (int k = 0; k < 40; ++k) {
+            double re = 8 * uniform() - 4, im = 8 * uniform() - 4;
+            // Every fifth point on the real axis, across the cut of ln and sqrt
+            if (k % 5 == 0) im = 0.0;
+            auto w = f.eval_complex({re, im});
+            Gen v = giac_evalf(giac_subst(g, z, make_complex(Gen(re), Gen(im))));
+            double vre = v.is_complex() ? v.cplx_re().to_double() : v.to_double();
+            double vim = v.is_complex() ? v.cplx_im().to_double() : 0.0;
+            assert(std::hypot(w[0] - vre, w[1] - vim) <= 1e-9 * std::max(1.0, std::hypot(vre, vim)));
+            ++checked;
+        }
+    }
+    assert(checked == 40 * static_cast<int>(sizeof(exprs) / sizeof(exprs[0])));
+}
+
+int main() {
+    std::cout << "=== GIAC Wrapper Compiled Evaluation Tests ===" << std::endl;
+
+    RUN_TEST(compiled_matches_libm);
+    RUN_TEST(compiled_folds_and_shares);
+    RUN_TEST(compiled_batch_and_threads);
+    RUN_TEST(compiled_jacobian_and_c_pointer);
+    RUN_TEST(compiled_rejects);
+    RUN_TEST(ode_rk45);
+    RUN_TEST(ode_rosenbrock_stiff);
+    RUN_TEST(ode_failures);
+    RUN_TEST(sample_refines_where_curved);
+    RUN_TEST(sample_breaks_and_domain);
+    RUN_TEST(sample_grid_values);
+    RUN_TEST(quad_gauss_kronrod);
+    RUN_TEST(quad_tanh_sinh);
+    RUN_TEST(quad_failures);
+    RUN_TEST(interval_encloses_points);
+    RUN_TEST(interval_domains_and_constants);
+    RUN_TEST(interval_pow_negative_base);
+    RUN_TEST(complex_mode);
+    RUN_TEST(complex_matches_giac_evalf);
+
+    std::cout << "=== All tests passed ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_describe.cpp
+ * @brief Tests for the vector shape census (describe / flatten_*)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+// Gen type codes (see GENTYPE_* in giac_wrapper.cpp)
+constexpr int kInt = 0;
+constexpr int kDouble = 1;
+constexpr int kIdnt = 6;
+
+TEST(describe_scalar) {
+    GenDescription d = describe(Gen(static_cast<int64_t>(7)));
+    assert(d.depth == 0);
+    assert(d.rectangular);
+    assert(d.dims.empty());
+    assert(d.node_count == 1);
+    assert(d.type_counts[kInt] == 1);
+    assert(d.all_immediate_numeric);
+}
+
+TEST(describe_flat_list) {
+    GenDescription d = describe(giac_eval("[1, 2, 3.5]"));
+    assert(d.depth == 1);
+    assert(d.rectangular);
+    assert(d.dims.size() == 1 && d.dims[0] == 3);
+    assert(d.type_counts[kInt] == 2);
+    assert(d.type_counts[kDouble] == 1);
+    assert(d.node_count == 4);
+    assert(d.all_immediate_numeric);
+}
+
+TEST(describe_matrix) {
+    GenDescription d = describe(giac_eval("[[1,2,3],[4,5,6]]"));
+    assert(d.depth == 2);
+    assert(d.rectangular);
+    assert(d.dims.size() == 2 && d.dims[0] == 2 && d.dims[1] == 3);
+    assert(d.node_count == 9);
+    std::cout << "dims = " << d.dims[0] << "x" << d.dims[1] << " ";
+}
+
+TEST(describe_jagged) {
+    GenDescription d = describe(giac_eval("[[1,2],[3]]"));
+    assert(d.depth == 2);
+    assert(!d.rectangular);
+    assert(d.dims.empty());
+}
+
+TEST(describe_mixed_depth) {
+    GenDescription d = describe(giac_eval("[1,[2,3]]"));
+    assert(!d.rectangular);
+    GenDescription d2 = describe(giac_eval("[[2,3],1]"));
+    assert(!d2.rectangular);
+}
+
+TEST(describe_symbolic_leaves) {
+    GenDescription d = describe(giac_eval("[x, 1, 2/3]"));
+    assert(d.type_counts[kIdnt] == 1);
+    assert(!d.all_immediate_numeric);
+    assert(d.rectangular);
+}
+
+TEST(flatten_row_major) {
+    std::vector<int64_t> ints = flatten_int64s(giac_eval("[[1,2],[3,4]]"));
+    assert((ints == std::vector<int64_t>{1, 2, 3, 4}));
+    std::vector<double> dbls = flatten_doubles(giac_eval("[0.5, 2]"));
+    assert(dbls.size() == 2 && dbls[0] == 0.5 && dbls[1] == 2.0);
+}
+
+TEST(flatten_throws_on_non_numeric) {
+    bool threw = false;
+    try {
+        flatten_int64s(giac_eval("[1, x]"));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    std::cout << "=== GIAC Wrapper Describe Tests ===" << std::endl;
+
+    RUN_TEST(describe_scalar);
+    RUN_TEST(describe_flat_list);
+    RUN_TEST(describe_matrix);
+    RUN_TEST(describe_jagged);
+    RUN_TEST(describe_mixed_depth);
+    RUN_TEST(describe_symbolic_leaves);
+    RUN_TEST(flatten_row_major);
+    RUN_TEST(flatten_throws_on_non_numeric);
+
+    std::cout << "=== All tests passed ===" << std::endl;
+    return 0;
+}
@@ -75,6 +75,46 @@ TEST(giac_available) {
     assert(check_giac_available());
 }
 
+// No-throw variants
+TEST(try_eval_ok) {
+    TryResult r = try_eval("1+1");
+    assert(r.ok());
+    assert(r.status() == GIAC_STATUS_OK);
+    ASSERT_EQ("2", r.value().to_string());
+    assert(r.message().empty());
+}
+
+TEST(try_eval_parse_error) {
+    TryResult r = try_eval(")(");
+    assert(!r.ok());
+    assert(r.status() == GIAC_STATUS_PARSE_ERROR);
+    assert(!r.message().empty());
+}
+
+TEST(try_eval_eval_error) {
+    TryResult r = try_eval("error(\"boom\")");
+    assert(r.status() == GIAC_STATUS_EVAL_ERROR);
+    assert(!r.message().empty());
+}
+
+TEST(try_eval_with_context) {
+    GiacContext ctx;
+    assert(try_eval("a:=5", ctx).ok());
+    ASSERT_EQ("10", try_eval("2*a", ctx).value().to_string());
+}
+
+TEST(try_apply_and_tier1) {
+    Gen x = giac_eval("x");
+    TryResult r = try_apply_func1("sin", Gen(static_cast<int64_t>(0)));
+    assert(r.ok());
+    ASSERT_EQ("0", r.value().to_string());
+    r = try_giac_diff(giac_eval("x^2"), x);
+    assert(r.ok());
+    ASSERT_EQ("2*x", r.value().to_string());
+    r = try_apply_func1("error", Gen(std::string("\"boom\"")));
+    assert(r.status() == GIAC_STATUS_EVAL_ERROR);
+}
+
 int main() {
     std::cout << "=== GIAC Wrapper Eval Tests ===" << std::endl;
 
@@ -83,6 +123,11 @@ int main() {
     RUN_TEST(basic_eval);
     RUN_TEST(factor_operation);
     RUN_TEST(error_handling);
+    RUN_TEST(try_eval_ok);
+    RUN_TEST(try_eval_parse_error);
+    RUN_TEST(try_eval_eval_error);
+    RUN_TEST(try_eval_with_context);
+    RUN_TEST(try_apply_and_tier1);
 
     std::cout << "=== All tests passed ===" << std::endl;
     return 0;
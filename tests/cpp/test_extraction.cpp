@@ -10,6 +10,8 @@
 #include <cassert>
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include <algorithm>
 
 using namespace giac_julia;
 
@@ -314,6 +316,54 @@ TEST(strng_value_valid) {
     std::cout << "strng_value(\"hello world\")=\"hello world\" ";
 }
 
+// ============================================================================
+// Interned ids for operator and identifier names
+// ============================================================================
+
+TEST(symb_sommet_id_matches_name) {
+    Gen g = giac_eval("sin(x)");
+    uint32_t id = g.symb_sommet_id();
+    assert(id_to_name(id) == g.symb_sommet_name());
+    // Same operator elsewhere gets the same id
+    assert(giac_eval("sin(y+1)").symb_sommet_id() == id);
+    assert(intern_name("sin") == id);
+    std::cout << "symb_sommet_id(sin(x))=" << id << " ";
+}
+
+TEST(idnt_id_stable) {
+    Gen x1 = make_identifier("x");
+    Gen x2 = giac_eval("x");
+    assert(x1.idnt_id() == x2.idnt_id());
+    assert(make_identifier("y").idnt_id() != x1.idnt_id());
+    assert(id_to_name(x1.idnt_id()) == "x");
+}
+
+TEST(id_to_name_table_is_prefix_stable) {
+    std::vector<std::string> before = id_to_name_table();
+    uint32_t fresh = intern_name("some_name_not_seen_before");
+    std::vector<std::string> after = id_to_name_table();
+    assert(after.size() >= before.size());
+    assert(std::equal(before.begin(), before.end(), after.begin()));
+    assert(after[fresh] == "some_name_not_seen_before");
+}
+
+TEST(interned_ids_throw_on_wrong_type) {
+    bool threw = false;
+    try {
+        Gen(static_cast<int64_t>(1)).idnt_id();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        id_to_name(0xFFFFFFFFu);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
 int main() {
     std::cout << "=== GIAC Wrapper Value Extraction Tests ===" << std::endl;
 
@@ -361,6 +411,12 @@ int main() {
     // String accessor
     RUN_TEST(strng_value_valid);
 
+    // Interned ids
+    RUN_TEST(symb_sommet_id_matches_name);
+    RUN_TEST(idnt_id_stable);
+    RUN_TEST(id_to_name_table_is_prefix_stable);
+    RUN_TEST(interned_ids_throw_on_wrong_type);
+
     std::cout << "=== All extraction tests passed ===" << std::endl;
     return 0;
 }
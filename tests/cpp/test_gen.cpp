@@ -373,6 +373,21 @@ TEST(tier1_pow) {
     std::cout << "pow(2,10)=" << result.to_string() << " ";
 }
 
+TEST(tier1_matches_symbolic_eval) {
+    // The direct path must agree with eval(symbolic) for numeric,
+    // rational, symbolic and not-yet-evaluated arguments
+    Gen x = make_identifier("x");
+    Gen third = giac_eval("1/3");
+    Gen pending = make_symbolic_unevaluated("+", {Gen(static_cast<int64_t>(1)), Gen(static_cast<int64_t>(2))});
+    assert(giac_sin(Gen(0.5)).to_string() == make_symbolic_unevaluated("sin", {Gen(0.5)}).eval().to_string());
+    assert(giac_abs(third).to_string() == "1/3");
+    assert(giac_sin(x).to_string() == "sin(x)");
+    assert(giac_pow(pending, Gen(static_cast<int64_t>(2))).to_string() == "9");
+    assert(giac_diff(giac_eval("x^3"), x).to_string() == "3*x^2");
+
+    std::cout << "abs(1/3)=" << giac_abs(third).to_string() << " ";
+}
+
 int main() {
     std::cout << "=== GIAC Wrapper Gen Tests ===" << std::endl;
 
@@ -419,6 +434,7 @@ int main() {
     RUN_TEST(tier1_subst);
     RUN_TEST(tier1_gcd_lcm);
     RUN_TEST(tier1_pow);
+    RUN_TEST(tier1_matches_symbolic_eval);
 
     std::cout << "=== All tests passed ===" << std::endl;
     return 0;
@@ -0,0 +1,253 @@
+/**
+ * @file test_linalg.cpp
+ * @brief Tests for exact, modular and sparse linear algebra on flat buffers
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+static ExactMatrix int_matrix(int64_t rows, int64_t cols, const std::vector<int64_t>& v) {
+    return make_exact_matrix(rows, cols, make_exact_ints(v), ExactInts());
+}
+
+static ExactMatrix rat_matrix(int64_t rows, int64_t cols, const std::vector<int64_t>& num,
+                              const std::vector<int64_t>& den) {
+    return make_exact_matrix(rows, cols, make_exact_ints(num), make_exact_ints(den));
+}
+
+TEST(det_integer) {
+    ExactMatrix d = exact_det(int_matrix(3, 3, {2, 0, 1, 1, 3, 2, 1, 1, 2}));
+    assert(d.rows == 1 && d.cols == 1);
+    assert(d.den.values.empty() && d.den.limb_offset.empty());
+    assert(d.num.values[0] == 6);
+}
+
+TEST(det_rational) {
+    // [[1/2, 1/3], [1/4, 1]] -> 1/2 - 1/12 = 5/12
+    ExactMatrix d = exact_det(rat_matrix(2, 2, {1, 1, 1, 1}, {2, 3, 4, 1}));
+    assert(d.num.values[0] == 5);
+    assert(d.den.values[0] == 12);
+}
+
+TEST(rref_integer) {
+    ExactMatrix r = exact_rref(int_matrix(2, 3, {1, 2, 3, 2, 4, 7}));
+    std::vector<int64_t> expected = {1, 2, 0, 0, 0, 1};
+    assert(r.rows == 2 && r.cols == 3);
+    assert(r.num.values == expected);
+}
+
+TEST(inverse_rational) {
+    // [[1/2, 0], [0, 3]]^-1 = [[2, 0], [0, 1/3]]
+    ExactMatrix inv = exact_inverse(rat_matrix(2, 2, {1, 0, 0, 3}, {2, 1, 1, 1}));
+    std::vector<int64_t> num = {2, 0, 0, 1};
+    std::vector<int64_t> den = {1, 1, 1, 3};
+    assert(inv.num.values == num);
+    assert(inv.den.values == den);
+}
+
+TEST(inverse_singular_throws) {
+    bool threw = false;
+    try {
+        exact_inverse(int_matrix(2, 2, {1, 2, 2, 4}));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(linsolve) {
+    // x + y = 3, x - y = 1 -> x = 2, y = 1
+    ExactMatrix x = exact_linsolve(int_matrix(2, 2, {1, 1, 1, -1}), int_matrix(2, 1, {3, 1}));
+    std::vector<int64_t> expected = {2, 1};
+    assert(x.rows == 2 && x.cols == 1);
+    assert(x.num.values == expected);
+}
+
+TEST(ker) {
+    ExactMatrix k = exact_ker(int_matrix(2, 3, {1, 0, -1, 0, 1, -1}));
+    assert(k.rows == 1 && k.cols == 3);
+    assert(k.num.values[0] == k.num.values[1] && k.num.values[1] == k.num.values[2]);
+
+    ExactMatrix trivial = exact_ker(int_matrix(2, 2, {1, 0, 0, 1}));
+    assert(trivial.rows == 0);
+}
+
+TEST(bigint_limbs_roundtrip) {
+    // 2^64 on the diagonal: det = 2^128, which needs the limb form
+    ExactInts num = make_exact_ints_limbs({1, 0, 0, 1}, {0, 2, 2, 2, 4}, {0, 1, 0, 1});
+    ExactMatrix d = exact_det(make_exact_matrix(2, 2, num, ExactInts()));
+    assert(d.num.values.empty());
+    assert(d.num.sign.size() == 1 && d.num.sign[0] == 1);
+    std::vector<uint64_t> limbs = {0, 0, 1};
+    assert(d.num.limbs == limbs);
+}
+
+TEST(size_mismatch_throws) {
+    bool threw = false;
+    try {
+        int_matrix(2, 2, {1, 2, 3});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(mod_matrix_ops) {
+    // [[1, 2], [3, 4]] mod 7: det = -2 = 5
+    std::vector<int64_t> a = {1, 2, 3, 4};
+    assert(mod_det(a, 2, 7) == 5);
+    assert(mod_rank(a, 2, 2, 7) == 2);
+    std::vector<int64_t> inv = mod_inverse(a, 2, 7);
+    std::vector<int64_t> id = {1, 0, 0, 1};
+    assert(mod_matmul(a, inv, 2, 2, 2, 7, 1) == id);
+
+    // [[1, 2], [2, 4]] is singular
+    std::vector<int32_t> s = {1, 2, 2, 4};
+    assert(mod_rank(s, 2, 2, 7) == 1);
+    assert(mod_det(s, 2, 7) == 0);
+    std::vector<int32_t> r = {1, 2, 0, 0};
+    assert(mod_rref(s, 2, 2, 7) == r);
+    bool threw = false;
+    try {
+        mod_inverse(s, 2, 7);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(mod_matmul_large_modulus) {
+    // p = 2^61 - 1 exercises the 128-bit accumulator
+    const int64_t p = (int64_t(1) << 61) - 1;
+    std::vector<int64_t> a = {p - 1, p - 1};
+    std::vector<int64_t> b = {p - 1, p - 1};
+    std::vector<int64_t> c = mod_matmul(a, b, 1, 2, 1, p, 0);
+    assert(c.size() == 1 && c[0] == 2);   // (-1)(-1) + (-1)(-1)
+
+    std::vector<int32_t> x = {-1, 5};
+    std::vector<int32_t> y = {3, 1};
+    std::vector<int32_t> z = mod_matmul(x, y, 1, 2, 1, 11, 1);
+    assert(z[0] == 2);
+}
+
+TEST(mod_poly_ops) {
+    // (x + 1)(x + 2) = x^2 + 3x + 2 mod 5
+    std::vector<int64_t> a = {1, 1}, b = {2, 1};
+    std::vector<int64_t> prod = mod_poly_mul(a, b, 5);
+    std::vector<int64_t> expected = {2, 3, 1};
+    assert(prod == expected);
+
+    ModDivRem<int64_t> d = mod_poly_divrem(prod, a, 5);
+    assert(d.quotient == b);
+    assert(d.remainder.empty());
+
+    std::vector<int64_t> c = {3, 1};   // x + 3
+    assert(mod_poly_gcd(prod, mod_poly_mul(a, c, 5), 5) == a);
+
+    std::vector<int64_t> pts = {0, 1, 4};
+    std::vector<int64_t> vals = mod_poly_eval(prod, pts, 5, 2);
+    std::vector<int64_t> want = {2, 1, 0};   // 2, 6, 30 mod 5
+    assert(vals == want);
+}
+
+TEST(mod_bad_modulus_throws) {
+    bool threw = false;
+    try {
+        mod_det(std::vector<int32_t>{1}, 1, int64_t(1) << 40);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(csc_roundtrip) {
+    // [[1, 0, 2], [0, 0, 3]]
+    CscMatrix m = make_csc_matrix(2, 3, {0, 1, 1, 3}, {0, 0, 1}, {1.0, 2.0, 3.0});
+    Gen g = csc_to_gen(m);
+    assert(g.type() == 17);  // _MAP type
+    assert(g.map_size() == 3);
+    CscMatrix back = gen_to_csc(g, 2, 3);
+    assert(back.colptr == m.colptr);
+    assert(back.rowval == m.rowval);
+    assert(back.nzval == m.nzval);
+
+    // Dense input drops zeros and infers the shape
+    CscMatrix dense = gen_to_csc(giac_eval("[[0,5],[7,0]]"), -1, -1);
+    assert(dense.rows == 2 && dense.cols == 2);
+    std::vector<int64_t> colptr = {0, 1, 2};
+    std::vector<int64_t> rowval = {1, 0};
+    assert(dense.colptr == colptr && dense.rowval == rowval);
+
+    // Repeated entries are summed; a zero sum disappears
+    CscMatrix dup = make_csc_matrix(2, 2, {0, 3, 5}, {1, 0, 1, 0, 0}, {2.0, 4.0, 3.0, 1.0, -1.0});
+    CscMatrix summed = gen_to_csc(csc_to_gen(dup), 2, 2);
+    std::vector<int64_t> dup_colptr = {0, 2, 2}, dup_rowval = {0, 1};
+    std::vector<double> dup_nzval = {4.0, 5.0};
+    assert(summed.colptr == dup_colptr && summed.rowval == dup_rowval && summed.nzval == dup_nzval);
+}
+
+TEST(sparse_solve_tridiagonal) {
+    // 4 on the diagonal, -1 on both off-diagonals, solution all ones
+    const int64_t n = 50;
+    std::vector<int64_t> colptr = {0}, rowval;
+    std::vector<double> nzval;
+    for (int64_t j = 0; j < n; ++j) {
+        if (j > 0) { rowval.push_back(j - 1); nzval.push_back(-1.0); }
+        rowval.push_back(j); nzval.push_back(4.0);
+        if (j < n - 1) { rowval.push_back(j + 1); nzval.push_back(-1.0); }
+        colptr.push_back(static_cast<int64_t>(rowval.size()));
+    }
+    std::vector<double> b(n, 2.0);
+    b.front() = b.back() = 3.0;
+    SparseSolveResult r = sparse_solve(make_csc_matrix(n, n, colptr, rowval, nzval), b, 1e-12, 0, 1);
+    assert(r.converged);
+    for (double x : r.x) assert(std::fabs(x - 1.0) < 1e-9);
+}
+
+TEST(sparse_rank) {
+    // [[1, 2, 3], [2, 4, 6], [1, 0, 1]] has rank 2
+    CscMatrix m = make_csc_matrix(3, 3, {0, 3, 5, 8}, {0, 1, 2, 0, 1, 0, 1, 2},
+                                  {1, 2, 1, 2, 4, 3, 6, 1});
+    assert(sparse_rank(m, 0) == 2);
+    assert(sparse_rank(m, 7) == 2);
+}
+
+int main() {
+    std::cout << "=== Exact Linear Algebra Tests ===" << std::endl;
+
+    RUN_TEST(det_integer);
+    RUN_TEST(det_rational);
+    RUN_TEST(rref_integer);
+    RUN_TEST(inverse_rational);
+    RUN_TEST(inverse_singular_throws);
+    RUN_TEST(linsolve);
+    RUN_TEST(ker);
+    RUN_TEST(bigint_limbs_roundtrip);
+    RUN_TEST(size_mismatch_throws);
+    RUN_TEST(mod_matrix_ops);
+    RUN_TEST(mod_matmul_large_modulus);
+    RUN_TEST(mod_poly_ops);
+    RUN_TEST(mod_bad_modulus_throws);
+    RUN_TEST(csc_roundtrip);
+    RUN_TEST(sparse_solve_tridiagonal);
+    RUN_TEST(sparse_rank);
+
+    std::cout << "\n=== All exact linear algebra tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,409 @@
+/**
+ * @file test_poly.cpp
+ * @brief Tests for the polynomial handle (Poly), sparse polynomial exchange,
+ *        Groebner bases and batch root finding
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+// True when g and the expression expected are equal after normalization
+static bool same(const Gen& g, const std::string& expected) {
+    return giac_normal(g - giac_eval(expected)).to_string() == "0";
+}
+
+static Poly poly(const std::string& expr, const std::vector<std::string>& vars) {
+    return Poly(giac_eval(expr), vars);
+}
+
+static SparsePoly sparse(const std::string& expr, const std::vector<std::string>& vars) {
+    return poly_to_sparse(giac_eval(expr), vars);
+}
+
+// True when some basis element is a constant multiple of expected
+static bool has_multiple(const std::vector<SparsePoly>& basis, const std::vector<std::string>& vars,
+                         const std::string& expected) {
+    for (const auto& b : basis) {
+        Gen ratio = giac_normal(poly_from_sparse(b, vars) / giac_eval(expected));
+        if (ratio.is_numeric() || ratio.is_fraction()) return true;
+    }
+    return false;
+}
+
+TEST(roundtrip) {
+    Poly p = poly("3*x^2*y - y + 1/2", {"x", "y"});
+    assert(p.nterms() == 3);
+    assert(p.degree(0) == 2);
+    assert(p.degree(1) == 1);
+    assert(p.total_degree() == 3);
+    assert(same(p.to_gen(), "3*x^2*y - y + 1/2"));
+    std::vector<std::string> vars = {"x", "y"};
+    assert(p.variables() == vars);
+}
+
+TEST(arithmetic) {
+    Poly a = poly("x+1", {"x"});
+    Poly b = poly("x-1", {"x"});
+    assert(same((a * b).to_gen(), "x^2-1"));
+    assert(same((a + b).to_gen(), "2*x"));
+    assert((a - a).is_zero());
+    assert(same((-a).to_gen(), "-x-1"));
+    assert(same(a.pow(3).to_gen(), "x^3+3*x^2+3*x+1"));
+    assert(same(a.pow(0).to_gen(), "1"));
+}
+
+TEST(gcd_and_factor) {
+    Poly a = poly("x^2-1", {"x"});
+    Poly b = poly("x^2+2*x+1", {"x"});
+    Gen g = poly_gcd(a, b).to_gen();
+    assert(same(g, "x+1") || same(g, "-x-1"));
+
+    PolyFactorization f = poly_factor(poly("x^3-x", {"x"}));
+    assert(f.factors.size() == f.multiplicities.size());
+    Gen prod = giac_eval("1");
+    for (size_t i = 0; i < f.factors.size(); ++i) {
+        prod = prod * giac_pow(f.factors[i].to_gen(), Gen(static_cast<int64_t>(f.multiplicities[i])));
+    }
+    assert(same(prod, "x^3-x"));
+}
+
+TEST(derivative_and_evaluate) {
+    Poly p = poly("x^3*y + 2*x*y^2", {"x", "y"});
+    assert(same(p.derivative(0).to_gen(), "3*x^2*y + 2*y^2"));
+    assert(same(p.derivative(1).to_gen(), "x^3 + 4*x*y"));
+    Gen v = p.evaluate({Gen(static_cast<int64_t>(2)), Gen(static_cast<int64_t>(3))});
+    assert(v.to_string() == "60");   // 8*3 + 2*2*9
+}
+
+TEST(errors) {
+    bool threw = false;
+    try {
+        poly("1/(x+1)", {"x"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A transcendental coefficient may not mention a variable
+    threw = false;
+    try {
+        poly("sin(x)*y", {"x", "y"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(poly("sin(z)*y", {"x", "y"}).nterms() == 1);
+
+    threw = false;
+    try {
+        Poly sum = poly("x", {"x"}) + poly("y", {"y"});
+        (void)sum;
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(sparse_export) {
+    SparsePoly sp = poly_to_sparse(giac_eval("3*x^2*y - 5*y + 7"), {"x", "y"});
+    assert(sp.nvars == 2 && sp.nterms == 3);
+    assert(sp.den.values.empty() && sp.den.limb_offset.empty());
+    // Check each term regardless of giac's monomial order
+    int found = 0;
+    for (int64_t t = 0; t < sp.nterms; ++t) {
+        int32_t ex = sp.exponents[t * 2], ey = sp.exponents[t * 2 + 1];
+        int64_t c = sp.num.values[t];
+        if (ex == 2 && ey == 1 && c == 3) ++found;
+        if (ex == 0 && ey == 1 && c == -5) ++found;
+        if (ex == 0 && ey == 0 && c == 7) ++found;
+    }
+    assert(found == 3);
+
+    SparsePoly r = poly_to_sparse(giac_eval("x/2 + 1/3"), {"x"});
+    assert(!r.den.values.empty());
+}
+
+TEST(sparse_import) {
+    // Unsorted terms with a repeated exponent row: x^2 + 2x + (x^2 - x^2) + 1/2
+    SparsePoly sp = make_sparse_poly(1, {1, 2, 0, 2},
+                                     make_exact_ints({2, 1, 1, -1}),
+                                     make_exact_ints({1, 1, 2, 1}));
+    Gen g = poly_from_sparse(sp, {"x"});
+    assert(same(g, "2*x + 1/2"));
+
+    Poly p = sparse_to_poly(sp, {"x"});
+    assert(p.nterms() == 2);
+}
+
+TEST(sparse_rejects_nonpositive_den) {
+    for (int64_t d : {0, -2}) {
+        SparsePoly sp = make_sparse_poly(1, {1, 0}, make_exact_ints({1, 1}),
+                                         make_exact_ints({1, d}));
+        bool threw = false;
+        try {
+            poly_from_sparse(sp, {"x"});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+}
+
+TEST(sparse_roundtrip_bigint) {
+    Poly p = poly("123456789012345678901234567890*x^3*y + y^40 - 1", {"x", "y"});
+    SparsePoly sp = poly_to_sparse(p);
+    assert(!sp.num.limb_offset.empty());
+    assert(same(poly_from_sparse(sp, {"x", "y"}), "123456789012345678901234567890*x^3*y + y^40 - 1"));
+}
+
+TEST(sparse_rejects_non_rational) {
+    bool threw = false;
+    try {
+        poly_to_sparse(giac_eval("sqrt(2)*x"), {"x"});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(groebner_plex) {
+    std::vector<std::string> vars = {"x", "y"};
+    std::vector<SparsePoly> gens = {sparse("x^2 + y^2 - 1", vars), sparse("x - y", vars)};
+    auto basis = groebner(gens, vars, GROEBNER_PLEX, make_groebner_options(0, 0, true));
+    assert(basis.size() == 2);
+    assert(has_multiple(basis, vars, "x - y"));
+    assert(has_multiple(basis, vars, "2*y^2 - 1"));
+
+    // Zero generators are dropped
+    assert(groebner({sparse("0", vars)}, vars, GROEBNER_REVLEX, GroebnerOptions()).empty());
+}
+
+TEST(groebner_degree_orders) {
+    // Twisted cubic: the degree orders give different reduced bases
+    std::vector<std::string> vars = {"x", "y", "z"};
+    std::vector<SparsePoly> gens = {sparse("x^2 - y", vars), sparse("x^3 - z", vars)};
+    auto revlex = groebner(gens, vars, GROEBNER_REVLEX, GroebnerOptions());
+    assert(revlex.size() == 3);
+    assert(has_multiple(revlex, vars, "x^2 - y"));
+    assert(has_multiple(revlex, vars, "x*y - z"));
+    assert(has_multiple(revlex, vars, "y^2 - x*z"));
+    // Terms come back in lex order whatever the computation order
+    for (const auto& b : revlex) {
+        for (int64_t t = 1; t < b.nterms; ++t) {
+            assert(std::lexicographical_compare(b.exponents.begin() + 3 * t, b.exponents.begin() + 3 * t + 3,
+                                                b.exponents.begin() + 3 * (t - 1),
+                                                b.exponents.begin() + 3 * t));
+        }
+    }
+
+    auto tdeg = groebner(gens, vars, GROEBNER_TDEG, GroebnerOptions());
+    assert(tdeg.size() == 4);
+    assert(has_multiple(tdeg, vars, "x^2 - y"));
+    assert(has_multiple(tdeg, vars, "x*y - z"));
+    assert(has_multiple(tdeg, vars, "x*z - y^2"));
+    assert(has_multiple(tdeg, vars, "y^3 - z^2"));
+
+    // Only a degree order leads with y^2 and z^3 here
+    std::vector<SparsePoly> chain = {sparse("x - y^2", vars), sparse("y - z^3", vars)};
+    for (int32_t order : {GROEBNER_REVLEX, GROEBNER_TDEG}) {
+        auto basis = groebner(chain, vars, order, make_groebner_options(2, 0, false));
+        assert(basis.size() == 2);
+        assert(has_multiple(basis, vars, "y^2 - x"));
+        assert(has_multiple(basis, vars, "z^3 - y"));
+    }
+    auto plex = groebner(chain, vars, GROEBNER_PLEX, GroebnerOptions());
+    assert(plex.size() == 2);
+    assert(has_multiple(plex, vars, "x - z^6"));
+    assert(has_multiple(plex, vars, "y - z^3"));
+}
+
+TEST(groebner_modular) {
+    std::vector<std::string> vars = {"x", "y"};
+    std::vector<SparsePoly> gens = {sparse("x^2 + y^2 - 1", vars), sparse("x - y", vars)};
+    auto basis = groebner(gens, vars, GROEBNER_PLEX, make_groebner_options(2, 7, false));
+    assert(basis.size() == 2);
+    for (const auto& b : basis) {
+        assert(b.den.values.empty());
+        for (int64_t c : b.num.values) assert(c >= 0 && c < 7);
+    }
+    // 2*y^2 - 1 = 2*(y^2 + 3) mod 7
+    assert(has_multiple(basis, vars, "y^2 + 3"));
+}
+
+static int64_t stage_calls[3];
+
+static void count_stage(int32_t stage, int64_t, int64_t, void* data) {
+    ++stage_calls[stage];
+    ++*static_cast<int*>(data);
+}
+
+TEST(groebner_progress) {
+    std::vector<std::string> vars = {"x", "y", "z"};
+    std::vector<SparsePoly> gens = {sparse("x + y + z", vars), sparse("x*y + y*z + z*x", vars),
+                                    sparse("x*y*z - 1", vars)};
+    GroebnerOptions options;
+    int calls = 0;
+    options.progress = count_stage;
+    options.progress_data = &calls;
+    auto basis = groebner(gens, vars, GROEBNER_REVLEX, options);
+    assert(stage_calls[GROEBNER_STAGE_INPUT] == 3);
+    assert(stage_calls[GROEBNER_STAGE_COMPUTE] == 2);
+    assert(stage_calls[GROEBNER_STAGE_OUTPUT] == static_cast<int64_t>(basis.size()));
+    assert(calls == 5 + static_cast<int>(basis.size()));
+}
+
+TEST(groebner_errors) {
+    std::vector<std::string> vars = {"x"};
+    bool threw = false;
+    try {
+        groebner({sparse("x", vars)}, vars, 7, GroebnerOptions());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    try {
+        groebner({sparse("x", vars)}, vars, GROEBNER_PLEX, make_groebner_options(1, 1, false));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Composite moduli are rejected, including one above 2^32
+    for (int64_t m : {int64_t(15), int64_t(4294967297)}) {
+        threw = false;
+        try {
+            groebner({sparse("x", vars)}, vars, GROEBNER_PLEX, make_groebner_options(1, m, false));
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+}
+
+TEST(groebner_modular_large_prime) {
+    // 2^61 - 1 does not fit an unsigned long on LLP64 platforms
+    const int64_t p = 2305843009213693951LL;
+    std::vector<std::string> vars = {"x", "y"};
+    std::vector<SparsePoly> gens = {sparse("x^2 + y^2 - 1", vars), sparse("x - y", vars)};
+    auto basis = groebner(gens, vars, GROEBNER_PLEX, make_groebner_options(1, p, false));
+    assert(basis.size() == 2);
+    for (const auto& b : basis) {
+        assert(b.den.values.empty() && b.den.limb_offset.empty());
+        for (int64_t c : b.num.values) assert(c >= 0 && c < p);
+    }
+    // 2*y^2 - 1 is monic up to a unit: y^2 - 1/2 = y^2 + (p-1)/2
+    assert(has_multiple(basis, vars, "y^2 + 1152921504606846975"));
+}
+
+// Sorted (re, im) pairs of polynomial k in a RootBatch
+static std::vector<std::pair<double, double>> roots_of(const RootBatch& b, size_t k) {
+    std::vector<std::pair<double, double>> r;
+    for (int64_t j = b.offsets[k]; j < b.offsets[k + 1]; ++j) {
+        r.emplace_back(b.roots[2 * j], b.roots[2 * j + 1]);
+    }
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) < 1e-9;
+}
+
+TEST(proot_batch) {
+    // x^2 - 1, x^2 + 1, constant 5, 0*x^2 + x - 2, x - NaN, zero polynomial
+    std::vector<double> coeffs = {1, 0, -1, 1, 0, 1, 5, 0, 1, -2, 1, std::nan(""), 0, 0};
+    std::vector<int64_t> offsets = {0, 3, 6, 7, 10, 12, 14};
+    RootBatch b = proot_batch(coeffs, offsets, 15, 0);
+    assert(b.offsets.size() == 7);
+    assert(b.error_count == 2);
+    assert(b.status[4] == GIAC_STATUS_INVALID_ARGUMENT);
+    assert(b.status[5] == GIAC_STATUS_INVALID_ARGUMENT);
+    assert(b.mp_roots.empty());
+
+    auto r0 = roots_of(b, 0);
+    assert(r0.size() == 2 && near(r0[0].first, -1) && near(r0[1].first, 1));
+    auto r1 = roots_of(b, 1);
+    assert(r1.size() == 2 && near(r1[0].second, -1) && near(r1[1].second, 1));
+    assert(roots_of(b, 2).empty());
+    auto r3 = roots_of(b, 3);
+    assert(r3.size() == 1 && near(r3[0].first, 2) && near(r3[0].second, 0));
+    assert(roots_of(b, 4).empty());
+
+    // Serial and threaded runs agree
+    RootBatch serial = proot_batch(coeffs, offsets, 15, 1);
+    assert(serial.offsets == b.offsets && serial.status == b.status);
+}
+
+TEST(proot_batch_exact) {
+    // (x-1)(x-2)(x-3) at 30 digits
+    std::vector<int64_t> offsets = {0, 4};
+    RootBatch b = proot_batch(make_exact_ints({1, -6, 11, -6}), offsets, 30, 1);
+    auto r = roots_of(b, 0);
+    assert(r.size() == 3);
+    for (size_t k = 0; k < 3; ++k) {
+        assert(near(r[k].first, k + 1.0) && near(r[k].second, 0));
+    }
+    assert(b.mp_roots.size() == 3);
+
+    // x^2 - 2 and x^2 - 3 on the pool: the multiprecision roots carry
+    // digits that a double cannot
+    RootBatch q = proot_batch(make_exact_ints({1, 0, -2, 1, 0, -3}), {0, 3, 6}, 30, 0);
+    assert(q.error_count == 0 && q.mp_roots.size() == 4);
+    bool found = false;
+    for (const Gen& z : q.mp_roots) {
+        found = found || z.to_string().find("1.4142135623730950488") != std::string::npos;
+    }
+    assert(found);
+
+    bool threw = false;
+    try {
+        proot_batch(std::vector<double>{1, 2}, {0, 3}, 15, 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    std::cout << "=== Poly Tests ===" << std::endl;
+
+    RUN_TEST(roundtrip);
+    RUN_TEST(arithmetic);
+    RUN_TEST(gcd_and_factor);
+    RUN_TEST(derivative_and_evaluate);
+    RUN_TEST(errors);
+    RUN_TEST(sparse_export);
+    RUN_TEST(sparse_import);
+    RUN_TEST(sparse_rejects_nonpositive_den);
+    RUN_TEST(sparse_roundtrip_bigint);
+    RUN_TEST(sparse_rejects_non_rational);
+    RUN_TEST(groebner_plex);
+    RUN_TEST(groebner_degree_orders);
+    RUN_TEST(groebner_modular);
+    RUN_TEST(groebner_progress);
+    RUN_TEST(groebner_errors);
+    RUN_TEST(groebner_modular_large_prime);
+    RUN_TEST(proot_batch);
+    RUN_TEST(proot_batch_exact);
+
+    std::cout << "\n=== All Poly tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,342 @@
+/**
+ * @file test_printers.cpp
+ * @brief Tests for the native printers (Julia syntax, LaTeX, MathML,
+ *        budgeted to_string)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+static bool contains(const std::string& s, const std::string& sub) {
+    return s.find(sub) != std::string::npos;
+}
+
+TEST(julia_numbers) {
+    assert(to_julia_syntax(Gen(static_cast<int64_t>(42)), false) == "42");
+    assert(to_julia_syntax(Gen(static_cast<int64_t>(-7)), false) == "-7");
+    assert(to_julia_syntax(Gen(0.5), false) == "0.5");
+    // Whole doubles keep a decimal point so Julia reads a Float64
+    assert(to_julia_syntax(Gen(2.0), false) == "2.0");
+    assert(to_julia_syntax(Gen(0.1), false) == "0.1");
+    assert(to_julia_syntax(giac_eval("2^70"), false) == "1180591620717411303424");
+}
+
+TEST(julia_rationals) {
+    assert(to_julia_syntax(giac_eval("1/2"), false) == "(1//2)");
+    assert(to_julia_syntax(giac_eval("-3/4"), false) == "(-3//4)");
+    assert(to_julia_syntax(giac_eval("1/2"), true) == "(1//2)");
+}
+
+TEST(julia_complex) {
+    assert(to_julia_syntax(giac_eval("1+2*i"), false) == "1 + 2 * im");
+    assert(to_julia_syntax(giac_eval("3-i"), false) == "3 - 1 * im");
+    assert(to_julia_syntax(giac_eval("i"), false) == "1 * im");
+}
+
+TEST(julia_power_and_functions) {
+    std::string s = to_julia_syntax(giac_eval("x^2"), false);
+    assert(s == "x ^ 2");
+    assert(to_julia_syntax(giac_eval("ln(x)"), false) == "log(x)");
+    assert(to_julia_syntax(giac_eval("re(z)"), false) == "real(z)");
+    assert(to_julia_syntax(giac_eval("sin(x)^2"), false) == "sin(x) ^ 2");
+    // A sum as base must be parenthesized
+    assert(to_julia_syntax(giac_eval("quote((x+1)^2)"), false) == "(x + 1) ^ 2");
+}
+
+TEST(julia_quotient_and_negation) {
+    std::string s = to_julia_syntax(giac_eval("x/y"), false);
+    assert(s == "x / y");
+    s = to_julia_syntax(giac_eval("quote(-(x+y))"), false);
+    assert(s == "-(x + y)");
+    s = to_julia_syntax(giac_eval("x-y"), false);
+    assert(s == "x - y");
+}
+
+TEST(julia_constants) {
+    assert(to_julia_syntax(giac_eval("pi"), false) == "pi");
+    assert(to_julia_syntax(giac_eval("infinity"), false) == "Inf");
+}
+
+TEST(julia_vectors_and_matrices) {
+    assert(to_julia_syntax(giac_eval("[1,2,3]"), false) == "[1, 2, 3]");
+    // Matrix entries are atomic so signs never split a row
+    assert(to_julia_syntax(giac_eval("[[1,-2],[x+1,4]]"), false) == "[1 (-2); (x + 1) 4]");
+    // Single columns stay matrices ([1; 2] would be a Vector in Julia)
+    assert(to_julia_syntax(giac_eval("[[1],[2]]"), false) == "[1; 2;;]");
+    assert(to_julia_syntax(giac_eval("[[5]]"), false) == "[5;;]");
+    assert(to_julia_syntax(giac_eval("[[1,2]]"), false) == "[1 2]");
+}
+
+TEST(julia_broadcast) {
+    std::string s = to_julia_syntax(giac_eval("sin(x)+x^2"), true);
+    assert(contains(s, "sin.(x)"));
+    assert(contains(s, "x .^ 2"));
+    assert(contains(s, " .+ "));
+    assert(!contains(s, " + "));
+    assert(to_julia_syntax(giac_eval("x*y"), true) == "x .* y");
+}
+
+TEST(julia_strings_escaped) {
+    assert(to_julia_syntax(giac_eval("\"a$b\""), false) == "\"a\\$b\"");
+}
+
+TEST(julia_buffer_reused_across_calls) {
+    // Each call returns an independent copy of the per-thread buffer
+    std::string a = to_julia_syntax(giac_eval("x+1"), false);
+    std::string b = to_julia_syntax(giac_eval("y"), false);
+    assert(a == "x + 1");
+    assert(b == "y");
+}
+
+TEST(latex_basic_forms) {
+    assert(to_latex(giac_eval("1/2"), 0) == "\\frac{1}{2}");
+    assert(to_latex(giac_eval("x^2"), 0) == "{x}^{2}");
+    assert(to_latex(giac_eval("sqrt(x)"), 0) == "\\sqrt{x}");
+    assert(to_latex(giac_eval("sin(x)"), 0) == "\\sin\\left(x\\right)");
+    assert(to_latex(giac_eval("x/y"), 0) == "\\frac{x}{y}");
+    assert(to_latex(giac_eval("alpha"), 0) == "\\alpha");
+    assert(to_latex(giac_eval("abc_d"), 0) == "\\mathrm{abc\\_d}");
+    assert(to_latex(Gen(1.5e-10), 0) == "1.5 \\cdot 10^{-10}");
+}
+
+TEST(latex_matrix) {
+    std::string s = to_latex(giac_eval("[[1,2],[3,4]]"), 0);
+    assert(s == "\\begin{pmatrix} 1 & 2 \\\\ 3 & 4 \\end{pmatrix}");
+}
+
+TEST(latex_budget_truncates) {
+    Gen big = giac_eval("[seq(k*x^k, k, 1, 20000)]");
+    std::string s = to_latex(big, 256);
+    assert(contains(s, "\\ldots"));
+    // Stops within one node of the budget, then closes open delimiters
+    assert(s.size() < 256 + 64);
+    assert(s.compare(s.size() - std::string("\\right]").size(),
+                     std::string::npos, "\\right]") == 0);
+    // Unlimited output has no marker
+    assert(!contains(to_latex(giac_eval("[1,2,3]"), 0), "\\ldots"));
+}
+
+TEST(mathml_basic_forms) {
+    std::string s = to_mathml(giac_eval("1/2"), 0);
+    assert(s == "<math xmlns=\"http://www.w3.org/1998/Math/MathML\">"
+                "<mfrac><mn>1</mn><mn>2</mn></mfrac></math>");
+    s = to_mathml(giac_eval("x^2"), 0);
+    assert(contains(s, "<msup><mi>x</mi><mn>2</mn></msup>"));
+    s = to_mathml(giac_eval("x<y"), 0);
+    assert(contains(s, "<mo>&lt;</mo>"));
+    s = to_mathml(giac_eval("pi"), 0);
+    assert(contains(s, "<mi>&#x3C0;</mi>"));
+}
+
+TEST(mathml_budget_stays_well_formed) {
+    Gen big = giac_eval("[seq(k*x^k, k, 1, 20000)]");
+    std::string s = to_mathml(big, 512);
+    assert(contains(s, "<mi>&#x2026;</mi>"));
+    assert(s.size() < 512 + 128);
+    // Every opened element is closed
+    size_t opens = 0, closes = 0;
+    for (size_t i = 0; i + 1 < s.size(); ++i) {
+        if (s[i] == '<') (s[i + 1] == '/' ? closes : opens)++;
+    }
+    assert(opens == closes);
+    assert(s.compare(s.size() - 7, 7, "</math>") == 0);
+
+    // A cut inside a token element leaves the ellipsis as its text
+    s = to_mathml(giac_eval(std::string(300, 'a')), 64);
+    assert(contains(s, "a&#x2026;</mi></math>"));
+    assert(!contains(s, "<mi>&#x2026;</mi></mi>"));
+}
+
+// Child element count of every <name> element, via a minimal tag walk
+static std::vector<size_t> child_counts(const std::string& xml, const std::string& name) {
+    struct Open { std::string tag; size_t children; };
+    std::vector<Open> stack;
+    std::vector<size_t> counts;
+    for (size_t i = xml.find('<'); i != std::string::npos; i = xml.find('<', i + 1)) {
+        size_t end = xml.find('>', i);
+        std::string tag = xml.substr(i + 1, end - i - 1);
+        if (tag[0] == '/') {
+            if (stack.back().tag == name) counts.push_back(stack.back().children);
+            stack.pop_back();
+            continue;
+        }
+        if (!stack.empty()) stack.back().children++;
+        bool empty = tag.back() == '/';
+        tag = tag.substr(0, tag.find_first_of(" /"));
+        if (!empty) stack.push_back({tag, 0});
+    }
+    return counts;
+}
+
+TEST(mathml_budget_keeps_two_children) {
+    // Each cut position must still leave <mfrac> and <msup> with exactly
+    // a numerator and denominator, or a base and exponent
+    const char* exprs[] = {"1/(a+b+c+d+e+f)", "(a+b+c)^(d+e+f+g)", "exp(a+b+c+d)",
+                           "sin(x)/(y^(a+b+c))"};
+    for (const char* e : exprs) {
+        Gen g = giac_eval(e);
+        for (int64_t budget = 40; budget < 400; ++budget) {
+            std::string s = to_mathml(g, budget);
+            for (const char* name : {"mfrac", "msup"}) {
+                for (size_t n : child_counts(s, name)) assert(n == 2);
+            }
+        }
+    }
+}
+
+static Gen diagonal_table(int64_t n) {
+    std::vector<int64_t> colptr(n + 1), rowval(n);
+    for (int64_t k = 0; k < n; ++k) {
+        colptr[k + 1] = k + 1;
+        rowval[k] = k;
+    }
+    return csc_to_gen(make_csc_matrix(n, n, colptr, rowval, std::vector<double>(n, 1.0)));
+}
+
+TEST(typeset_fallback_is_bounded) {
+    // Tables have no typeset form and go through the budgeted text printer
+    Gen m = diagonal_table(20000);
+    std::string tex = to_latex(m, 256);
+    assert(contains(tex, "\\mathrm{table("));
+    assert(tex.size() < 256 + 64);
+    std::string mml = to_mathml(m, 256);
+    assert(contains(mml, "<mtext>table("));
+    assert(mml.size() < 256 + 64);
+}
+
+TEST(limited_matches_to_string_when_small) {
+    const char* exprs[] = {"[1,2,3]", "x^2+3*x-1", "sin(x)/(1+y)", "1/2", "[[1,2],[3,4]]"};
+    for (const char* e : exprs) {
+        Gen g = giac_eval(e);
+        LimitedString r = g.to_string_limited(1000, 0, 0);
+        assert(r.text == g.to_string());
+        assert(!r.truncated);
+    }
+}
+
+TEST(limited_never_splits_a_token) {
+    const char* names[] = {"alphabetagamma", "deltaepsilonzeta", "etathetaiota", "kappalambdamu"};
+    Gen g = giac_eval("[alphabetagamma, deltaepsilonzeta + etathetaiota, sin(kappalambdamu)]");
+    for (int64_t budget = 4; budget < 90; ++budget) {
+        LimitedString r = g.to_string_limited(budget, 0, 0);
+        for (const char* name : names) {
+            // Either the whole name or none of its first four letters
+            std::string head(name, 4);
+            assert(!contains(r.text, head) || contains(r.text, name));
+        }
+    }
+}
+
+TEST(limited_char_budget) {
+    Gen big = giac_eval("seq(k, k, 1, 100000)");
+    LimitedString r = big.to_string_limited(40, 0, 0);
+    assert(r.truncated);
+    assert(contains(r.text, "..."));
+    assert(r.text.size() <= 40 + 8);
+    assert(r.text.compare(0, 6, "(1,2,3") == 0 || r.text.compare(0, 6, "[1,2,3") == 0);
+}
+
+TEST(limited_element_budget) {
+    Gen v = giac_eval("[1,2,3,4,5,6,7,8,9,10]");
+    LimitedString r = v.to_string_limited(0, 0, 3);
+    assert(r.truncated);
+    assert(r.text == "[1,2,3,...]");
+}
+
+TEST(limited_depth_budget) {
+    Gen v = giac_eval("[1,[2,[3,[4]]]]");
+    LimitedString r = v.to_string_limited(0, 2, 0);
+    assert(r.truncated);
+    assert(r.text == "[1,[2,...]]");
+}
+
+TEST(limited_fraction_exponent_parenthesized) {
+    // The base is cut, the exponent fits and goes through giac's printer;
+    // grouping around the bare "1/3" must be kept
+    Gen e = giac_eval("(a+b+c+d+e+f+g+h)^(1/3)");
+    LimitedString r = e.to_string_limited(0, 0, 3);
+    assert(r.truncated);
+    assert(r.text == "(a+b+c+...)^(1/3)");
+}
+
+TEST(limited_huge_integer_prefix) {
+    Gen big = giac_eval("10^5000+7");
+    LimitedString r = big.to_string_limited(20, 0, 0);
+    assert(r.truncated);
+    assert(r.text.compare(0, 5, "10000") == 0);
+    assert(r.text.size() <= 20 + 3);
+}
+
+TEST(limited_large_map_is_walked_within_budget) {
+    // A 200000-entry sparse matrix must not be printed whole to show 80 chars
+    Gen m = diagonal_table(200000);
+
+    auto start = std::chrono::steady_clock::now();
+    LimitedString r = m.to_string_limited(80, 0, 0);
+    auto limited = std::chrono::steady_clock::now() - start;
+    assert(r.truncated);
+    assert(r.text.compare(0, 6, "table(") == 0);
+    assert(r.text.size() <= 80 + 8);
+
+    start = std::chrono::steady_clock::now();
+    std::string whole = m.to_string();
+    auto full = std::chrono::steady_clock::now() - start;
+    assert(whole.size() > 1000 * r.text.size());
+    assert(limited * 10 < full);
+}
+
+TEST(limited_long_string_prefix) {
+    Gen s = giac_eval("\"" + std::string(100000, 'x') + "\"");
+    LimitedString r = s.to_string_limited(20, 0, 0);
+    assert(r.truncated);
+    assert(r.text.compare(0, 4, "\"xxx") == 0);
+    assert(r.text.size() <= 20 + 3);
+}
+
+int main() {
+    std::cout << "=== Native Printer Tests ===" << std::endl;
+
+    RUN_TEST(julia_numbers);
+    RUN_TEST(julia_rationals);
+    RUN_TEST(julia_complex);
+    RUN_TEST(julia_power_and_functions);
+    RUN_TEST(julia_quotient_and_negation);
+    RUN_TEST(julia_constants);
+    RUN_TEST(julia_vectors_and_matrices);
+    RUN_TEST(julia_broadcast);
+    RUN_TEST(julia_strings_escaped);
+    RUN_TEST(julia_buffer_reused_across_calls);
+    RUN_TEST(latex_basic_forms);
+    RUN_TEST(latex_matrix);
+    RUN_TEST(latex_budget_truncates);
+    RUN_TEST(mathml_basic_forms);
+    RUN_TEST(mathml_budget_stays_well_formed);
+    RUN_TEST(mathml_budget_keeps_two_children);
+    RUN_TEST(typeset_fallback_is_bounded);
+    RUN_TEST(limited_matches_to_string_when_small);
+    RUN_TEST(limited_never_splits_a_token);
+    RUN_TEST(limited_char_budget);
+    RUN_TEST(limited_element_budget);
+    RUN_TEST(limited_depth_budget);
+    RUN_TEST(limited_fraction_exponent_parenthesized);
+    RUN_TEST(limited_huge_integer_prefix);
+    RUN_TEST(limited_large_map_is_walked_within_budget);
+    RUN_TEST(limited_long_string_prefix);
+
+    std::cout << "\n=== All native printer tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ * @file test_reader.cpp
+ * @brief Tests for the streaming batch parser (ExpressionReader)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+static const char* kPath = "test_reader_input.txt";
+
+static void write_file(const std::string& content) {
+    std::FILE* f = std::fopen(kPath, "wb");
+    assert(f != nullptr);
+    std::fwrite(content.data(), 1, content.size(), f);
+    std::fclose(f);
+}
+
+TEST(reads_and_evaluates_lines) {
+    write_file("1+2\nx^2\r\n\n[1,2]\n");
+    ExpressionReader r(kPath, true, 1);
+    ExpressionBatch b = r.next_batch(100);
+    assert(b.first_line == 1);
+    assert(b.values.size() == 4);
+    assert(b.status[0] == GIAC_STATUS_OK && b.values[0].to_string() == "3");
+    assert(b.status[1] == GIAC_STATUS_OK && b.values[1].to_string() == "x^2");
+    assert(b.status[2] == GIAC_STATUS_EMPTY);
+    assert(b.status[3] == GIAC_STATUS_OK && b.values[3].to_string() == "[1,2]");
+    assert(b.error_count == 0);
+    assert(r.at_end());
+    assert(r.lines_read() == 4);
+}
+
+TEST(parse_only_skips_eval) {
+    write_file("1+2\n");
+    ExpressionReader r(kPath, false, 1);
+    ExpressionBatch b = r.next_batch(10);
+    assert(b.status[0] == GIAC_STATUS_OK);
+    assert(b.values[0].to_string() != "3");
+}
+
+TEST(malformed_line_does_not_abort) {
+    write_file("2*)\nsin(0)\n)(\n4\n");
+    ExpressionReader r(kPath, true, 1);
+    ExpressionBatch b = r.next_batch(10);
+    assert(b.values.size() == 4);
+    assert(b.status[0] == GIAC_STATUS_PARSE_ERROR);
+    assert(!b.errors[0].empty());
+    assert(b.status[1] == GIAC_STATUS_OK && b.values[1].to_string() == "0");
+    assert(b.status[2] == GIAC_STATUS_PARSE_ERROR);
+    assert(b.status[3] == GIAC_STATUS_OK && b.values[3].to_string() == "4");
+    assert(b.error_count == 2);
+}
+
+TEST(batches_cover_file_in_order) {
+    std::string content;
+    for (int i = 1; i <= 2500; ++i) content += std::to_string(i) + "*2\n";
+    write_file(content);
+    ExpressionReader r(kPath, true, 1);
+    int64_t expected = 1;
+    while (!r.at_end()) {
+        ExpressionBatch b = r.next_batch(1000);
+        assert(b.first_line == expected);
+        for (size_t i = 0; i < b.values.size(); ++i) {
+            assert(b.values[i].to_int64() == 2 * (expected + static_cast<int64_t>(i)));
+        }
+        expected += static_cast<int64_t>(b.values.size());
+    }
+    assert(expected == 2501);
+}
+
+TEST(threaded_matches_serial) {
+    std::string content;
+    for (int i = 1; i <= 500; ++i) {
+        content += (i % 50 == 0) ? ")(\n" : "factor(x^2-" + std::to_string(i * i) + ")\n";
+    }
+    write_file(content);
+    ExpressionReader serial(kPath, true, 1);
+    ExpressionReader threaded(kPath, true, 4);
+    ExpressionBatch a = serial.next_batch(1000);
+    ExpressionBatch b = threaded.next_batch(1000);
+    assert(a.values.size() == 500 && b.values.size() == 500);
+    assert(a.error_count == 10 && b.error_count == 10);
+    for (size_t i = 0; i < a.values.size(); ++i) {
+        assert(a.status[i] == b.status[i]);
+        if (a.status[i] == GIAC_STATUS_OK) {
+            assert(a.values[i].to_string() == b.values[i].to_string());
+        }
+    }
+}
+
+TEST(threaded_values_outlive_pool_work) {
+    // Values parsed on pool threads are combined on this thread while the
+    // pool parses the next batch
+    std::string content;
+    for (int i = 1; i <= 400; ++i) content += "x+" + std::to_string(i) + "\n";
+    write_file(content);
+    ExpressionReader threaded(kPath, true, 4);
+    ExpressionBatch first = threaded.next_batch(200);
+    ExpressionBatch second = threaded.next_batch(200);
+    Gen total(static_cast<int64_t>(0));
+    for (const Gen& v : first.values) total = total + v;
+    for (const Gen& v : second.values) total = total + v;
+    assert(total.eval().to_string() == "400*x+80200");
+}
+
+TEST(dependent_lines_see_earlier_bindings) {
+    // Each line reads the binding made by the line before it, across
+    // batch boundaries and whatever the number of parsing threads
+    std::string content = "rdr_a:=5\n";
+    for (int i = 1; i < 300; ++i) content += "rdr_a:=rdr_a+1\n";
+    write_file(content);
+    for (int32_t threads : {1, 4}) {
+        ExpressionReader r(kPath, true, threads);
+        int64_t expected = 5;
+        while (!r.at_end()) {
+            ExpressionBatch b = r.next_batch(64);
+            for (size_t i = 0; i < b.values.size(); ++i) {
+                assert(b.status[i] == GIAC_STATUS_OK && b.values[i].to_int64() == expected++);
+            }
+        }
+        assert(expected == 305);
+    }
+    // The bindings stay in the readers' own contexts
+    assert(giac_eval("rdr_a").to_string() == "rdr_a");
+}
+
+TEST(read_error_throws) {
+    // A directory opens on POSIX but every read fails
+    bool threw = false;
+    try {
+        ExpressionReader r(".", false, 1);
+        r.next_batch(10);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+TEST(missing_file_throws) {
+    bool threw = false;
+    try {
+        ExpressionReader r("does/not/exist.txt", true, 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    std::cout << "=== ExpressionReader Tests ===" << std::endl;
+
+    RUN_TEST(reads_and_evaluates_lines);
+    RUN_TEST(parse_only_skips_eval);
+    RUN_TEST(malformed_line_does_not_abort);
+    RUN_TEST(batches_cover_file_in_order);
+    RUN_TEST(threaded_matches_serial);
+    RUN_TEST(threaded_values_outlive_pool_work);
+    RUN_TEST(dependent_lines_see_earlier_bindings);
+    RUN_TEST(read_error_throws);
+    RUN_TEST(missing_file_throws);
+
+    std::remove(kPath);
+    std::cout << "\n=== All ExpressionReader tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file test_reduce.cpp
+ * @brief Tests for pairwise vector reductions (vect_sum / vect_prod)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+TEST(vect_sum_integers) {
+    std::vector<Gen> terms;
+    for (int64_t k = 1; k <= 100; ++k) terms.emplace_back(k);
+    Gen s = vect_sum(terms, 1);
+    assert(s.to_string() == "5050");
+    std::cout << "sum(1..100) = " << s.to_string() << " ";
+}
+
+TEST(vect_sum_empty_is_zero) {
+    Gen s = vect_sum(std::vector<Gen>{}, 1);
+    assert(s.is_zero());
+    Gen p = vect_prod(std::vector<Gen>{}, 1);
+    assert(p.is_one());
+}
+
+TEST(vect_sum_symbolic_collects_terms) {
+    // x + y + x + y + ... collapses to n/2*x + n/2*y after the final pass
+    std::vector<Gen> terms;
+    Gen x = make_identifier("x");
+    Gen y = make_identifier("y");
+    for (int k = 0; k < 10; ++k) terms.push_back(k % 2 == 0 ? x : y);
+    Gen s = vect_sum(terms, 1);
+    Gen expected = giac_eval("5*x+5*y");
+    assert(s == expected);
+    std::cout << "sum = " << s.to_string() << " ";
+}
+
+TEST(vect_sum_from_vect_gen) {
+    Gen v = giac_eval("[1/2, 1/3, 1/6, x]");
+    Gen s = vect_sum(v, 1);
+    assert(s == giac_eval("x+1"));
+    std::cout << "vect_sum([1/2,1/3,1/6,x]) = " << s.to_string() << " ";
+}
+
+TEST(vect_prod_integers) {
+    Gen v = giac_eval("[1,2,3,4,5,6,7,8,9,10]");
+    Gen p = vect_prod(v, 1);
+    assert(p.to_string() == "3628800");
+    std::cout << "prod(1..10) = " << p.to_string() << " ";
+}
+
+TEST(vect_sum_threaded_matches_serial) {
+    // Enough terms to cross the per-thread threshold
+    std::vector<Gen> terms;
+    Gen x = make_identifier("x");
+    for (int64_t k = 0; k < 5000; ++k) {
+        terms.push_back(Gen(k % 7) * x + Gen(k));
+    }
+    Gen serial = vect_sum(terms, 1);
+    Gen threaded = vect_sum(terms, 4);
+    assert(serial == threaded);
+    std::cout << "threaded sum = " << threaded.to_string() << " ";
+}
+
+TEST(vect_sum_throws_on_non_vector) {
+    bool threw = false;
+    try {
+        vect_sum(Gen(static_cast<int64_t>(3)), 1);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    std::cout << "=== GIAC Wrapper Reduction Tests ===" << std::endl;
+
+    RUN_TEST(vect_sum_integers);
+    RUN_TEST(vect_sum_empty_is_zero);
+    RUN_TEST(vect_sum_symbolic_collects_terms);
+    RUN_TEST(vect_sum_from_vect_gen);
+    RUN_TEST(vect_prod_integers);
+    RUN_TEST(vect_sum_threaded_matches_serial);
+    RUN_TEST(vect_sum_throws_on_non_vector);
+
+    std::cout << "=== All tests passed ===" << std::endl;
+    return 0;
+}
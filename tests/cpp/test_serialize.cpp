@@ -0,0 +1,241 @@
+/**
+ * @file test_serialize.cpp
+ * @brief Tests for streaming serialization (write_gen / read_gen)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+// Write g to an anonymous temporary file and read it back
+static Gen round_trip(const Gen& g, int32_t format, long* bytes = nullptr) {
+    FILE* f = std::tmpfile();
+    assert(f != nullptr);
+    int fd = fileno(f);
+    write_gen(g, fd, format);
+    long end = static_cast<long>(lseek(fd, 0, SEEK_END));
+    if (bytes) *bytes = end;
+    lseek(fd, 0, SEEK_SET);
+    Gen back = read_gen(fd, format);
+    std::fclose(f);
+    return back;
+}
+
+static const char* kSamples[] = {
+    "42", "-7", "2^200", "-(3^150)", "1/3", "-5/7", "3.25", "1+2*i",
+    "x", "\"hello\"", "[1,[2,x],\"s\"]", "sin(x)+x^2*y-1/z",
+    "[[1,2],[3,4]]", "x<=y", "set[1,2,3]",
+};
+
+TEST(binary_round_trip_samples) {
+    for (const char* e : kSamples) {
+        Gen g = giac_eval(e);
+        Gen back = round_trip(g, GEN_FORMAT_BINARY);
+        assert(back.type() == g.type());
+        assert(back.to_string() == g.to_string());
+    }
+}
+
+TEST(text_round_trip_samples) {
+    for (const char* e : kSamples) {
+        Gen g = giac_eval(e);
+        Gen back = round_trip(g, GEN_FORMAT_TEXT);
+        assert(back.type() == g.type());
+        assert(back.to_string() == g.to_string());
+    }
+}
+
+TEST(text_keeps_unevaluated_expressions) {
+    // Reading parses only: nothing is simplified or evaluated
+    Gen one_plus_two = make_symbolic_unevaluated("+", {Gen(static_cast<int64_t>(1)),
+                                                       Gen(static_cast<int64_t>(2))});
+    Gen back = round_trip(one_plus_two, GEN_FORMAT_TEXT);
+    assert(back.is_symbolic());
+    assert(back.to_string() == one_plus_two.to_string());
+
+    Gen sin0 = make_symbolic_unevaluated("sin", {Gen(static_cast<int64_t>(0))});
+    back = round_trip(sin0, GEN_FORMAT_TEXT);
+    assert(back.is_symbolic());
+    assert(back.to_string() == sin0.to_string());
+
+    // A sum nested in a sum is not flattened by the parser
+    Gen x = make_identifier("x"), y = make_identifier("y"), z = make_identifier("z");
+    Gen nested = make_symbolic_unevaluated("+", {make_symbolic_unevaluated("+", {x, y}), z});
+    back = round_trip(nested, GEN_FORMAT_TEXT);
+    assert(back.symb_feuille().vect_size() == 2);
+    assert(back.to_string() == nested.to_string());
+
+    // The reader's own marker names survive as ordinary nodes
+    for (const char* op : {"quote", "eval"}) {
+        Gen g = make_symbolic_unevaluated(op, {make_symbolic_unevaluated("+", {x, y})});
+        back = round_trip(g, GEN_FORMAT_TEXT);
+        assert(back.is_symbolic());
+        assert(back.to_string() == g.to_string());
+    }
+}
+
+TEST(text_preserves_vect_subtype) {
+    const char* vects[] = {"[1,2]", "set[1,2]", "poly1[1,2,3]", "matrix(2,2,1)", "(1,2)"};
+    for (const char* e : vects) {
+        Gen v = giac_eval(e);
+        Gen back = round_trip(v, GEN_FORMAT_TEXT);
+        assert(back.type() == v.type());
+        assert(back.subtype() == v.subtype());
+        assert(back.to_string() == v.to_string());
+    }
+}
+
+TEST(text_round_trip_table) {
+    Gen m = csc_to_gen(make_csc_matrix(2, 2, {0, 1, 3}, {0, 0, 1}, {1.5, -2.0, 3.0}));
+    Gen back = round_trip(m, GEN_FORMAT_TEXT);
+    assert(back.type() == m.type());
+    assert(back.map_size() == 3);
+    assert(back.to_string() == m.to_string());
+}
+
+TEST(binary_preserves_int_subtype) {
+    Gen b = giac_eval("true");
+    Gen back = round_trip(b, GEN_FORMAT_BINARY);
+    assert(back.type() == b.type());
+    assert(back.subtype() == b.subtype());
+}
+
+TEST(large_vector_streams_in_chunks) {
+    // Well past one 64 KiB chunk in either format
+    Gen big = giac_eval("[seq(k*x+k^2, k, 1, 50000)]");
+    long bytes = 0;
+    Gen back = round_trip(big, GEN_FORMAT_BINARY, &bytes);
+    assert(bytes > 64 * 1024);
+    assert(back.vect_size() == 50000);
+    assert(back.to_string() == big.to_string());
+
+    back = round_trip(big, GEN_FORMAT_TEXT, &bytes);
+    assert(bytes > 64 * 1024);
+    assert(back.to_string() == big.to_string());
+}
+
+TEST(deep_tree_binary) {
+    Gen g = make_identifier("x");
+    for (int i = 0; i < 5000; ++i) {
+        g = make_symbolic_unevaluated("sin", std::vector<Gen>{g});
+    }
+    Gen back = round_trip(g, GEN_FORMAT_BINARY);
+    assert(back.to_string() == g.to_string());
+}
+
+TEST(binary_preserves_vect_subtype) {
+    const char* vects[] = {"[1,2]", "set[1,2]", "poly1[1,2,3]", "matrix(2,2,1)", "(1,2)"};
+    for (const char* e : vects) {
+        Gen v = giac_eval(e);
+        Gen back = round_trip(v, GEN_FORMAT_BINARY);
+        assert(back.type() == v.type());
+        assert(back.subtype() == v.subtype());
+    }
+}
+
+TEST(binary_round_trip_operators) {
+    // Every infix name the reader resolves, plus a few functions
+    const char* binary[] = {"+", "*", "/", "^", "=", "==", "!=", "<", "<=", ">", ">=",
+                            "and", "or", "max", "atan2"};
+    std::vector<Gen> xy{make_identifier("x"), make_identifier("y")};
+    for (const char* op : binary) {
+        Gen g = make_symbolic_unevaluated(op, xy);
+        Gen back = round_trip(g, GEN_FORMAT_BINARY);
+        assert(back.to_string() == g.to_string());
+    }
+    const char* unary[] = {"-", "floor", "sin", "exp", "ln", "abs"};
+    for (const char* op : unary) {
+        Gen g = make_symbolic_unevaluated(op, {make_identifier("x")});
+        Gen back = round_trip(g, GEN_FORMAT_BINARY);
+        assert(back.to_string() == g.to_string());
+    }
+    Gen diff = giac_eval("x-y");
+    assert(round_trip(diff, GEN_FORMAT_BINARY).to_string() == diff.to_string());
+}
+
+TEST(million_level_tree_binary) {
+    // Far deeper than a recursive reader's stack allows. giac's own
+    // destructor and printer recurse, so the chains are checked with
+    // fold_tree and dismantled one level at a time.
+    const int depth = 1000000;
+    Gen g = make_identifier("x");
+    for (int i = 0; i < depth; ++i) {
+        g = make_symbolic_unevaluated("sin", std::vector<Gen>{g});
+    }
+    Gen back = round_trip(g, GEN_FORMAT_BINARY);
+    assert(fold_tree(back, TREE_DEPTH).depth == depth + 1);
+    for (Gen* chain : {&g, &back}) {
+        while (chain->is_symbolic()) {
+            Gen child = chain->symb_feuille();
+            *chain = std::move(child);
+        }
+    }
+    assert(back.to_string() == "x");
+}
+
+TEST(corrupt_input_throws) {
+    FILE* f = std::tmpfile();
+    int fd = fileno(f);
+    std::fputs("not a gen", f);
+    std::fflush(f);
+    lseek(fd, 0, SEEK_SET);
+    bool threw = false;
+    try {
+        read_gen(fd, GEN_FORMAT_BINARY);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    std::fclose(f);
+    assert(threw);
+}
+
+TEST(unknown_format_throws) {
+    bool threw = false;
+    try {
+        write_gen(Gen(static_cast<int64_t>(1)), 1, 99);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+int main() {
+    std::cout << "=== Streaming Serialization Tests ===" << std::endl;
+
+    RUN_TEST(binary_round_trip_samples);
+    RUN_TEST(text_round_trip_samples);
+    RUN_TEST(text_keeps_unevaluated_expressions);
+    RUN_TEST(text_preserves_vect_subtype);
+    RUN_TEST(text_round_trip_table);
+    RUN_TEST(binary_preserves_int_subtype);
+    RUN_TEST(large_vector_streams_in_chunks);
+    RUN_TEST(deep_tree_binary);
+    RUN_TEST(binary_preserves_vect_subtype);
+    RUN_TEST(binary_round_trip_operators);
+    RUN_TEST(million_level_tree_binary);
+    RUN_TEST(corrupt_input_throws);
+    RUN_TEST(unknown_format_throws);
+
+    std::cout << "\n=== All serialization tests passed! ===" << std::endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_traversal.cpp
+ * @brief Tests for native expression tree folds (fold_tree / contains_function)
+ */
+
+#include "giac_impl.h"
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace giac_julia;
+
+// Simple test framework macros
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Running " #name "... "; \
+    try { test_##name(); std::cout << "PASSED" << std::endl; } \
+    catch (const std::exception& e) { std::cout << "FAILED: " << e.what() << std::endl; return 1; } \
+} while(0)
+
+TEST(fold_leaf) {
+    TreeSummary t = fold_tree(Gen(static_cast<int64_t>(5)), TREE_ALL);
+    assert(t.node_count == 1);
+    assert(t.depth == 1);
+    assert(t.numeric_leaf_count == 1);
+    assert(t.numeric_min == 5.0 && t.numeric_max == 5.0);
+}
+
+TEST(fold_identifiers_sorted_unique) {
+    Gen e = giac_eval("sin(y)+x*y+x");
+    TreeSummary t = fold_tree(e, TREE_IDENTIFIERS);
+    assert((t.identifiers == std::vector<std::string>{"x", "y"}));
+    // Unselected reducers stay empty
+    assert(t.node_count == 0);
+    assert(t.operator_names.empty());
+}
+
+TEST(fold_operator_histogram) {
+    Gen e = giac_eval("sin(x)+sin(y)+cos(x)");
+    TreeSummary t = fold_tree(e, TREE_OPERATORS);
+    auto it = std::find(t.operator_names.begin(), t.operator_names.end(), "sin");
+    assert(it != t.operator_names.end());
+    assert(t.operator_counts[it - t.operator_names.begin()] == 2);
+    it = std::find(t.operator_names.begin(), t.operator_names.end(), "cos");
+    assert(it != t.operator_names.end());
+    assert(t.operator_counts[it - t.operator_names.begin()] == 1);
+}
+
+TEST(fold_numeric_range) {
+    Gen e = make_symbolic_unevaluated("+", {Gen(static_cast<int64_t>(-3)), Gen(2.5), giac_eval("1/4"), make_identifier("x")});
+    TreeSummary t = fold_tree(e, TREE_NUMERIC_RANGE);
+    assert(t.numeric_leaf_count == 3);
+    assert(t.numeric_min == -3.0);
+    assert(t.numeric_max == 2.5);
+}
+
+TEST(fold_node_count_and_depth) {
+    // +( *(2, x), 1 ): nodes = +, *, 2, x, 1
+    Gen prod = make_symbolic_unevaluated("*", {Gen(static_cast<int64_t>(2)), make_identifier("x")});
+    Gen e = make_symbolic_unevaluated("+", {prod, Gen(static_cast<int64_t>(1))});
+    TreeSummary t = fold_tree(e, TREE_NODE_COUNT | TREE_DEPTH);
+    assert(t.node_count == 5);
+    assert(t.depth == 3);
+}
+
+TEST(fold_deep_tree_no_overflow) {
+    // sin(sin(...sin(x)...)); kept shallow enough for giac's own recursive
+    // destructor, the walk itself uses no recursion at all
+    Gen e = make_identifier("x");
+    for (int k = 0; k < 10000; ++k) {
+        e = make_symbolic_unevaluated("sin", {e});
+    }
+    TreeSummary t = fold_tree(e, TREE_DEPTH | TREE_NODE_COUNT);
+    assert(t.depth == 10001);
+    assert(t.node_count == 10001);
+    std::cout << "depth = " << t.depth << " ";
+}
+
+TEST(contains_function_hit_and_miss) {
+    Gen e = giac_eval("x^2+exp(sin(x))");
+    assert(contains_function(e, "sin"));
+    assert(contains_function(e, "exp"));
+    assert(!contains_function(e, "cos"));
+}
+
+int main() {
+    std::cout << "=== GIAC Wrapper Traversal Tests ===" << std::endl;
+
+    RUN_TEST(fold_leaf);
+    RUN_TEST(fold_identifiers_sorted_unique);
+    RUN_TEST(fold_operator_histogram);
+    RUN_TEST(fold_numeric_range);
+    RUN_TEST(fold_node_count_and_depth);
+    RUN_TEST(fold_deep_tree_no_overflow);
+    RUN_TEST(contains_function_hit_and_miss);
+
+    std::cout << "=== All tests passed ===" << std::endl;
+    return 0;
+}
@@ -21,11 +21,19 @@ end
 
 import Base: show
 
+# Display budgets: showing a Gen costs O(budget), never O(expression size)
+const DISPLAY_MAX_CHARS = 2000
+const DISPLAY_MAX_DEPTH = 0      # unlimited
+const DISPLAY_MAX_ELEMS = 200
+
+_display_string(g::Gen, max_chars::Integer=DISPLAY_MAX_CHARS) =
+    text(to_string_limited(g, max_chars, Int32(DISPLAY_MAX_DEPTH), DISPLAY_MAX_ELEMS))
+
 """
 Single-line display for Gen (used in arrays, etc.)
 """
 function Base.show(io::IO, g::Gen)
-    print(io, to_string(g))
+    print(io, _display_string(g))
 end
 
 """
@@ -36,23 +44,43 @@ function Base.show(io::IO, ::MIME"text/plain", g::Gen)
     type_str = _type_name(t)
 
     if t == GENTYPE_VECT
-        # REQ-J51: Vector display with brackets
+        # REQ-J51: Vector display with brackets; the elements share one
+        # char budget rather than getting DISPLAY_MAX_CHARS each
         n = vect_size(g)
         print(io, "Gen{", type_str, "}([")
-        for i in 0:(n-1)
+        remaining = DISPLAY_MAX_CHARS
+        shown = min(n, DISPLAY_MAX_ELEMS)
+        for i in 0:(shown-1)
             i > 0 && print(io, ", ")
-            print(io, to_string(vect_at(g, Int32(i))))
+            if remaining <= 0
+                print(io, "...")
+                shown = n
+                break
+            end
+            s = _display_string(vect_at(g, Int32(i)), remaining)
+            remaining -= sizeof(s)
+            print(io, s)
         end
+        n > shown && print(io, ", ...")
         print(io, "])")
     elseif t == GENTYPE_INT || t == GENTYPE_DOUBLE
         # REQ-J52: Numeric display directly
         print(io, to_string(g))
     else
         # REQ-J50: Type and textual representation
-        print(io, "Gen{", type_str, "}(", to_string(g), ")")
+        print(io, "Gen{", type_str, "}(", _display_string(g), ")")
     end
 end
 
+"""
+LaTeX display for notebooks; the byte budget keeps huge results cheap
+"""
+const LATEX_DISPLAY_BUDGET = 4096
+
+function Base.show(io::IO, ::MIME"text/latex", g::Gen)
+    print(io, "\$", to_latex(g, LATEX_DISPLAY_BUDGET), "\$")
+end
+
 """
 Helper: Convert type constant to readable name
 """
@@ -178,6 +206,38 @@ end
         @test contains(output, "[]")
     end
 
+    @testset "LaTeX display (text/latex)" begin
+        output = sprint(show, MIME("text/latex"), giac_eval("x^2"))
+        @test output == "\$" * "{x}^{2}" * "\$"
+
+        # A huge result is cut at the display budget
+        big = giac_eval("[seq(k*x^k, k, 1, 100000)]")
+        t = @elapsed output = sprint(show, MIME("text/latex"), big)
+        @test contains(output, "\\ldots")
+        @test sizeof(output) < LATEX_DISPLAY_BUDGET + 256
+        @test t < 1.0
+    end
+
+    @testset "Budgeted display of huge results" begin
+        big = giac_eval("[seq(k, k, 1, 1000000)]")
+        t = @elapsed output = sprint(show, big)
+        @test endswith(output, "...]")
+        @test length(output) <= DISPLAY_MAX_CHARS + 8
+        @test t < 1.0
+
+        # Vector elements share the budget instead of getting it each
+        rows = giac_eval("[seq([seq(k, k, 1, 1000)], j, 1, 200)]")
+        t = @elapsed output = sprint(show, MIME("text/plain"), rows)
+        @test startswith(output, "Gen{Vector}([")
+        @test endswith(output, "...])")
+        @test sizeof(output) <= DISPLAY_MAX_CHARS + 64
+        @test t < 1.0
+
+        r = to_string_limited(big, 10, Int32(0), 0)
+        @test truncated(r)
+        @test !truncated(to_string_limited(giac_eval("x+1"), 100, Int32(0), 0))
+    end
+
     @testset "Display in array context" begin
         g1 = giac_eval("1")
         g2 = giac_eval("2")
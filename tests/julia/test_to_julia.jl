@@ -143,6 +143,10 @@ function _to_julia_vector(g::Gen)
         return Set(elements)
     end
 
+    # Fast path: one native census, then bulk extraction
+    bulk = _to_julia_numeric_bulk(g, st)
+    bulk === nothing || return bulk
+
     # Handle Matrix subtype (T063)
     if st == VECTSUBTYPE_MATRIX
         return _to_julia_matrix(g)
@@ -159,6 +163,34 @@ function _to_julia_vector(g::Gen)
     return _narrow_vector(elements)
 end
 
+"""
+Internal: Bulk conversion of rectangular vectors whose leaves are all `_INT_`
+or all `_DOUBLE_`, using one describe() call instead of probing every
+element's type across the FFI. Returns `nothing` when the generic path is
+needed (mixed leaf types, nesting other than list/matrix, empty lists).
+"""
+function _to_julia_numeric_bulk(g::Gen, st)
+    d = describe(g)
+    (all_immediate_numeric(d) && is_rectangular(d)) || return nothing
+
+    counts = type_counts(d)
+    n_int = counts[GENTYPE_INT + 1]
+    n_dbl = counts[GENTYPE_DOUBLE + 1]
+    n_int + n_dbl == 0 && return nothing
+    # Mixed Int/Float lists keep the REQ-J21 narrowing of the generic path
+    (n_int == 0 || n_dbl == 0) || return nothing
+
+    data = n_dbl == 0 ? collect(flatten_int64s(g)) : collect(flatten_doubles(g))
+    dm = dims(d)
+    if depth(d) == 1
+        return data
+    elseif depth(d) == 2 && st == VECTSUBTYPE_MATRIX
+        # Leaves come back row-major
+        return permutedims(reshape(data, Int(dm[2]), Int(dm[1])))
+    end
+    return nothing
+end
+
 """
 Internal: Convert matrix Gen to Julia Matrix{T}.
 Assumes g is a vector of vectors (rows).